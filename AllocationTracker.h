@@ -0,0 +1,95 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+
+namespace mtm {
+
+    /**
+     * Counting allocator hook for SortedList nodes.
+     *
+     * Every SortedList node is allocated through SortedList's Node::operator new, which reports to the tracker
+     * installed with setNodeAllocationTracker(). No tracker is installed by default, and then the only cost is
+     * one acquire load (a plain load on x86) per node allocation and free. Install the tracker before building
+     * the lists it should account for, otherwise it also sees frees of nodes it never saw allocated.
+     */
+    class AllocationTracker {
+        std::atomic<std::size_t> m_liveBlocks{0};
+        std::atomic<std::size_t> m_liveBytes{0};
+        std::atomic<std::size_t> m_peakBytes{0};
+        std::atomic<std::size_t> m_totalBlocks{0};
+
+    public:
+        AllocationTracker() = default;
+        AllocationTracker(const AllocationTracker& other) = delete;
+        AllocationTracker& operator=(const AllocationTracker& other) = delete;
+
+        void recordAllocation(std::size_t bytes);
+        void recordDeallocation(std::size_t bytes);
+
+        std::size_t getLiveBlocks() const; // blocks allocated and not yet freed
+        std::size_t getLiveBytes() const;
+        std::size_t getPeakBytes() const;
+        std::size_t getTotalBlocks() const; // every block ever allocated
+    };
+
+    // the tracker every SortedList node allocation reports to, nullptr to stop tracking
+    inline std::atomic<AllocationTracker*> g_nodeAllocationTracker{nullptr};
+
+    inline void setNodeAllocationTracker(AllocationTracker* tracker) {
+        g_nodeAllocationTracker.store(tracker, std::memory_order_release);
+    }
+
+    // the memory of a SortedList node, reported to the installed tracker. Defined here so SortedList.h needs
+    // nothing to link, but never inlined: with ::operator new inlined into Node::operator new, GCC takes the
+    // Node::operator delete that runs when a node constructor throws for a mismatched delete
+    // (-Wmismatched-new-delete)
+    [[gnu::noinline]] inline void* allocateNode(std::size_t bytes) {
+        void* memory = ::operator new(bytes);
+        if (AllocationTracker* tracker = g_nodeAllocationTracker.load(std::memory_order_acquire)) {
+            tracker->recordAllocation(bytes);
+        }
+        return memory;
+    }
+
+    [[gnu::noinline]] inline void deallocateNode(void* memory, std::size_t bytes) {
+        if (AllocationTracker* tracker = g_nodeAllocationTracker.load(std::memory_order_acquire)) {
+            tracker->recordDeallocation(bytes);
+        }
+        ::operator delete(memory);
+    }
+
+    // ---------------------------- AllocationTracker ---------------------------- //
+
+    inline void AllocationTracker::recordAllocation(std::size_t bytes) {
+        m_liveBlocks.fetch_add(1, std::memory_order_relaxed);
+        m_totalBlocks.fetch_add(1, std::memory_order_relaxed);
+        const std::size_t liveBytes = m_liveBytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        std::size_t peakBytes = m_peakBytes.load(std::memory_order_relaxed);
+        while (liveBytes > peakBytes &&
+               !m_peakBytes.compare_exchange_weak(peakBytes, liveBytes, std::memory_order_relaxed)) {}
+    }
+
+    inline void AllocationTracker::recordDeallocation(std::size_t bytes) {
+        m_liveBlocks.fetch_sub(1, std::memory_order_relaxed);
+        m_liveBytes.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+
+    inline std::size_t AllocationTracker::getLiveBlocks() const {
+        return m_liveBlocks.load(std::memory_order_relaxed);
+    }
+
+    inline std::size_t AllocationTracker::getLiveBytes() const {
+        return m_liveBytes.load(std::memory_order_relaxed);
+    }
+
+    inline std::size_t AllocationTracker::getPeakBytes() const {
+        return m_peakBytes.load(std::memory_order_relaxed);
+    }
+
+    inline std::size_t AllocationTracker::getTotalBlocks() const {
+        return m_totalBlocks.load(std::memory_order_relaxed);
+    }
+
+}
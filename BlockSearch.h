@@ -0,0 +1,170 @@
+#pragma once
+
+/**
+ * Vectorized search inside the blocks of an unrolled SortedList<int> (see SortedList.h).
+ *
+ * A block keeps its keys from the greatest to the lowest, so the keys that a new key is not greater than form
+ * a prefix of the block, and the length of that prefix is exactly where the new key goes. The prefix is
+ * counted with SSE2 / AVX2 compares, no branch per key. The widest instruction set the CPU supports is picked
+ * once at runtime, with a scalar loop as the fallback (and on every other architecture). Everything is defined
+ * in this header, so SortedList.h needs nothing to link.
+ */
+
+#include <atomic>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MTM_BLOCKSEARCH_X86
+#include <immintrin.h>
+#endif
+
+namespace mtm {
+namespace blocksearch {
+
+    /**
+     * @brief The implementations of countNotLess, from the narrowest to the widest.
+     */
+    enum class Isa {
+        Scalar,
+        Sse2,
+        Avx2
+    };
+
+    /**
+     * @brief The widest implementation this CPU can run.
+     */
+    inline Isa detectIsa();
+
+    /**
+     * @brief The implementation used by countNotLess(keys, count, key), detectIsa() unless changed.
+     */
+    inline Isa activeIsa();
+
+    /**
+     * @brief Changes the implementation used from now on, for benchmarks and tests.
+     *
+     * @param isa - the implementation, narrowed to detectIsa() if the CPU cannot run it.
+     */
+    inline void setActiveIsa(Isa isa);
+
+    /**
+     * @brief Counts the keys that key is not greater than, in keys sorted from the greatest to the lowest.
+     *
+     * @param keys - the keys of the block.
+     * @param count - the number of keys.
+     * @param key - the key to look for.
+     * @return the position key is inserted at, after the keys equal to it.
+     */
+    inline unsigned int countNotLess(const int* keys, unsigned int count, int key);
+
+    /**
+     * @brief Same, with a specific implementation - which the CPU must support.
+     */
+    inline unsigned int countNotLess(const int* keys, unsigned int count, int key, Isa isa);
+
+    inline const char* isaName(Isa isa);
+
+    // ------------------------------ implementations ----------------------------- //
+
+    namespace detail {
+        inline unsigned int countNotLessScalar(const int* keys, unsigned int count, int key) {
+            unsigned int notLess = 0;
+            for (unsigned int i = 0; i < count; ++i) {
+                notLess += !(key > keys[i]);
+            }
+            return notLess;
+        }
+
+#ifdef MTM_BLOCKSEARCH_X86
+        // a compare lane is -1 wherever key > keys[i], i.e. a key below the prefix. subtracting the compare
+        // results counts them per lane, and the lanes are summed once at the end
+
+        __attribute__((target("sse2")))
+        inline unsigned int countNotLessSse2(const int* keys, unsigned int count, int key) {
+            const __m128i broadcast = _mm_set1_epi32(key);
+            __m128i lower = _mm_setzero_si128();
+            unsigned int i = 0;
+            for (; i + 4 <= count; i += 4) {
+                const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i));
+                lower = _mm_sub_epi32(lower, _mm_cmpgt_epi32(broadcast, block));
+            }
+            lower = _mm_add_epi32(lower, _mm_shuffle_epi32(lower, _MM_SHUFFLE(1, 0, 3, 2)));
+            lower = _mm_add_epi32(lower, _mm_shuffle_epi32(lower, _MM_SHUFFLE(2, 3, 0, 1)));
+            return i - _mm_cvtsi128_si32(lower) + countNotLessScalar(keys + i, count - i, key);
+        }
+
+        __attribute__((target("avx2")))
+        inline unsigned int countNotLessAvx2(const int* keys, unsigned int count, int key) {
+            const __m256i broadcast = _mm256_set1_epi32(key);
+            __m256i lower = _mm256_setzero_si256();
+            unsigned int i = 0;
+            for (; i + 8 <= count; i += 8) {
+                const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i));
+                lower = _mm256_sub_epi32(lower, _mm256_cmpgt_epi32(broadcast, block));
+            }
+            __m128i half = _mm_add_epi32(_mm256_castsi256_si128(lower), _mm256_extracti128_si256(lower, 1));
+            half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(1, 0, 3, 2)));
+            half = _mm_add_epi32(half, _mm_shuffle_epi32(half, _MM_SHUFFLE(2, 3, 0, 1)));
+            return i - _mm_cvtsi128_si32(half) + countNotLessSse2(keys + i, count - i, key);
+        }
+#endif
+
+        // one instance for the whole program, however many translation units include this header
+        inline std::atomic<Isa>& activeIsaRef() {
+            static std::atomic<Isa> active(detectIsa());
+            return active;
+        }
+    }
+
+    inline Isa detectIsa() {
+#ifdef MTM_BLOCKSEARCH_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+            return Isa::Avx2;
+        }
+        if (__builtin_cpu_supports("sse2")) {
+            return Isa::Sse2;
+        }
+#endif
+        return Isa::Scalar;
+    }
+
+    inline Isa activeIsa() {
+        return detail::activeIsaRef().load(std::memory_order_relaxed);
+    }
+
+    inline void setActiveIsa(Isa isa) {
+        const Isa supported = detectIsa();
+        detail::activeIsaRef().store(static_cast<int>(isa) > static_cast<int>(supported) ? supported : isa,
+                                     std::memory_order_relaxed);
+    }
+
+    inline unsigned int countNotLess(const int* keys, unsigned int count, int key) {
+        return countNotLess(keys, count, key, activeIsa());
+    }
+
+    inline unsigned int countNotLess(const int* keys, unsigned int count, int key, Isa isa) {
+        switch (isa) {
+#ifdef MTM_BLOCKSEARCH_X86
+        case Isa::Avx2:
+            return detail::countNotLessAvx2(keys, count, key);
+        case Isa::Sse2:
+            return detail::countNotLessSse2(keys, count, key);
+#endif
+        default:
+            return detail::countNotLessScalar(keys, count, key);
+        }
+    }
+
+    inline const char* isaName(Isa isa) {
+        switch (isa) {
+        case Isa::Avx2:
+            return "avx2";
+        case Isa::Sse2:
+            return "sse2";
+        default:
+            return "scalar";
+        }
+    }
+
+}
+}
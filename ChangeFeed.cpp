@@ -0,0 +1,154 @@
+#include "ChangeFeed.h"
+
+#include <algorithm>
+#include <thread>
+
+// -------------------------------- ChangeFeed -------------------------------- //
+
+std::shared_ptr<ChangeFeed::Subscription> ChangeFeed::subscribe(std::size_t capacity, BackpressurePolicy policy) {
+    std::shared_ptr<Subscription> subscription(new Subscription(capacity, policy));
+    std::lock_guard<std::mutex> lock(m_subscriptionsMutex);
+    Subscriptions newSubscriptions = *m_subscriptions;
+    newSubscriptions.push_back(subscription);
+    m_subscriptions = std::make_shared<const Subscriptions>(std::move(newSubscriptions));
+    m_hasSubscribers.store(true, std::memory_order_relaxed);
+    return subscription;
+}
+
+void ChangeFeed::unsubscribe(const std::shared_ptr<Subscription>& subscription) {
+    subscription->m_unsubscribed.store(true, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(m_subscriptionsMutex);
+    Subscriptions newSubscriptions = *m_subscriptions;
+    newSubscriptions.erase(std::remove(newSubscriptions.begin(), newSubscriptions.end(), subscription),
+                           newSubscriptions.end());
+    m_hasSubscribers.store(!newSubscriptions.empty(), std::memory_order_relaxed);
+    m_subscriptions = std::make_shared<const Subscriptions>(std::move(newSubscriptions));
+}
+
+bool ChangeFeed::hasSubscribers() const {
+    return m_hasSubscribers.load(std::memory_order_relaxed);
+}
+
+void ChangeFeed::publish(ChangeEvent& event) {
+    std::lock_guard<std::mutex> lock(m_queuedMutex);
+    event.sequence = m_nextSequence++;
+    m_queued.push_back(event);
+    m_numOfQueued.store(m_queued.size(), std::memory_order_relaxed);
+}
+
+void ChangeFeed::deliver() {
+    // the calling thread sees its own publishes - if they are gone, the delivery that took them sends them
+    if (m_numOfQueued.load(std::memory_order_relaxed) == 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> deliveryLock(m_deliveryMutex);
+    {
+        std::lock_guard<std::mutex> lock(m_queuedMutex);
+        m_delivering.swap(m_queued);
+        m_numOfQueued.store(0, std::memory_order_relaxed);
+    }
+    std::shared_ptr<const Subscriptions> subscriptions;
+    {
+        std::lock_guard<std::mutex> lock(m_subscriptionsMutex);
+        subscriptions = m_subscriptions;
+    }
+    for (const ChangeEvent& event : m_delivering) {
+        for (const std::shared_ptr<Subscription>& subscription : *subscriptions) {
+            subscription->offer(event);
+        }
+    }
+    m_delivering.clear();
+}
+
+// ------------------------------- Subscription ------------------------------- //
+
+ChangeFeed::Subscription::Subscription(std::size_t capacity, BackpressurePolicy policy) : m_policy(policy) {
+    // a power of two turns the ring index into a mask, and the coalesce marker needs at least two slots
+    std::size_t size = 2;
+    while (size < capacity) {
+        size *= 2;
+    }
+    m_events.reset(new ChangeEvent[size]);
+    m_mask = size - 1;
+}
+
+std::size_t ChangeFeed::Subscription::freeSlots() {
+    const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+    std::size_t free = m_mask + 1 - (tail - m_cachedHead);
+    if (free < 2) {
+        m_cachedHead = m_head.load(std::memory_order_acquire);
+        free = m_mask + 1 - (tail - m_cachedHead);
+    }
+    return free;
+}
+
+void ChangeFeed::Subscription::push(const ChangeEvent& event) {
+    const std::size_t tail = m_tail.load(std::memory_order_relaxed);
+    // copy-assigning into the slot reuses its string buffer, so steady state publishing does not allocate
+    m_events[tail & m_mask] = event;
+    m_tail.store(tail + 1, std::memory_order_release);
+}
+
+void ChangeFeed::Subscription::offer(const ChangeEvent& event) {
+    switch (m_policy) {
+    case BackpressurePolicy::Drop:
+        if (freeSlots() == 0) {
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        push(event);
+        return;
+
+    case BackpressurePolicy::Block:
+        while (freeSlots() == 0) {
+            if (m_unsubscribed.load(std::memory_order_relaxed)) {
+                return;
+            }
+            std::this_thread::yield();
+        }
+        push(event);
+        return;
+
+    case BackpressurePolicy::Coalesce:
+        if (m_pendingCoalesced > 0) {
+            // the marker and the new event must both fit, otherwise the new event is folded in as well
+            if (freeSlots() < 2) {
+                ++m_pendingCoalesced;
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            ChangeEvent marker;
+            marker.type = ChangeType::EventsCoalesced;
+            marker.sequence = m_coalescedSequence;
+            marker.count = m_pendingCoalesced;
+            push(marker);
+            m_pendingCoalesced = 0;
+        }
+        else if (freeSlots() == 0) {
+            m_pendingCoalesced = 1;
+            m_coalescedSequence = event.sequence;
+            m_dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        push(event);
+        return;
+    }
+}
+
+bool ChangeFeed::Subscription::poll(ChangeEvent& event) {
+    const std::size_t head = m_head.load(std::memory_order_relaxed);
+    if (head == m_cachedTail) {
+        m_cachedTail = m_tail.load(std::memory_order_acquire);
+        if (head == m_cachedTail) {
+            return false;
+        }
+    }
+    event = m_events[head & m_mask];
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+std::size_t ChangeFeed::Subscription::getDroppedCount() const {
+    return m_dropped.load(std::memory_order_relaxed);
+}
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "Task.h"
+
+using std::string;
+
+/**
+ * @brief Kinds of mutations published on a TaskManager's change feed.
+ */
+enum class ChangeType {
+    PersonAdded,
+    TaskAssigned,
+    TaskCompleted,
+    PriorityBumped,
+    TasksReassigned, // every task of otherPersonName moved to personName
+    PersonsMerged,   // the same, and otherPersonName was removed
+    TasksRebalanced, // count tasks moved between persons by a rebalance
+    TaskEvicted,     // personName dropped its lowest priority task to stay within its capacity
+    EventsCoalesced // the subscriber fell behind, count events were folded away - resynchronize from a full dump
+};
+
+/**
+ * @brief One mutation of a TaskManager.
+ */
+struct ChangeEvent {
+    ChangeType type = ChangeType::TaskAssigned;
+    unsigned long long sequence = 0; // increasing per feed, a gap means events were dropped
+    string personName;               // empty for PriorityBumped and EventsCoalesced
+    string otherPersonName;          // TasksReassigned and PersonsMerged only - where the tasks came from
+    int taskId = -1;                 // TaskAssigned and TaskCompleted only
+    int priority = 0;                // the task's priority, or the bump amount for PriorityBumped
+    TaskType taskType = TaskType::General;
+    int count = 0;                   // EventsCoalesced, or the number of tasks moved
+};
+
+/**
+ * @brief What a publisher does when a subscriber's buffer is full.
+ */
+enum class BackpressurePolicy {
+    Drop,    // the new event is dropped, visible to the subscriber as a sequence gap
+    Block,   // deliver() waits until the subscriber makes room (the subscriber must consume on another thread)
+    Coalesce // events are dropped until there is room, then a single EventsCoalesced event reports how many
+};
+
+/**
+ * @brief In-process change feed - every subscriber gets its own bounded lock-free ring buffer.
+ *
+ * The owner (the TaskManager) publishes events while it holds its own lock, which only queues them, and
+ * delivers them after releasing it - so a subscriber that blocks the delivery never holds up the owner's
+ * readers, and may call them from its consumer thread. One thread delivers at a time, in the order the events
+ * were published, and each subscription is consumed by one thread of the subscriber's choice (single producer
+ * / single consumer per ring). subscribe() and unsubscribe() may be called on any thread. With no
+ * subscribers, publishing and delivering cost a single branch each.
+ */
+class ChangeFeed {
+public:
+    class Subscription;
+
+private:
+    using Subscriptions = std::vector<std::shared_ptr<Subscription>>;
+
+    // copy-on-write: subscribing swaps in a new list, so a delivery keeps going through the one it started with
+    std::shared_ptr<const Subscriptions> m_subscriptions = std::make_shared<const Subscriptions>();
+    std::atomic<bool> m_hasSubscribers{false};
+    mutable std::mutex m_subscriptionsMutex;
+
+    // published and not delivered yet, in sequence order
+    std::vector<ChangeEvent> m_queued;
+    std::atomic<std::size_t> m_numOfQueued{0};
+    unsigned long long m_nextSequence = 0;
+    std::mutex m_queuedMutex; // guards the members above
+
+    // held while delivering, so the rings have one producer at a time
+    std::mutex m_deliveryMutex;
+    std::vector<ChangeEvent> m_delivering; // kept between deliveries so they reuse its buffer
+
+public:
+    ChangeFeed() = default;
+    ChangeFeed(const ChangeFeed& other) = delete;
+    ChangeFeed& operator=(const ChangeFeed& other) = delete;
+
+    /**
+     * @brief Creates a new subscription that receives every event published from now on.
+     *
+     * @param capacity The number of events the subscription can buffer (rounded up to a power of two).
+     * @param policy What to do when the buffer is full.
+     * @return std::shared_ptr<Subscription> The consumer side of the subscription.
+     */
+    std::shared_ptr<Subscription> subscribe(std::size_t capacity, BackpressurePolicy policy);
+
+    /**
+     * @brief Stops delivering to a subscription (events already buffered can still be consumed).
+     *
+     * A delivery waiting for room in a Block subscription gives up on it.
+     *
+     * @param subscription The subscription to be removed.
+     */
+    void unsubscribe(const std::shared_ptr<Subscription>& subscription);
+
+    /**
+     * @brief Checks if anyone listens, so publishers can skip building events.
+     *
+     * @return true If there is at least one subscription.
+     */
+    bool hasSubscribers() const;
+
+    /**
+     * @brief Queues an event for the next deliver() (the sequence number is assigned here), without waiting.
+     *
+     * @param event The event to be published.
+     */
+    void publish(ChangeEvent& event);
+
+    /**
+     * @brief Delivers the queued events to every subscription, in the order they were published.
+     *
+     * Waits for another delivery in progress, and with BackpressurePolicy::Block for room in the subscriptions -
+     * so it must not be called with locks the subscribers' consumer threads take.
+     */
+    void deliver();
+};
+
+/**
+ * @brief The consumer side of a subscription - a single producer / single consumer ring of events.
+ */
+class ChangeFeed::Subscription {
+    friend ChangeFeed;
+
+    static const std::size_t CACHE_LINE = 64;
+
+    std::unique_ptr<ChangeEvent[]> m_events;
+    std::size_t m_mask;
+    BackpressurePolicy m_policy;
+
+    // written by the consumer only
+    alignas(CACHE_LINE) std::atomic<std::size_t> m_head{0};
+    std::size_t m_cachedTail = 0; // consumer's last view of m_tail, so it rarely touches the publisher's line
+    // written by the publisher only
+    alignas(CACHE_LINE) std::atomic<std::size_t> m_tail{0};
+    std::size_t m_cachedHead = 0; // publisher's last view of m_head, refreshed only when the ring looks full
+    std::atomic<std::size_t> m_dropped{0};
+    std::atomic<bool> m_unsubscribed{false};
+    int m_pendingCoalesced = 0;
+    unsigned long long m_coalescedSequence = 0;
+
+    Subscription(std::size_t capacity, BackpressurePolicy policy);
+
+    std::size_t freeSlots();
+    void push(const ChangeEvent& event);
+    void offer(const ChangeEvent& event);
+
+public:
+    Subscription(const Subscription& other) = delete;
+    Subscription& operator=(const Subscription& other) = delete;
+
+    /**
+     * @brief Takes the oldest buffered event, without waiting.
+     *
+     * @param event Receives the event.
+     * @return true If there was an event.
+     */
+    bool poll(ChangeEvent& event);
+
+    /**
+     * @brief Takes every buffered event, oldest first.
+     *
+     * @param consumer Called with each event.
+     * @return int The number of consumed events.
+     */
+    template <typename Consumer>
+    int drain(Consumer consumer);
+
+    /**
+     * @brief Gets the number of events this subscription lost to backpressure (dropped or coalesced).
+     *
+     * @return std::size_t The number of lost events.
+     */
+    std::size_t getDroppedCount() const;
+};
+
+template <typename Consumer>
+int ChangeFeed::Subscription::drain(Consumer consumer) {
+    int consumed = 0;
+    ChangeEvent event;
+    while (poll(event)) {
+        consumer(event);
+        ++consumed;
+    }
+    return consumed;
+}
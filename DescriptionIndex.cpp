@@ -0,0 +1,246 @@
+#include "DescriptionIndex.h"
+#include "MemoryUsage.h"
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <utility>
+
+namespace {
+    // walks the slots of one posting list, from the lowest
+    class PostingCursor {
+        const std::vector<std::uint8_t>* m_bytes;
+        std::size_t m_position = 0;
+        int m_slot = -1;
+
+    public:
+        explicit PostingCursor(const std::vector<std::uint8_t>& bytes) : m_bytes(&bytes) {}
+
+        // moves to the next slot, false at the end of the list
+        bool next() {
+            if (m_position == m_bytes->size()) {
+                return false;
+            }
+            unsigned int gap = 0;
+            int shift = 0;
+            std::uint8_t byte;
+            do {
+                byte = (*m_bytes)[m_position++];
+                gap |= static_cast<unsigned int>(byte & 0x7f) << shift;
+                shift += 7;
+            } while (byte & 0x80);
+            m_slot += static_cast<int>(gap);
+            return true;
+        }
+
+        int slot() const {
+            return m_slot;
+        }
+
+        std::size_t size() const {
+            return m_bytes->size();
+        }
+    };
+}
+
+// --------------------------------- helpers -------------------------------- //
+
+std::vector<string> DescriptionIndex::tokenize(const string& text) {
+    std::vector<string> tokens;
+    string token;
+    for (std::size_t i = 0; i <= text.size(); ++i) {
+        const char c = (i < text.size()) ? text[i] : ' ';
+        if ((c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')) {
+            token += c;
+        }
+        else if (c >= 'A' && c <= 'Z') {
+            token += static_cast<char>(c - 'A' + 'a');
+        }
+        else if (!token.empty()) {
+            if (std::find(tokens.begin(), tokens.end(), token) == tokens.end()) {
+                tokens.push_back(token);
+            }
+            token.clear();
+        }
+    }
+    return tokens;
+}
+
+void DescriptionIndex::append(PostingList& list, int slot) {
+    unsigned int gap = static_cast<unsigned int>(slot - list.lastSlot);
+    while (gap >= 0x80) {
+        list.bytes.push_back(static_cast<std::uint8_t>(gap | 0x80));
+        gap >>= 7;
+    }
+    list.bytes.push_back(static_cast<std::uint8_t>(gap));
+    list.lastSlot = slot;
+}
+
+int DescriptionIndex::priorityOf(const Entry& entry) const {
+    return std::min(entry.priority + m_pendingBumps.offsetOf(entry.type, entry.id), Task::MAX_PRIORITY);
+}
+
+void DescriptionIndex::foldPendingBumps() {
+    for (Entry& entry : m_entries) {
+        if (entry.live) {
+            entry.priority = priorityOf(entry);
+        }
+    }
+    m_pendingBumps.clear();
+    m_numOfPendingBumps = 0;
+}
+
+void DescriptionIndex::compact() {
+    // the live entries keep their order, so every posting list stays ascending
+    std::vector<int> newSlots(m_entries.size(), -1);
+    std::vector<Entry> liveEntries;
+    liveEntries.reserve(m_entries.size() - m_numOfDeadEntries);
+    for (std::size_t slot = 0; slot < m_entries.size(); ++slot) {
+        if (m_entries[slot].live) {
+            newSlots[slot] = static_cast<int>(liveEntries.size());
+            m_slotOfTask[m_entries[slot].id] = newSlots[slot];
+            liveEntries.push_back(std::move(m_entries[slot]));
+        }
+    }
+    m_entries = std::move(liveEntries);
+    m_numOfDeadEntries = 0;
+
+    for (auto It = m_postings.begin(); It != m_postings.end();) {
+        PostingList liveSlots;
+        PostingCursor cursor(It->second.bytes);
+        while (cursor.next()) {
+            if (newSlots[cursor.slot()] >= 0) {
+                append(liveSlots, newSlots[cursor.slot()]);
+            }
+        }
+        if (liveSlots.bytes.empty()) {
+            It = m_postings.erase(It);
+        }
+        else {
+            liveSlots.bytes.shrink_to_fit();
+            It->second = std::move(liveSlots);
+            ++It;
+        }
+    }
+    m_numOfPostings -= m_numOfDeadPostings;
+    m_numOfDeadPostings = 0;
+}
+
+// ---------------------------------- index --------------------------------- //
+
+void DescriptionIndex::add(const Task& task) {
+    const int slot = static_cast<int>(m_entries.size());
+    m_entries.emplace_back();
+    Entry& entry = m_entries.back();
+    entry.description = task.getDescription();
+    entry.id = task.getId();
+    entry.priority = task.getPriority();
+    entry.type = task.getType();
+    entry.live = true;
+    m_slotOfTask[entry.id] = slot;
+
+    const std::vector<string> tokens = tokenize(entry.description);
+    for (const string& token : tokens) {
+        append(m_postings[token], slot);
+    }
+    entry.numOfTokens = static_cast<int>(tokens.size());
+    m_numOfPostings += tokens.size();
+}
+
+void DescriptionIndex::remove(int taskId) {
+    const auto found = m_slotOfTask.find(taskId);
+    if (found == m_slotOfTask.end()) {
+        return;
+    }
+    Entry& entry = m_entries[found->second];
+    m_slotOfTask.erase(found);
+    entry.live = false;
+    string().swap(entry.description);
+    m_numOfDeadEntries++;
+    m_numOfDeadPostings += entry.numOfTokens;
+    if (m_numOfDeadEntries > m_entries.size() / 2 || m_numOfDeadPostings > m_numOfPostings / 2) {
+        compact();
+    }
+}
+
+void DescriptionIndex::bumpPriorityByType(TaskTypeSet types, int priority, int watermark) {
+    for (int type = 0; type < NUM_TASK_TYPES; ++type) {
+        if (types.contains(static_cast<TaskType>(type))) {
+            m_pendingBumps.add(static_cast<TaskType>(type), priority, watermark);
+            m_numOfPendingBumps++;
+        }
+    }
+    // applying them costs a pass over the entries, so they wait until there are as many as live tasks
+    if (m_numOfPendingBumps > static_cast<int>(m_slotOfTask.size())) {
+        foldPendingBumps();
+    }
+}
+
+std::vector<Task> DescriptionIndex::search(const string& query, int k) const {
+    const std::vector<string> tokens = tokenize(query);
+    if (tokens.empty() || k <= 0) {
+        return {};
+    }
+    std::vector<PostingCursor> cursors;
+    for (const string& token : tokens) {
+        auto found = m_postings.find(token);
+        if (found == m_postings.end()) {
+            return {};
+        }
+        cursors.emplace_back(found->second.bytes);
+    }
+    // the shortest list leads, the others only skip ahead to its slots
+    std::sort(cursors.begin(), cursors.end(), [](const PostingCursor& a, const PostingCursor& b) {
+        return a.size() < b.size();
+    });
+
+    // the best k so far, the worst on top - the lowest priority, and the highest id among equal priorities (slots
+    // are in the order of ids)
+    using Match = std::pair<int, int>; // priority, -slot
+    std::priority_queue<Match, std::vector<Match>, std::greater<Match>> best;
+    bool exhausted = false; // one of the lists is over, so no later slot is in all of them
+    while (!exhausted && cursors[0].next()) {
+        const int slot = cursors[0].slot();
+        bool inAll = true;
+        for (std::size_t i = 1; i < cursors.size() && inAll; ++i) {
+            while (!exhausted && cursors[i].slot() < slot) {
+                exhausted = !cursors[i].next();
+            }
+            inAll = !exhausted && cursors[i].slot() == slot;
+        }
+        if (!inAll || !m_entries[slot].live) {
+            continue;
+        }
+        best.push({priorityOf(m_entries[slot]), -slot});
+        if (static_cast<int>(best.size()) > k) {
+            best.pop();
+        }
+    }
+
+    std::vector<Task> results;
+    results.reserve(best.size());
+    for (; !best.empty(); best.pop()) {
+        const Entry& entry = m_entries[-best.top().second];
+        Task task(best.top().first, entry.type, entry.description);
+        task.setId(entry.id);
+        results.push_back(task);
+    }
+    std::reverse(results.begin(), results.end());
+    return results;
+}
+
+std::size_t DescriptionIndex::memoryBytes() const {
+    std::size_t bytes = m_entries.capacity() * sizeof(Entry);
+    for (const Entry& entry : m_entries) {
+        bytes += MemoryUsage::stringHeapBytes(entry.description);
+    }
+    // every live task and every token is a hash node - the key, the value and a link - plus its bucket slot
+    bytes += m_slotOfTask.bucket_count() * sizeof(void*) +
+             m_slotOfTask.size() * (sizeof(std::pair<const int, int>) + sizeof(void*));
+    bytes += m_postings.bucket_count() * sizeof(void*);
+    for (const auto& posting : m_postings) {
+        bytes += sizeof(posting) + sizeof(void*) + MemoryUsage::stringHeapBytes(posting.first) +
+                 posting.second.bytes.capacity();
+    }
+    return bytes;
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "PriorityOffsets.h"
+#include "Task.h"
+#include "TaskTypeSet.h"
+
+using std::string;
+
+/**
+ * @brief An inverted index of task descriptions: for every token, the tasks whose description has it.
+ *
+ * A token is a run of ASCII letters and digits, lowercased. Every task gets a slot - its entry, with what a
+ * search result needs (description, type and priority), so a search never touches the persons' task lists.
+ * Slots are handed out in increasing order, like task ids, so every posting list is kept ascending and stored
+ * as the varint-encoded gaps between its slots - usually one byte per task. A query matches the tasks that
+ * have all of its tokens, found by walking the posting lists together.
+ *
+ * A completed task's slot and postings stay until the completed tasks are half of the slots or of the
+ * postings. Then the live entries are packed into the lowest slots and every list is re-encoded with the new
+ * slots - O(1) amortized per completion, and the index never holds more than about twice what its live tasks
+ * need. Bumps are recorded like Person records them (see PriorityOffsets) and folded in when they outnumber
+ * the live tasks.
+ */
+class DescriptionIndex {
+    // ascending slots, each stored as the LEB128 varint of its gap from the one before
+    struct PostingList {
+        std::vector<std::uint8_t> bytes;
+        int lastSlot = -1;
+    };
+
+    struct Entry {
+        string description;
+        int id = -1;
+        int priority = Task::MIN_PRIORITY; // before the pending bumps
+        TaskType type = TaskType::General;
+        int numOfTokens = 0;
+        bool live = false;
+    };
+
+    std::unordered_map<string, PostingList> m_postings;
+    std::vector<Entry> m_entries;                // by slot, in the order the tasks were added
+    std::unordered_map<int, int> m_slotOfTask;   // by task id, live tasks only
+    PriorityOffsets m_pendingBumps;
+    int m_numOfPendingBumps = 0;
+    std::size_t m_numOfDeadEntries = 0;
+    std::size_t m_numOfPostings = 0; // completed tasks included
+    std::size_t m_numOfDeadPostings = 0;
+
+    static void append(PostingList& list, int slot);
+    // the current priority of an indexed task
+    int priorityOf(const Entry& entry) const;
+    void foldPendingBumps();
+    // packs the live entries into the lowest slots and re-encodes every posting list with them
+    void compact();
+
+public:
+    /**
+     * @brief Splits a text into its tokens, each one once, in the order they first appear.
+     *
+     * @param text The text to be split.
+     * @return std::vector<string> The lowercased runs of letters and digits in the text.
+     */
+    static std::vector<string> tokenize(const string& text);
+
+    /**
+     * @brief Adds a task to the index, in O(number of tokens in its description).
+     *
+     * @param task The task - its id must be above the id of every task added before.
+     */
+    void add(const Task& task);
+
+    /**
+     * @brief Removes a completed task from the search results, in O(1) amortized.
+     *
+     * @param taskId The id of the task. Nothing happens if it is not in the index.
+     */
+    void remove(int taskId);
+
+    /**
+     * @brief Records a bump of the priority of the indexed tasks of some types, in O(number of types).
+     *
+     * @param types The types of tasks whose priority changes.
+     * @param priority The amount added - must be positive, like the bumps Person records lazily.
+     * @param watermark The id of the first task the bump does not apply to.
+     */
+    void bumpPriorityByType(TaskTypeSet types, int priority, int watermark);
+
+    /**
+     * @brief Finds the highest priority tasks whose description has every token of a query.
+     *
+     * O(sum of the posting lists of the query's tokens) plus O(matches * log k) to keep the best k.
+     *
+     * @param query The tokens to be searched for, split like descriptions are (see tokenize()).
+     * @param k The largest number of tasks returned.
+     * @return std::vector<Task> The matching tasks, at most k, in operator> order - the highest priority first.
+     */
+    std::vector<Task> search(const string& query, int k) const;
+
+    /**
+     * @brief Gets the bytes held by the index, for memory footprint reports.
+     *
+     * @return std::size_t The size of the posting lists, the token table and the per-task entries.
+     */
+    std::size_t memoryBytes() const;
+};
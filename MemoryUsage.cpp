@@ -0,0 +1,24 @@
+#include "MemoryUsage.h"
+
+std::size_t MemoryUsage::total() const {
+    return listNodeBytes + taskPayloadBytes + descriptionHeapBytes + personTableBytes + searchIndexBytes;
+}
+
+std::size_t MemoryUsage::stringHeapBytes(const string& str) {
+    // an empty string's capacity is the inline (small string) buffer, anything above it lives on the heap
+    static const std::size_t inlineCapacity = string().capacity();
+    if (str.capacity() <= inlineCapacity) {
+        return 0;
+    }
+    return str.capacity() + 1;
+}
+
+ostream& operator<<(ostream& os, const MemoryUsage& usage) {
+    os << "List nodes: " << usage.listNodeBytes << " bytes" << std::endl;
+    os << "Task payloads: " << usage.taskPayloadBytes << " bytes" << std::endl;
+    os << "Descriptions: " << usage.descriptionHeapBytes << " bytes" << std::endl;
+    os << "Person table: " << usage.personTableBytes << " bytes" << std::endl;
+    os << "Search index: " << usage.searchIndexBytes << " bytes" << std::endl;
+    os << "Total: " << usage.total() << " bytes";
+    return os;
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+#include <string>
+
+using std::ostream;
+using std::string;
+
+/**
+ * @brief Breakdown of the memory held by a TaskManager, in bytes requested from the allocator.
+ */
+struct MemoryUsage {
+    std::size_t listNodeBytes = 0;        // SortedList node overhead (links), without the Task inside
+    std::size_t taskPayloadBytes = 0;     // the Task objects stored in the nodes
+    std::size_t descriptionHeapBytes = 0; // heap buffers of descriptions too long for the inline string buffer
+    std::size_t personTableBytes = 0;    // the person table itself and heap buffers of person names
+    std::size_t searchIndexBytes = 0;    // the description index, when it is kept
+
+    /**
+     * @brief Gets the sum of all parts of the report.
+     *
+     * @return std::size_t The total number of bytes.
+     */
+    std::size_t total() const;
+
+    /**
+     * @brief Gets the heap bytes owned by a string (0 when it fits in the inline buffer).
+     *
+     * @param str The string to be measured.
+     * @return std::size_t The size of the string's heap buffer.
+     */
+    static std::size_t stringHeapBytes(const string& str);
+
+    /**
+     * @brief Overloaded output stream operator for printing the report.
+     *
+     * @param os The output stream.
+     * @param usage The report to be printed.
+     * @return ostream& The output stream with the report.
+     */
+    friend ostream& operator<<(ostream& os, const MemoryUsage& usage);
+};
@@ -0,0 +1,150 @@
+#include "Metrics.h"
+
+#include <chrono>
+#include <fstream>
+
+namespace mtm {
+namespace metrics {
+
+    namespace {
+        std::uint64_t nowNanos() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+        }
+
+        // unitScale converts the recorded integers to the exported unit (1e-9 for nanoseconds to seconds)
+        void writeHistogram(std::ostream& os, const char* name, const std::string& labels,
+                            const Log2Histogram& histogram, double unitScale) {
+            const std::string separator = labels.empty() ? "" : ",";
+            std::uint64_t cumulative = 0;
+            for (int i = 0; i < Log2Histogram::NUM_BUCKETS; ++i) {
+                cumulative += histogram.getBucket(i);
+                os << name << "_bucket{" << labels << separator << "le=\"";
+                if (unitScale == 1) {
+                    os << Log2Histogram::bucketUpperBound(i);
+                }
+                else {
+                    os << Log2Histogram::bucketUpperBound(i) * unitScale;
+                }
+                os << "\"} " << cumulative << "\n";
+            }
+            os << name << "_bucket{" << labels << separator << "le=\"+Inf\"} " << histogram.getCount() << "\n";
+            const std::string braces = labels.empty() ? "" : "{" + labels + "}";
+            os << name << "_sum" << braces << " ";
+            if (unitScale == 1) {
+                os << histogram.getSum() << "\n";
+            }
+            else {
+                os << histogram.getSum() * unitScale << "\n";
+            }
+            os << name << "_count" << braces << " " << histogram.getCount() << "\n";
+        }
+    }
+
+    // ------------------------------ Log2Histogram ------------------------------ //
+
+    void Log2Histogram::record(std::uint64_t value) {
+        // the smallest bucket whose upper bound 2^(i-1) is >= value
+        int index = 0;
+        if (value > 0) {
+            index = (value == 1) ? 1 : 64 - __builtin_clzll(value - 1) + 1;
+        }
+        if (index >= NUM_BUCKETS) {
+            index = NUM_BUCKETS - 1;
+        }
+        m_buckets[index].fetch_add(1, std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+        m_sum.fetch_add(value, std::memory_order_relaxed);
+    }
+
+    std::uint64_t Log2Histogram::getBucket(int index) const {
+        return m_buckets[index].load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t Log2Histogram::getCount() const {
+        return m_count.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t Log2Histogram::getSum() const {
+        return m_sum.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t Log2Histogram::bucketUpperBound(int index) {
+        return index == 0 ? 0 : (std::uint64_t(1) << (index - 1));
+    }
+
+    // -------------------------------- Registry -------------------------------- //
+
+    Registry& registry() {
+        static Registry instance;
+        return instance;
+    }
+
+    ScopedTimer::ScopedTimer(Operation operation) : m_operation(operation), m_startNanos(nowNanos()) {}
+
+    ScopedTimer::~ScopedTimer() {
+        registry().operationLatencyNanos[static_cast<int>(m_operation)].record(nowNanos() - m_startNanos);
+    }
+
+    void recordInsert(std::uint64_t comparisons, std::uint64_t lengthAfter) {
+        registry().insertComparisons.record(comparisons);
+        registry().listLength.record(lengthAfter);
+    }
+
+    const char* operationName(Operation operation) {
+        switch (operation) {
+        case Operation::AssignTask:
+            return "assign_task";
+        case Operation::CompleteTask:
+            return "complete_task";
+        case Operation::BumpPriorityByType:
+            return "bump_priority_by_type";
+        case Operation::PrintTasksByType:
+            return "print_tasks_by_type";
+        case Operation::SearchDescriptions:
+            return "search_descriptions";
+        default:
+            return "unknown";
+        }
+    }
+
+    // --------------------------------- output --------------------------------- //
+
+    void writePrometheus(std::ostream& os) {
+        Registry& metrics = registry();
+
+        os << "# HELP taskmanager_operation_latency_seconds Latency of TaskManager operations.\n";
+        os << "# TYPE taskmanager_operation_latency_seconds histogram\n";
+        for (int i = 0; i < NUM_OPERATIONS; ++i) {
+            const std::string labels = std::string("operation=\"") + operationName(static_cast<Operation>(i)) + "\"";
+            writeHistogram(os, "taskmanager_operation_latency_seconds", labels, metrics.operationLatencyNanos[i],
+                           1e-9);
+        }
+
+        os << "# HELP sortedlist_insert_comparisons Elements compared by one SortedList insert.\n";
+        os << "# TYPE sortedlist_insert_comparisons histogram\n";
+        writeHistogram(os, "sortedlist_insert_comparisons", "", metrics.insertComparisons, 1);
+
+        os << "# HELP sortedlist_length Length of a SortedList after an insert.\n";
+        os << "# TYPE sortedlist_length histogram\n";
+        writeHistogram(os, "sortedlist_length", "", metrics.listLength, 1);
+
+        os << "# HELP sortedlist_nodes_allocated_total SortedList nodes allocated.\n";
+        os << "# TYPE sortedlist_nodes_allocated_total counter\n";
+        os << "sortedlist_nodes_allocated_total " << metrics.nodesAllocated.load(std::memory_order_relaxed) << "\n";
+        os << "# HELP sortedlist_nodes_freed_total SortedList nodes freed.\n";
+        os << "# TYPE sortedlist_nodes_freed_total counter\n";
+        os << "sortedlist_nodes_freed_total " << metrics.nodesFreed.load(std::memory_order_relaxed) << "\n";
+    }
+
+    bool writePrometheus(const std::string& path) {
+        std::ofstream file(path);
+        if (!file) {
+            return false;
+        }
+        writePrometheus(file);
+        return static_cast<bool>(file);
+    }
+
+}
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+/**
+ * Hot-path instrumentation of SortedList and TaskManager.
+ *
+ * Compiled in only when MTM_METRICS is defined (cmake -DTASKMANAGER_METRICS=ON). Otherwise every MTM_METRICS_*
+ * macro expands to nothing, so the instrumented code is exactly the uninstrumented code. The collected data is
+ * dumped in Prometheus text format with mtm::metrics::writePrometheus().
+ */
+
+namespace mtm {
+namespace metrics {
+
+    /**
+     * @brief The TaskManager operations whose latency is tracked.
+     */
+    enum class Operation {
+        AssignTask,
+        CompleteTask,
+        BumpPriorityByType,
+        PrintTasksByType,
+        SearchDescriptions
+    };
+
+    const int NUM_OPERATIONS = static_cast<int>(Operation::SearchDescriptions) + 1;
+
+    /**
+     * @brief Lock-free histogram with power of two buckets.
+     *
+     * Bucket 0 counts the zeros, bucket 1 the ones, and bucket i > 1 the values in (2^(i-2), 2^(i-1)] - its upper
+     * bound 2^(i-1) is the "le" label it is exported with. The last bucket also counts every larger value.
+     */
+    class Log2Histogram {
+    public:
+        static const int NUM_BUCKETS = 48;
+
+    private:
+        std::atomic<std::uint64_t> m_buckets[NUM_BUCKETS] = {};
+        std::atomic<std::uint64_t> m_count{0};
+        std::atomic<std::uint64_t> m_sum{0};
+
+    public:
+        void record(std::uint64_t value);
+
+        std::uint64_t getBucket(int index) const;
+        std::uint64_t getCount() const;
+        std::uint64_t getSum() const;
+
+        // upper bound of a bucket, the "le" label of Prometheus
+        static std::uint64_t bucketUpperBound(int index);
+    };
+
+    /**
+     * @brief Everything that is collected, one process-wide instance.
+     */
+    struct Registry {
+        Log2Histogram operationLatencyNanos[NUM_OPERATIONS];
+        Log2Histogram insertComparisons;
+        Log2Histogram listLength;
+        std::atomic<std::uint64_t> nodesAllocated{0};
+        std::atomic<std::uint64_t> nodesFreed{0};
+    };
+
+    Registry& registry();
+
+    /**
+     * @brief Records the latency of the enclosing scope as one call of an operation.
+     */
+    class ScopedTimer {
+        Operation m_operation;
+        std::uint64_t m_startNanos;
+
+    public:
+        explicit ScopedTimer(Operation operation);
+        ScopedTimer(const ScopedTimer& other) = delete;
+        ScopedTimer& operator=(const ScopedTimer& other) = delete;
+        ~ScopedTimer();
+    };
+
+    // records one SortedList::insert - how many elements were compared and the list length after it
+    void recordInsert(std::uint64_t comparisons, std::uint64_t lengthAfter);
+
+    const char* operationName(Operation operation);
+
+    /**
+     * @brief Writes all metrics in Prometheus text exposition format.
+     *
+     * @param os The output stream.
+     */
+    void writePrometheus(std::ostream& os);
+
+    /**
+     * @brief Writes all metrics in Prometheus text exposition format to a file (replacing it).
+     *
+     * @param path The path of the file, e.g. a node_exporter textfile collector directory.
+     * @return true If the file was written.
+     */
+    bool writePrometheus(const std::string& path);
+
+}
+}
+
+#ifdef MTM_METRICS
+
+#define MTM_METRICS_CONCAT_INNER(a, b) a##b
+#define MTM_METRICS_CONCAT(a, b) MTM_METRICS_CONCAT_INNER(a, b)
+
+#define MTM_METRICS_ONLY(...) __VA_ARGS__
+#define MTM_METRICS_TIME_OPERATION(operation) \
+    mtm::metrics::ScopedTimer MTM_METRICS_CONCAT(mtmMetricsTimer, __LINE__)(mtm::metrics::Operation::operation)
+#define MTM_METRICS_RECORD_INSERT(comparisons, lengthAfter) mtm::metrics::recordInsert((comparisons), (lengthAfter))
+#define MTM_METRICS_NODE_ALLOCATED() \
+    mtm::metrics::registry().nodesAllocated.fetch_add(1, std::memory_order_relaxed)
+#define MTM_METRICS_NODE_FREED() \
+    mtm::metrics::registry().nodesFreed.fetch_add(1, std::memory_order_relaxed)
+
+#else
+
+#define MTM_METRICS_ONLY(...)
+#define MTM_METRICS_TIME_OPERATION(operation)
+#define MTM_METRICS_RECORD_INSERT(comparisons, lengthAfter)
+#define MTM_METRICS_NODE_ALLOCATED()
+#define MTM_METRICS_NODE_FREED()
+
+#endif
@@ -1,51 +1,622 @@
 
 #include "Person.h"
+#include "MemoryUsage.h"
+
+#include <algorithm>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
 using std::endl;
 
+namespace {
+    // one past the highest id in the list (at least watermark)
+    int watermarkOf(const SortedList<Task>& tasks, int watermark) {
+        for (const Task& curTask : tasks) {
+            watermark = std::max(watermark, curTask.getId() + 1);
+        }
+        return watermark;
+    }
+
+    // tasks in operator> order, as a list
+    template <typename Iterator>
+    SortedList<Task> listOf(Iterator first, Iterator last) {
+        SortedList<Task> tasks;
+        tasks.insert(first, last);
+        return tasks;
+    }
+}
+
 // Constructor
-Person::Person(const string &name) : m_name(name) {}
+Person::Person(const string &name, TaskStorage storage) : m_name(name) {
+    if (storage == TaskStorage::Buckets) {
+        m_buckets = std::make_shared<TaskBucketQueue>();
+    }
+    else {
+        m_tasks = std::make_shared<SortedList<Task>>();
+    }
+}
+
+Person::Person(const Person& other) : m_name(other.m_name) {
+    std::lock_guard<std::mutex> lock(other.m_tasksMutex);
+    m_counts = other.m_counts;
+    m_pendingBumps = other.m_pendingBumps;
+    m_idWatermark = other.m_idWatermark;
+    m_capacity = other.m_capacity;
+    m_tasks = other.m_tasks;
+    m_buckets = other.m_buckets;
+    m_tasksShared = true;
+    other.m_tasksShared = true;
+}
+
+Person& Person::operator=(const Person& other) {
+    if (this == &other) {
+        return *this;
+    }
+
+    std::shared_ptr<SortedList<Task>> otherTasks;
+    std::shared_ptr<TaskBucketQueue> otherBuckets;
+    Counts otherCounts;
+    PriorityOffsets otherPendingBumps;
+    int otherIdWatermark = 0;
+    int otherCapacity = 0;
+    {
+        std::lock_guard<std::mutex> otherLock(other.m_tasksMutex);
+        otherTasks = other.m_tasks;
+        otherBuckets = other.m_buckets;
+        otherCounts = other.m_counts;
+        otherPendingBumps = other.m_pendingBumps;
+        otherIdWatermark = other.m_idWatermark;
+        otherCapacity = other.m_capacity;
+        other.m_tasksShared = true;
+    }
+    std::lock_guard<std::mutex> lock(m_tasksMutex);
+    m_name = other.m_name;
+    m_counts = otherCounts;
+    m_pendingBumps = std::move(otherPendingBumps);
+    m_idWatermark = otherIdWatermark;
+    m_capacity = otherCapacity;
+    m_tasks = otherTasks;
+    m_buckets = otherBuckets;
+    m_tasksShared = true;
+    return *this;
+}
+
+Person& Person::operator=(Person&& other) {
+    if (this == &other) {
+        return *this;
+    }
+
+    std::scoped_lock lock(m_tasksMutex, other.m_tasksMutex);
+    m_name = std::move(other.m_name);
+    std::swap(m_counts, other.m_counts);
+    std::swap(m_pendingBumps, other.m_pendingBumps);
+    std::swap(m_idWatermark, other.m_idWatermark);
+    std::swap(m_capacity, other.m_capacity);
+    std::swap(m_tasks, other.m_tasks);
+    std::swap(m_buckets, other.m_buckets);
+    std::swap(m_tasksShared, other.m_tasksShared);
+    return *this;
+}
 
 // Getters and setters
 string Person::getName() const {
     return m_name;
 }
 
+std::size_t Person::getNameHeapBytes() const {
+    return MemoryUsage::stringHeapBytes(m_name);
+}
+
 const SortedList<Task>& Person::getTasks() const {
-    return m_tasks;
+    if (m_buckets == nullptr && m_pendingBumps.empty()) {
+        return *m_tasks;
+    }
+    std::lock_guard<std::mutex> lock(m_tasksMutex);
+    foldPendingBumps();
+    return *currentTasks();
+}
+
+void Person::forEachTask(const std::function<bool(const Task&)>& visit, bool fromLowest) const {
+    std::lock_guard<std::mutex> lock(m_tasksMutex);
+    foldPendingBumps();
+    if (m_buckets != nullptr) {
+        if (fromLowest) {
+            m_buckets->forEachFromLowest(visit);
+            return;
+        }
+        for (const Task& curTask : *m_buckets) {
+            if (!visit(curTask)) {
+                return;
+            }
+        }
+        return;
+    }
+    if (fromLowest) {
+        for (auto It = m_tasks->rbegin(); It != m_tasks->rend(); ++It) {
+            if (!visit(*It)) {
+                return;
+            }
+        }
+        return;
+    }
+    for (const Task& curTask : *m_tasks) {
+        if (!visit(curTask)) {
+            return;
+        }
+    }
+}
+
+std::shared_ptr<const SortedList<Task>> Person::snapshot() const {
+    return freezeTasks().toList();
+}
+
+Person::FrozenTasks Person::freezeTasks() const {
+    FrozenTasks frozen;
+    std::lock_guard<std::mutex> lock(m_tasksMutex);
+    if (m_tasks != nullptr) {
+        frozen.tasks = m_tasks;
+        if (m_buckets == nullptr) {
+            m_tasksShared = true; // a list built from the buckets is never changed, it needs no flag
+        }
+    }
+    else {
+        frozen.buckets = m_buckets; // the reader builds the list
+        m_tasksShared = true;
+    }
+    frozen.pendingBumps = m_pendingBumps;
+    return frozen;
+}
+
+std::shared_ptr<const SortedList<Task>> Person::FrozenTasks::toList() const {
+    if (buckets != nullptr) {
+        std::vector<Task> bucketTasks;
+        bucketTasks.reserve(buckets->length());
+        for (const Task& curTask : *buckets) {
+            bucketTasks.push_back(curTask);
+            if (!pendingBumps.empty()) {
+                bucketTasks.back().setPriority(curTask.getPriority() + pendingBumps.offsetOf(curTask));
+            }
+        }
+        return std::make_shared<const SortedList<Task>>(listOf(bucketTasks.begin(), bucketTasks.end()));
+    }
+    if (pendingBumps.empty()) {
+        return tasks;
+    }
+    return std::make_shared<const SortedList<Task>>(tasks->apply([this](const Task& curTask) -> Task {
+        Task newTask = curTask;
+        newTask.setPriority(curTask.getPriority() + pendingBumps.offsetOf(curTask));
+        return newTask;
+    }));
 }
 
 void Person::setTasks(const SortedList<Task>& tasks) {
-    m_tasks = tasks;
+    Counts newCounts;
+    newCounts.add(tasks);
+    if (m_buckets != nullptr) {
+        std::shared_ptr<TaskBucketQueue> newBuckets = std::make_shared<TaskBucketQueue>();
+        for (const Task& curTask : tasks) {
+            newBuckets->insert(curTask);
+        }
+        std::lock_guard<std::mutex> lock(m_tasksMutex);
+        m_buckets = newBuckets;
+        m_tasks = nullptr;
+        m_counts = newCounts;
+        m_pendingBumps.clear();
+        m_idWatermark = watermarkOf(tasks, 0);
+        m_tasksShared = false;
+        return;
+    }
+
+    std::shared_ptr<SortedList<Task>> newTasks = std::make_shared<SortedList<Task>>(tasks);
+    std::lock_guard<std::mutex> lock(m_tasksMutex);
+    m_tasks = newTasks;
+    m_counts = newCounts;
+    m_pendingBumps.clear();
+    m_idWatermark = watermarkOf(tasks, 0);
+    m_tasksShared = false;
+}
+
+const TaskStats& Person::stats() const {
+    return m_counts.stats;
 }
 
 // Other methods
-void Person::assignTask(const Task& task) {
-    m_tasks.insert(task);
+void Person::assignTask(const Task& task, const EvictionCallback& onEvicted) {
+    std::vector<Task> evicted;
+    {
+        std::lock_guard<std::mutex> lock(m_tasksMutex);
+        const bool full = m_capacity > 0 && m_counts.stats.getTotalCount() >= m_capacity;
+        if (m_pendingBumps.mayAffect(task) || full) {
+            // an older id than a pending bump's watermark - it must not get the bump. and a full person needs
+            // the final priorities to tell which task is the lowest
+            foldPendingBumps();
+        }
+        m_idWatermark = std::max(m_idWatermark, task.getId() + 1);
+        if (m_buckets != nullptr) {
+            mutableBuckets().insert(task);
+        }
+        else {
+            mutableTasks().insert(task);
+        }
+        m_counts.add(task);
+        while (m_capacity > 0 && m_counts.stats.getTotalCount() > m_capacity) {
+            evicted.push_back(evictLowest());
+        }
+    }
+    if (onEvicted) {
+        for (const Task& curTask : evicted) {
+            onEvicted(curTask);
+        }
+    }
+}
+
+void Person::assignTasks(const std::vector<Task>& tasks, const EvictionCallback& onEvicted) {
+    SortedList<Task> sortedTasks;
+    if (m_buckets == nullptr) {
+        sortedTasks.insert(tasks.begin(), tasks.end()); // before the lock - the person is not needed for it
+    }
+    std::vector<Task> evicted;
+    {
+        std::lock_guard<std::mutex> lock(m_tasksMutex);
+        const bool mayAffect = std::any_of(tasks.begin(), tasks.end(), [this](const Task& curTask) {
+            return m_pendingBumps.mayAffect(curTask);
+        });
+        const bool overflows = m_capacity > 0 &&
+                               m_counts.stats.getTotalCount() + static_cast<int>(tasks.size()) > m_capacity;
+        if (mayAffect || overflows) {
+            foldPendingBumps();
+        }
+        for (const Task& curTask : tasks) {
+            m_idWatermark = std::max(m_idWatermark, curTask.getId() + 1);
+            m_counts.add(curTask);
+        }
+        if (m_buckets != nullptr) {
+            TaskBucketQueue& buckets = mutableBuckets();
+            for (const Task& curTask : tasks) {
+                buckets.insert(curTask);
+            }
+        }
+        else {
+            mutableTasks().merge(std::move(sortedTasks));
+        }
+        // the lowest tasks of all go - the same ones evicting after every assign would leave out
+        while (m_capacity > 0 && m_counts.stats.getTotalCount() > m_capacity) {
+            evicted.push_back(evictLowest());
+        }
+    }
+    if (onEvicted) {
+        for (const Task& curTask : evicted) {
+            onEvicted(curTask);
+        }
+    }
+}
+
+int Person::getCapacity() const {
+    return m_capacity;
+}
+
+void Person::setCapacity(int capacity, const EvictionCallback& onEvicted) {
+    if (capacity < 0) {
+        throw std::invalid_argument("A person's capacity cannot be negative");
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_tasksMutex);
+        m_capacity = capacity;
+    }
+    trimToCapacity(onEvicted);
+}
+
+int Person::trimToCapacity(const EvictionCallback& onEvicted) {
+    std::vector<Task> evicted;
+    {
+        std::lock_guard<std::mutex> lock(m_tasksMutex);
+        if (m_capacity > 0 && m_counts.stats.getTotalCount() > m_capacity) {
+            foldPendingBumps();
+            while (m_counts.stats.getTotalCount() > m_capacity) {
+                evicted.push_back(evictLowest());
+            }
+        }
+    }
+    if (onEvicted) {
+        for (const Task& curTask : evicted) {
+            onEvicted(curTask);
+        }
+    }
+    return static_cast<int>(evicted.size());
 }
 
 
 int Person::completeTask() {
-    if (m_tasks.length() == 0) {
+    std::lock_guard<std::mutex> lock(m_tasksMutex);
+    if (m_counts.stats.getTotalCount() == 0) {
         throw std::runtime_error("No tasks assigned to this person.");
     }
-    int taskId = (*m_tasks.begin()).getId();
-    m_tasks.remove(m_tasks.begin());
+    foldPendingBumps();
+    if (m_buckets != nullptr) {
+        const Task completedTask = mutableBuckets().popHighest();
+        m_counts.remove(completedTask);
+        return completedTask.getId();
+    }
+    SortedList<Task>& tasks = mutableTasks();
+    const Task& completedTask = *tasks.begin();
+    int taskId = completedTask.getId();
+    m_counts.remove(completedTask);
+    tasks.remove(tasks.begin());
     return taskId;
 }
 
+void Person::bumpPriorityByType(TaskTypeSet types, int priority) {
+    std::lock_guard<std::mutex> lock(m_tasksMutex);
+    if (priority > 0) {
+        // recorded only - folded into the tasks the next time they are read or completed
+        for (int type = 0; type < NUM_TASK_TYPES; ++type) {
+            const TaskType taskType = static_cast<TaskType>(type);
+            if (types.contains(taskType) && m_counts.stats.getCountByType(taskType) > 0) {
+                m_pendingBumps.add(taskType, priority, m_idWatermark);
+                m_counts.bump(taskType, priority);
+            }
+        }
+        return;
+    }
+
+    // a negative bump does not commute with the clamping of the pending ones
+    foldPendingBumps();
+    for (int type = 0; type < NUM_TASK_TYPES; ++type) {
+        if (types.contains(static_cast<TaskType>(type))) {
+            m_counts.bump(static_cast<TaskType>(type), priority);
+        }
+    }
+    if (m_buckets != nullptr) {
+        mutableBuckets().bumpPriorityByType(types, priority);
+        return;
+    }
+
+    // apply builds a new list anyway, so it simply replaces the shared one
+    std::shared_ptr<SortedList<Task>> newTasks = std::make_shared<SortedList<Task>>(
+        m_tasks->apply([&types, &priority](const Task& curTask) -> Task {
+            if (types.contains(curTask.getType())) {
+                const int newPriority = curTask.getPriority() + priority;
+                Task newTask(newPriority, curTask.getType(), curTask.getDescription());
+                newTask.setId(curTask.getId());
+                return newTask;
+            }
+            return curTask;
+        }));
+
+    m_tasks = newTasks;
+    m_tasksShared = false;
+}
+
+int Person::mergeTasksFrom(Person& other) {
+    if (this == &other) {
+        return 0;
+    }
+
+    if ((m_buckets == nullptr) != (other.m_buckets == nullptr)) {
+        // the persons store their tasks differently - the tasks go through a list
+        SortedList<Task> otherTasks = other.detachLowestTasks(other.stats().getTotalCount());
+        const int numOfTasks = otherTasks.length();
+        mergeTasks(std::move(otherTasks));
+        return numOfTasks;
+    }
+
+    std::scoped_lock lock(m_tasksMutex, other.m_tasksMutex);
+    foldPendingBumps();
+    other.foldPendingBumps();
+    m_idWatermark = std::max(m_idWatermark, other.m_idWatermark);
+    if (m_buckets != nullptr) {
+        const int numOfTasks = other.m_buckets->length();
+        mutableBuckets().merge(std::move(other.mutableBuckets()));
+        m_counts.add(other.m_counts);
+        other.m_counts = Counts();
+        return numOfTasks;
+    }
+    SortedList<Task>& otherTasks = other.mutableTasks();
+    const int numOfTasks = otherTasks.length();
+    mutableTasks().merge(std::move(otherTasks));
+    m_counts.add(other.m_counts);
+    other.m_counts = Counts();
+    return numOfTasks;
+}
+
+void Person::mergeTasks(SortedList<Task>&& tasks) {
+    Counts tasksCounts;
+    tasksCounts.add(tasks);
+    const int tasksWatermark = watermarkOf(tasks, m_idWatermark);
+    std::lock_guard<std::mutex> lock(m_tasksMutex);
+    foldPendingBumps();
+    m_idWatermark = tasksWatermark;
+    if (m_buckets != nullptr) {
+        TaskBucketQueue& buckets = mutableBuckets();
+        for (const Task& curTask : tasks) {
+            buckets.insert(curTask);
+        }
+        tasks = SortedList<Task>();
+    }
+    else {
+        mutableTasks().merge(std::move(tasks));
+    }
+    m_counts.add(tasksCounts);
+}
+
+SortedList<Task> Person::detachLowestTasks(int numOfTasks) {
+    std::lock_guard<std::mutex> lock(m_tasksMutex);
+    foldPendingBumps();
+    if (m_buckets != nullptr) {
+        TaskBucketQueue& buckets = mutableBuckets();
+        std::vector<Task> detached;
+        while (static_cast<int>(detached.size()) < numOfTasks && buckets.length() > 0) {
+            detached.push_back(buckets.popLowest());
+            m_counts.remove(detached.back());
+        }
+        return listOf(detached.rbegin(), detached.rend());
+    }
+    SortedList<Task>& tasks = mutableTasks();
+    SortedList<Task>::ConstIterator position = tasks.end();
+    for (int i = 0; i < numOfTasks && position != tasks.begin(); ++i) {
+        --position;
+    }
+    SortedList<Task> detached = tasks.split(position);
+    Counts detachedCounts;
+    detachedCounts.add(detached);
+    m_counts.remove(detachedCounts);
+    return detached;
+}
+
+SortedList<Task> Person::detachTasks(const std::function<bool(const Task&)>& predicate) {
+    std::lock_guard<std::mutex> lock(m_tasksMutex);
+    foldPendingBumps();
+    if (m_buckets != nullptr) {
+        const std::vector<Task> detached = mutableBuckets().extractIf(predicate);
+        for (const Task& curTask : detached) {
+            m_counts.remove(curTask);
+        }
+        return listOf(detached.begin(), detached.end());
+    }
+    SortedList<Task> detached = mutableTasks().split(predicate);
+    Counts detachedCounts;
+    detachedCounts.add(detached);
+    m_counts.remove(detachedCounts);
+    return detached;
+}
+
 const Task& Person::getHighestPriorityTask() const {
-    if (m_tasks.length() == 0) {
+    if (m_counts.stats.getTotalCount() == 0) {
+        throw std::runtime_error("No tasks assigned to this person.");
+    }
+    std::lock_guard<std::mutex> lock(m_tasksMutex);
+    foldPendingBumps();
+    if (m_buckets != nullptr) {
+        return m_buckets->highest();
+    }
+    return (*m_tasks->begin());
+}
+
+const Task& Person::getLowestPriorityTask() const {
+    if (m_counts.stats.getTotalCount() == 0) {
         throw std::runtime_error("No tasks assigned to this person.");
     }
-    return (*m_tasks.begin());
+    std::lock_guard<std::mutex> lock(m_tasksMutex);
+    foldPendingBumps();
+    if (m_buckets != nullptr) {
+        return m_buckets->lowest();
+    }
+    return (*m_tasks->rbegin());
+}
+
+// -------------------------------- helpers -------------------------------- //
+
+SortedList<Task>& Person::mutableTasks() {
+    // a snapshot or a copied person may still see this list - give this person its own copy.
+    // (use_count() would miss the happens-before with a reader that just let go, so sharing is tracked explicitly)
+    if (m_tasksShared) {
+        m_tasks = std::make_shared<SortedList<Task>>(*m_tasks);
+        m_tasksShared = false;
+    }
+    return *m_tasks;
+}
+
+TaskBucketQueue& Person::mutableBuckets() const {
+    if (m_tasksShared) {
+        m_buckets = std::make_shared<TaskBucketQueue>(*m_buckets);
+        m_tasksShared = false;
+    }
+    m_tasks = nullptr;
+    return *m_buckets;
+}
+
+void Person::foldPendingBumps() const {
+    if (m_pendingBumps.empty()) {
+        return;
+    }
+
+    // every pending bump of every type in one pass over the tasks - the counts have them already
+    if (m_buckets != nullptr) {
+        mutableBuckets().bumpPriorities([this](const Task& curTask) {
+            return m_pendingBumps.offsetOf(curTask);
+        });
+    }
+    else {
+        m_tasks = std::make_shared<SortedList<Task>>(m_tasks->apply([this](const Task& curTask) -> Task {
+            const int amount = m_pendingBumps.offsetOf(curTask);
+            if (amount == 0) {
+                return curTask;
+            }
+            Task newTask = curTask;
+            newTask.setPriority(curTask.getPriority() + amount);
+            return newTask;
+        }));
+        m_tasksShared = false;
+    }
+    m_pendingBumps.clear();
+}
+
+Task Person::evictLowest() {
+    if (m_buckets != nullptr) {
+        Task evicted = mutableBuckets().popLowest();
+        m_counts.remove(evicted);
+        return evicted;
+    }
+    SortedList<Task>& tasks = mutableTasks();
+    const SortedList<Task>::ConstIterator lowest = std::prev(tasks.end()); // the tail, no walk
+    Task evicted = *lowest;
+    tasks.remove(lowest);
+    m_counts.remove(evicted);
+    return evicted;
+}
+
+const std::shared_ptr<SortedList<Task>>& Person::currentTasks() const {
+    if (m_tasks == nullptr) {
+        m_tasks = std::make_shared<SortedList<Task>>(listOf(m_buckets->begin(), m_buckets->end()));
+    }
+    return m_tasks;
+}
+
+void Person::Counts::add(const Task& task) {
+    stats.add(task);
+    byTypeAndPriority[static_cast<int>(task.getType())][task.getPriority() - Task::MIN_PRIORITY]++;
+}
+
+void Person::Counts::remove(const Task& task) {
+    stats.remove(task);
+    byTypeAndPriority[static_cast<int>(task.getType())][task.getPriority() - Task::MIN_PRIORITY]--;
+}
+
+void Person::Counts::add(const SortedList<Task>& tasks) {
+    for (const Task& curTask : tasks) {
+        add(curTask);
+    }
+}
+
+void Person::Counts::add(const Counts& other) {
+    stats.add(other.stats);
+    for (int type = 0; type < NUM_TASK_TYPES; ++type) {
+        for (int bucket = 0; bucket < TaskStats::NUM_PRIORITIES; ++bucket) {
+            byTypeAndPriority[type][bucket] += other.byTypeAndPriority[type][bucket];
+        }
+    }
+}
+
+void Person::Counts::remove(const Counts& other) {
+    stats.remove(other.stats);
+    for (int type = 0; type < NUM_TASK_TYPES; ++type) {
+        for (int bucket = 0; bucket < TaskStats::NUM_PRIORITIES; ++bucket) {
+            byTypeAndPriority[type][bucket] -= other.byTypeAndPriority[type][bucket];
+        }
+    }
+}
+
+void Person::Counts::bump(TaskType type, int amount) {
+    stats.changePriorities(byTypeAndPriority[static_cast<int>(type)], amount);
 }
 
 // Overloaded operators
 ostream& operator<<(ostream& os, const Person& person) {
     os << "Person: " << person.m_name << endl;
     // Assuming the SortedList has an appropriate method to list tasks
-    for (const Task& t: person.m_tasks) {
+    person.forEachTask([&os](const Task& t) {
         os << t << endl;
-    }
+        return true;
+    });
     return os;
 }
@@ -1,30 +1,135 @@
 
 #pragma once
 
+#include <functional>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
+#include "PriorityOffsets.h"
 #include "Task.h"
+#include "TaskBucketQueue.h"
+#include "TaskTypeSet.h"
 #include "SortedList.h"
+#include "TaskStats.h"
 
 using mtm::SortedList;
 using std::ostream;
 using std::string;
 
+/**
+ * @brief How a person stores its tasks.
+ */
+enum class TaskStorage {
+    List,   // a SortedList<Task>, shared with snapshots as is
+    Buckets // a TaskBucketQueue - O(1) assign and complete, snapshots share it and build a SortedList of it
+};
+
 /**
  * @brief Class representing a person who can have tasks assigned.
  */
 class Person {
 private:
     string m_name;
-    SortedList<Task> m_tasks;
+    // copy-on-write: shared with snapshots (and copies of the person), detached before a shared list is changed.
+    // with TaskStorage::Buckets it is only a cache of m_buckets, built when asked for and dropped on every change
+    mutable std::shared_ptr<SortedList<Task>> m_tasks;
+    // TaskStorage::Buckets only (null otherwise) - copy-on-write as well, shared with snapshots and copies of
+    // the person
+    mutable std::shared_ptr<TaskBucketQueue> m_buckets;
+
+    // the stats, and the same tasks counted by type and priority - what a bump moves between the histogram
+    // buckets, so the counts take every bump right away and never wait for the tasks to be folded
+    struct Counts {
+        TaskStats stats;
+        int byTypeAndPriority[NUM_TASK_TYPES][TaskStats::NUM_PRIORITIES] = {};
+
+        void add(const Task& task);
+        void remove(const Task& task);
+        void add(const SortedList<Task>& tasks);
+        void add(const Counts& other);
+        void remove(const Counts& other);
+        // moves the counted tasks of a type by an amount, clamped to the priority range
+        void bump(TaskType type, int amount);
+    };
+
+    Counts m_counts; // pending bumps included
+    // positive bumps not applied to the tasks yet. the readers of the tasks fold them in, so the tasks and the
+    // pending bumps are mutable - folding changes how the tasks are kept, never what they are
+    mutable PriorityOffsets m_pendingBumps;
+    int m_idWatermark = 0; // above the id of every task the person holds
+    int m_capacity = 0; // the most tasks the person holds, 0 for no limit
+    mutable std::mutex m_tasksMutex; // guards the members above against snapshot() on other threads
+    mutable bool m_tasksShared = false;
+
+    // the list, ready to be changed in place. must be called with m_tasksMutex held
+    SortedList<Task>& mutableTasks();
+    // the same for TaskStorage::Buckets - also drops the cached list
+    TaskBucketQueue& mutableBuckets() const;
+    // applies the pending bumps to the tasks. must be called with m_tasksMutex held
+    void foldPendingBumps() const;
+    // the list, built from the buckets if needed. must be called with m_tasksMutex held
+    const std::shared_ptr<SortedList<Task>>& currentTasks() const;
+    // removes the lowest priority task, in O(1). must be called with m_tasksMutex held and the bumps folded
+    Task evictLowest();
 
 public:
+    /**
+     * @brief Called with every task a person drops to stay within its capacity.
+     */
+    using EvictionCallback = std::function<void(const Task&)>;
+
+    /**
+     * @brief The tasks of a person at one point in time, as the person keeps them (see freezeTasks()).
+     */
+    struct FrozenTasks {
+        std::shared_ptr<const SortedList<Task>> tasks;
+        // TaskStorage::Buckets, when the person had no list built - then tasks is null
+        std::shared_ptr<const TaskBucketQueue> buckets;
+        PriorityOffsets pendingBumps; // not applied to tasks (or buckets) yet
+
+        /**
+         * @brief Gets the frozen tasks as a list, applying the pending bumps to a copy if there are any.
+         *
+         * Frozen buckets are built into a list here, in O(number of tasks), on the caller's thread.
+         *
+         * @return std::shared_ptr<const SortedList<Task>> The tasks - shared with the person if no bump is pending
+         *         and it kept them in a list.
+         */
+        std::shared_ptr<const SortedList<Task>> toList() const;
+    };
+
     /**
      * @brief Constructor to create a Person object.
      *
      * @param name The name of the person (default is an empty string).
+     * @param storage How the tasks of the person are stored (default is TaskStorage::List).
+     */
+    Person(const string& name = "", TaskStorage storage = TaskStorage::List);
+
+    /**
+     * @brief Copy constructor - O(1), the tasks are shared until one of the persons changes them.
+     *
+     * @param other The person to be copied.
+     */
+    Person(const Person& other);
+
+    /**
+     * @brief Copy assignment operator - O(1), the tasks are shared until one of the persons changes them.
+     *
+     * @param other The person to be copied.
+     * @return Person& This person.
+     */
+    Person& operator=(const Person& other);
+
+    /**
+     * @brief Move assignment operator - O(1), the persons trade their tasks instead of sharing them.
+     *
+     * @param other The person to be moved from.
+     * @return Person& This person.
      */
-    Person(const string& name = "");
+    Person& operator=(Person&& other);
 
     /**
      * @brief Gets the name of the person.
@@ -33,13 +138,59 @@ public:
      */
     string getName() const;
 
+    /**
+     * @brief Gets the heap memory owned by the name of the person.
+     *
+     * @return std::size_t The size of the name's heap buffer (0 for short names).
+     */
+    std::size_t getNameHeapBytes() const;
+
     /**
      * @brief Gets the list of tasks assigned to the person.
      *
+     * With TaskStorage::Buckets the list is built on the first call after a change, in O(number of tasks), and
+     * kept until then - as much memory again as the buckets. Use forEachTask() to only walk the tasks.
+     * The reference is valid only until the next change of the person - with TaskStorage::Buckets it is a
+     * cache the change drops, and with pending bumps the list is replaced when they are applied. Use
+     * snapshot() to keep the tasks, or to read them on another thread.
+     *
      * @return const SortedList<Task>& The list of tasks assigned to the person.
      */
     const SortedList<Task>& getTasks() const;
 
+    /**
+     * @brief Calls a function with the tasks assigned to the person, one by one, without building a list.
+     *
+     * The pending bumps are applied first. The person is locked while the function runs, so it must not call
+     * the person.
+     *
+     * @param visit Called with every task until it returns false.
+     * @param fromLowest Whether to go from the lowest priority task up, instead of from the highest down.
+     */
+    void forEachTask(const std::function<bool(const Task&)>& visit, bool fromLowest = false) const;
+
+    /**
+     * @brief Takes an immutable snapshot of the tasks assigned to the person.
+     *
+     * The snapshot never changes, and may be iterated on any thread while the person keeps getting
+     * and completing tasks - the next change of the person copies the list instead of touching it.
+     * The person is locked only for freezeTasks(), the pending bumps are applied after it is unlocked.
+     *
+     * @return std::shared_ptr<const SortedList<Task>> The tasks as they are now.
+     */
+    std::shared_ptr<const SortedList<Task>> snapshot() const;
+
+    /**
+     * @brief Freezes the tasks assigned to the person without applying the pending bumps to them.
+     *
+     * O(number of pending bumps) - the list (or with TaskStorage::Buckets the buckets) is shared, and the next
+     * change of the person copies it instead of touching it. Nothing is built here: a list of the buckets is
+     * built by FrozenTasks::toList(), unless one was already built since the last change.
+     *
+     * @return FrozenTasks The tasks as they are now - FrozenTasks::toList() gives them with the bumps applied.
+     */
+    FrozenTasks freezeTasks() const;
+
     /**
      * @brief Sets the list of tasks for the person.
      *
@@ -47,12 +198,62 @@ public:
      */
     void setTasks(const SortedList<Task>& tasks);
 
+    /**
+     * @brief Gets the aggregate counters of the tasks assigned to the person.
+     *
+     * @return const TaskStats& The stats of the person's tasks, kept up to date on every change - bumps
+     *         included, without applying the pending ones to the tasks.
+     */
+    const TaskStats& stats() const;
+
     /**
      * @brief Assigns a new task to the person.
      *
+     * If the person already holds as many tasks as its capacity, the lowest priority task - possibly the new
+     * one - is evicted, in O(1) (the list's tail, or the lowest bucket).
+     *
      * @param task The task to be assigned.
+     * @param onEvicted Called with the evicted task, if any, after the person is unlocked.
+     */
+    void assignTask(const Task& task, const EvictionCallback& onEvicted = nullptr);
+
+    /**
+     * @brief Assigns several new tasks to the person at once - the same as assigning them one by one.
+     *
+     * With TaskStorage::List the tasks are sorted among themselves and merged into the list in one pass,
+     * instead of a search of the list for every task.
+     *
+     * @param tasks The tasks to be assigned.
+     * @param onEvicted Called with every task evicted to stay within the capacity, after the person is unlocked.
+     */
+    void assignTasks(const std::vector<Task>& tasks, const EvictionCallback& onEvicted = nullptr);
+
+    /**
+     * @brief Gets the most tasks the person holds.
+     *
+     * @return int The capacity of the person, 0 for no limit.
+     */
+    int getCapacity() const;
+
+    /**
+     * @brief Sets the most tasks the person holds, and evicts the lowest priority tasks above it.
+     *
+     * Only assignTask() and trimToCapacity() evict - tasks merged or set in may leave the person above its
+     * capacity until then.
+     *
+     * @param capacity The new capacity, 0 for no limit.
+     * @param onEvicted Called with every evicted task, from the lowest priority up, after the person is unlocked.
+     * @throws std::invalid_argument If the capacity is negative.
      */
-    void assignTask(const Task& task);
+    void setCapacity(int capacity, const EvictionCallback& onEvicted = nullptr);
+
+    /**
+     * @brief Evicts the lowest priority tasks above the person's capacity, O(1) each.
+     *
+     * @param onEvicted Called with every evicted task, from the lowest priority up, after the person is unlocked.
+     * @return int The number of tasks evicted.
+     */
+    int trimToCapacity(const EvictionCallback& onEvicted = nullptr);
 
     /**
      * @brief Completes the highest priority task from the list of tasks.
@@ -61,6 +262,49 @@ public:
      */
     int completeTask();
 
+    /**
+     * @brief Bumps the priority of all the person's tasks of the given types, in one pass.
+     *
+     * A positive bump is only recorded: the stats take it right away, in O(number of priorities) per type, and
+     * the tasks together with every other pending bump the next time they are read, or a task is completed or
+     * moved - with the same result as applying every bump right away. Snapshots apply the pending bumps to their own copy.
+     *
+     * @param types The types of tasks whose priority will be bumped (a single TaskType converts to a set).
+     * @param priority The amount by which the priority will be increased.
+     */
+    void bumpPriorityByType(TaskTypeSet types, int priority);
+
+    /**
+     * @brief Moves every task of another person to this person, without copying them (see SortedList::merge).
+     *
+     * @param other The person whose tasks are moved - left with no tasks.
+     * @return int The number of tasks moved.
+     */
+    int mergeTasksFrom(Person& other);
+
+    /**
+     * @brief Merges a list of tasks into the person's tasks, without copying them (see SortedList::merge).
+     *
+     * @param tasks The tasks to be merged - left empty.
+     */
+    void mergeTasks(SortedList<Task>&& tasks);
+
+    /**
+     * @brief Detaches the person's lowest priority tasks, without copying them (see SortedList::split).
+     *
+     * @param numOfTasks The number of tasks to detach (all of them if the person has fewer).
+     * @return SortedList<Task> The detached tasks.
+     */
+    SortedList<Task> detachLowestTasks(int numOfTasks);
+
+    /**
+     * @brief Detaches the tasks that satisfy a predicate, without copying them (see SortedList::split).
+     *
+     * @param predicate Called once for every task, from the highest priority to the lowest.
+     * @return SortedList<Task> The detached tasks.
+     */
+    SortedList<Task> detachTasks(const std::function<bool(const Task&)>& predicate);
+
     /**
      * @brief Gets the highest priority task assigned to the person.
      *
@@ -68,6 +312,13 @@ public:
      */
     const Task& getHighestPriorityTask() const;
 
+    /**
+     * @brief Gets the lowest priority task assigned to the person, in O(1).
+     *
+     * @return const Task& The lowest priority task.
+     */
+    const Task& getLowestPriorityTask() const;
+
     /**
      * @brief Overloaded output stream operator for printing Person details.
      *
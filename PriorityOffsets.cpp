@@ -0,0 +1,50 @@
+#include "PriorityOffsets.h"
+
+#include <algorithm>
+
+void PriorityOffsets::add(TaskType type, int amount, int watermark) {
+    std::vector<int>& watermarks = m_watermarks[static_cast<int>(type)];
+    std::vector<long long>& sums = m_sums[static_cast<int>(type)];
+    // bumps with no task assigned in between apply to the same tasks - they are one bump
+    if (!watermarks.empty() && watermarks.back() == watermark) {
+        sums.back() += amount;
+    }
+    else {
+        sums.push_back((sums.empty() ? 0 : sums.back()) + amount);
+        watermarks.push_back(watermark);
+    }
+    m_newestWatermark = m_empty ? watermark : std::max(m_newestWatermark, watermark);
+    m_empty = false;
+}
+
+int PriorityOffsets::offsetOf(const Task& task) const {
+    return offsetOf(task.getType(), task.getId());
+}
+
+int PriorityOffsets::offsetOf(TaskType type, int taskId) const {
+    const std::vector<int>& watermarks = m_watermarks[static_cast<int>(type)];
+    const std::vector<long long>& sums = m_sums[static_cast<int>(type)];
+    if (watermarks.empty()) {
+        return 0;
+    }
+    // the bumps recorded after the task was, are the ones whose watermark is above its id
+    const auto firstApplied = std::upper_bound(watermarks.begin(), watermarks.end(), taskId);
+    const long long skipped = (firstApplied == watermarks.begin()) ? 0 : sums[firstApplied - watermarks.begin() - 1];
+    return static_cast<int>(std::min<long long>(sums.back() - skipped, Task::MAX_PRIORITY - Task::MIN_PRIORITY));
+}
+
+bool PriorityOffsets::mayAffect(const Task& task) const {
+    return !m_empty && task.getId() < m_newestWatermark;
+}
+
+bool PriorityOffsets::empty() const {
+    return m_empty;
+}
+
+void PriorityOffsets::clear() {
+    for (int type = 0; type < NUM_TASK_TYPES; ++type) {
+        m_watermarks[type].clear();
+        m_sums[type].clear();
+    }
+    m_empty = true;
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <vector>
+
+#include "Task.h"
+
+/**
+ * @brief Priority bumps that were recorded but not applied to any task yet.
+ *
+ * Every bump adds an amount to the tasks of one type that exist when it is recorded - the tasks with an id
+ * below the bump's watermark (ids only grow). The offset of a task is the sum of the bumps of its type that
+ * it is older than, and applying it with the usual [0, 100] clamp gives exactly the priority that bumping
+ * the task eagerly would have: every amount is positive, so clamping once at the end is clamping after
+ * every bump.
+ */
+class PriorityOffsets {
+    // per type, the watermarks of its bumps in the order they were recorded (never decreasing), and
+    // m_sums[type][i] = the amounts of bumps 0..i together
+    std::vector<int> m_watermarks[NUM_TASK_TYPES];
+    std::vector<long long> m_sums[NUM_TASK_TYPES];
+    int m_newestWatermark = 0;
+    bool m_empty = true;
+
+public:
+    /**
+     * @brief Records a bump of the tasks of a type with an id below a watermark, in O(1).
+     *
+     * @param type The type of tasks the bump applies to.
+     * @param amount The amount added to their priority - must be positive.
+     * @param watermark The id of the first task the bump does not apply to, not below any earlier watermark.
+     */
+    void add(TaskType type, int amount, int watermark);
+
+    /**
+     * @brief Gets the amount to add to the priority of a task, in O(log(number of bumps of its type)).
+     *
+     * @param task The task.
+     * @return int The sum of the recorded bumps that apply to the task, capped to the width of the priority range.
+     */
+    int offsetOf(const Task& task) const;
+
+    /**
+     * @brief Gets the amount to add to the priority of a task given by its type and id.
+     *
+     * @param type The type of the task.
+     * @param taskId The id of the task.
+     * @return int The same offset as offsetOf(task).
+     */
+    int offsetOf(TaskType type, int taskId) const;
+
+    /**
+     * @brief Checks whether a task would be affected by any recorded bump.
+     *
+     * @param task The task.
+     * @return true If the task's id is below the newest watermark.
+     */
+    bool mayAffect(const Task& task) const;
+
+    /**
+     * @brief Checks whether there are recorded bumps.
+     *
+     * @return true If no bump was recorded since the last clear().
+     */
+    bool empty() const;
+
+    /**
+     * @brief Forgets every recorded bump.
+     */
+    void clear();
+};
@@ -0,0 +1,26 @@
+#pragma once
+
+/**
+ * @brief What TaskManager::rebalance() evens out between persons.
+ */
+enum class RebalanceMeasure {
+    TaskCount,  // the number of tasks of every person
+    PrioritySum // the summed priority of every person's tasks
+};
+
+/**
+ * @brief How TaskManager::rebalance() redistributes tasks.
+ */
+struct RebalancePolicy {
+    RebalanceMeasure measure = RebalanceMeasure::TaskCount;
+    bool perTaskType = false; // balance every TaskType on its own, instead of all the tasks together
+};
+
+/**
+ * @brief What a rebalance did. Loads are in the policy's measure - per type, if the policy balances per type.
+ */
+struct RebalanceReport {
+    long long tasksMoved = 0;
+    long long maxLoadBefore = 0; // the highest load of a person before the rebalance
+    long long maxLoadAfter = 0;  // and after it
+};
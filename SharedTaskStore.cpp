@@ -0,0 +1,649 @@
+#include "SharedTaskStore.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    constexpr std::uint64_t MAGIC = 0x534b5341544d544dULL; // "MTMTASKS"
+    constexpr std::uint32_t LAYOUT_VERSION = 1;
+    constexpr int NUM_SIZE_CLASSES = 40;
+    constexpr int MIN_SIZE_CLASS = 4; // 16 byte blocks, so every block stays 16 byte aligned
+    constexpr std::uint32_t OUT_OF_SPACE = 1;
+    constexpr std::uint32_t CLOSED = 2;
+
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "the sequence is shared between processes");
+    static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "the flags are shared between processes");
+
+    // where a T is in the segment - the same in every process that maps it, unlike its address. 0 is null
+    template <typename T>
+    struct Offset {
+        std::uint64_t value = 0;
+    };
+
+    struct TaskNode {
+        Offset<TaskNode> next; // towards the lowest priority
+        Offset<TaskNode> prev;
+        Offset<char> description;
+        std::uint32_t descriptionLength;
+        std::uint32_t owner; // the slot of the person
+        std::int32_t id;
+        std::int32_t priority;
+        std::uint8_t type;
+    };
+
+    struct PersonRecord {
+        Offset<char> name;
+        std::uint32_t nameLength;
+        std::uint32_t numOfTasks;
+        Offset<TaskNode> head; // the highest priority task
+        Offset<TaskNode> tail;
+    };
+
+    struct Header {
+        std::uint64_t magic;
+        std::uint32_t layoutVersion;
+        std::uint32_t maxPersons;
+        std::uint64_t segmentSize;
+        std::atomic<std::uint64_t> sequence; // odd while the writer is in a write section
+        std::atomic<std::uint32_t> flags;
+        std::uint32_t numOfPersons;
+        std::uint64_t version; // the TaskManager's version the contents are of
+        Offset<PersonRecord> records; // maxPersons slots
+        Offset<std::uint32_t> order;  // the slots of the persons, in order of addition
+        std::uint64_t top;            // everything from here to the end of the segment is unused
+        std::uint64_t freeLists[NUM_SIZE_CLASSES]; // by size class, the first free block - each holds the next
+    };
+
+    std::size_t alignUp(std::size_t bytes) {
+        return (bytes + 15) & ~std::size_t(15);
+    }
+
+    int sizeClassOf(std::size_t bytes) {
+        int sizeClass = MIN_SIZE_CLASS;
+        while ((std::size_t(1) << sizeClass) < bytes) {
+            sizeClass++;
+        }
+        return sizeClass;
+    }
+
+    template <typename T>
+    T* at(char* base, Offset<T> offset) {
+        return reinterpret_cast<T*>(base + offset.value);
+    }
+
+    template <typename T>
+    T* at(char* base, std::uint64_t offset) {
+        return reinterpret_cast<T*>(base + offset);
+    }
+
+    Header* headerOf(char* base) {
+        return reinterpret_cast<Header*>(base);
+    }
+
+    // ---------------------------------- reading ---------------------------------- //
+
+    // reads a segment that may change underneath - any offset or length is checked before it is followed
+    class TornReader {
+        const char* m_base;
+        std::size_t m_size;
+
+        template <typename T>
+        bool fits(std::uint64_t offset, std::size_t count = 1) const {
+            return offset != 0 && offset <= m_size && count <= (m_size - offset) / sizeof(T);
+        }
+
+        bool readString(Offset<char> offset, std::uint32_t length, string& out) const {
+            if (length == 0) {
+                out.clear();
+                return true;
+            }
+            if (!fits<char>(offset.value, length)) {
+                return false;
+            }
+            out.assign(m_base + offset.value, length);
+            return true;
+        }
+
+    public:
+        TornReader(const char* base, std::size_t size) : m_base(base), m_size(size) {}
+
+        const Header& header() const {
+            return *reinterpret_cast<const Header*>(m_base);
+        }
+
+        // the persons named personName, or all of them if it is null
+        bool readPersons(const string* personName, SharedTaskReader::Contents& contents) const {
+            const Header& segment = header();
+            const std::uint32_t numOfPersons = segment.numOfPersons;
+            if (numOfPersons > segment.maxPersons) {
+                return false;
+            }
+            contents.version = segment.version;
+            contents.persons.clear();
+            string name;
+            for (std::uint32_t i = 0; i < numOfPersons; ++i) {
+                const std::uint64_t slotOffset = segment.order.value + i * sizeof(std::uint32_t);
+                if (!fits<std::uint32_t>(slotOffset)) {
+                    return false;
+                }
+                const std::uint32_t slot = *reinterpret_cast<const std::uint32_t*>(m_base + slotOffset);
+                const std::uint64_t recordOffset = segment.records.value + std::uint64_t(slot) * sizeof(PersonRecord);
+                if (slot >= segment.maxPersons || !fits<PersonRecord>(recordOffset)) {
+                    return false;
+                }
+                const PersonRecord record = *reinterpret_cast<const PersonRecord*>(m_base + recordOffset);
+                if (!readString(record.name, record.nameLength, name)) {
+                    return false;
+                }
+                if (personName != nullptr && name != *personName) {
+                    continue;
+                }
+                contents.persons.emplace_back(name, std::vector<Task>());
+                if (!readTasks(record, contents.persons.back().second)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        bool readTasks(const PersonRecord& record, std::vector<Task>& tasks) const {
+            if (record.numOfTasks > m_size / sizeof(TaskNode)) {
+                return false;
+            }
+            tasks.reserve(record.numOfTasks);
+            string description;
+            Offset<TaskNode> current = record.head;
+            for (std::uint32_t i = 0; i < record.numOfTasks; ++i) {
+                if (!fits<TaskNode>(current.value)) {
+                    return false;
+                }
+                const TaskNode node = *reinterpret_cast<const TaskNode*>(m_base + current.value);
+                if (node.type >= NUM_TASK_TYPES || !readString(node.description, node.descriptionLength, description)) {
+                    return false;
+                }
+                Task task(node.priority, static_cast<TaskType>(node.type), description);
+                task.setId(node.id);
+                tasks.push_back(task);
+                current = node.next;
+            }
+            return current.value == 0;
+        }
+    };
+
+    // runs read until it completes outside of any write section
+    template <typename Read>
+    void readConsistently(const char* base, unsigned long long& numOfRetries, Read read) {
+        const Header& header = *reinterpret_cast<const Header*>(base);
+        while (true) {
+            const std::uint64_t sequence = header.sequence.load(std::memory_order_acquire);
+            if (sequence % 2 == 0) {
+                if (header.flags.load(std::memory_order_relaxed) & OUT_OF_SPACE) {
+                    throw std::runtime_error("The shared task store ran out of space - recreate it larger");
+                }
+                const bool complete = read();
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (complete && header.sequence.load(std::memory_order_relaxed) == sequence) {
+                    return;
+                }
+            }
+            numOfRetries++;
+            std::this_thread::yield();
+        }
+    }
+
+    bool isValidName(const string& name) {
+        return name.size() >= 2 && name[0] == '/' && name.find('/', 1) == string::npos;
+    }
+}
+
+// ------------------------------ WriteSection ------------------------------ //
+
+SharedTaskStore::WriteSection::WriteSection(SharedTaskStore* store, const unsigned long long& version) :
+    m_store(store), m_version(version) {
+    if (m_store != nullptr) {
+        std::atomic<std::uint64_t>& sequence = headerOf(m_store->m_base)->sequence;
+        sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        // the odd sequence is visible before any change in the section
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+}
+
+SharedTaskStore::WriteSection::~WriteSection() {
+    if (m_store != nullptr) {
+        Header* header = headerOf(m_store->m_base);
+        header->version = m_version;
+        header->sequence.store(header->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+}
+
+// ------------------------------ SharedTaskStore ----------------------------- //
+
+SharedTaskStore::SharedTaskStore(const string& name, std::size_t segmentBytes, int maxPersons) : m_name(name) {
+    if (!isValidName(name)) {
+        throw std::invalid_argument("A shared memory name is a '/' and a name with no other '/'");
+    }
+    if (maxPersons <= 0) {
+        throw std::invalid_argument("A shared task store needs room for at least one person");
+    }
+    const std::size_t recordsStart = alignUp(sizeof(Header));
+    const std::size_t orderStart = recordsStart + alignUp(maxPersons * sizeof(PersonRecord));
+    const std::size_t heapStart = orderStart + alignUp(maxPersons * sizeof(std::uint32_t));
+    if (segmentBytes < heapStart + 4096) {
+        throw std::invalid_argument("The segment must be at least " + std::to_string(heapStart + 4096) +
+                                    " bytes for " + std::to_string(maxPersons) + " persons");
+    }
+
+    shm_unlink(name.c_str());
+    m_fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, 0644);
+    if (m_fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "shm_open");
+    }
+    if (ftruncate(m_fd, static_cast<off_t>(segmentBytes)) < 0 ||
+        (m_base = static_cast<char*>(mmap(nullptr, segmentBytes, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0))) ==
+        MAP_FAILED) {
+        const int error = errno;
+        close(m_fd);
+        shm_unlink(name.c_str());
+        throw std::system_error(error, std::generic_category(), "mapping a shared task store");
+    }
+    m_size = segmentBytes;
+
+    // the segment starts zeroed - every list empty, every free list empty
+    Header* header = new (m_base) Header();
+    header->layoutVersion = LAYOUT_VERSION;
+    header->maxPersons = static_cast<std::uint32_t>(maxPersons);
+    header->segmentSize = segmentBytes;
+    header->records.value = recordsStart;
+    header->order.value = orderStart;
+    header->top = heapStart;
+    for (int slot = maxPersons - 1; slot >= 0; --slot) {
+        m_freeSlots.push_back(static_cast<std::uint32_t>(slot));
+    }
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = MAGIC; // last, so readers do not take a half made segment for a store
+}
+
+SharedTaskStore::~SharedTaskStore() {
+    headerOf(m_base)->flags.fetch_or(CLOSED, std::memory_order_release);
+    munmap(m_base, m_size);
+    close(m_fd);
+    shm_unlink(m_name.c_str());
+}
+
+std::size_t SharedTaskStore::bytesUsed() const {
+    return headerOf(m_base)->top;
+}
+
+bool SharedTaskStore::isOutOfSpace() const {
+    return headerOf(m_base)->flags.load(std::memory_order_relaxed) & OUT_OF_SPACE;
+}
+
+// -------------------------------- helpers -------------------------------- //
+
+std::uint64_t SharedTaskStore::allocate(std::size_t bytes) {
+    Header* header = headerOf(m_base);
+    const int sizeClass = sizeClassOf(bytes);
+    if (sizeClass >= NUM_SIZE_CLASSES) {
+        markOutOfSpace();
+        return 0;
+    }
+    if (const std::uint64_t block = header->freeLists[sizeClass]) {
+        header->freeLists[sizeClass] = *at<std::uint64_t>(m_base, block);
+        return block;
+    }
+    const std::size_t blockSize = std::size_t(1) << sizeClass;
+    if (blockSize > m_size - header->top) {
+        markOutOfSpace();
+        return 0;
+    }
+    const std::uint64_t block = header->top;
+    header->top += blockSize;
+    return block;
+}
+
+void SharedTaskStore::deallocate(std::uint64_t offset, std::size_t bytes) {
+    if (offset == 0) {
+        return;
+    }
+    Header* header = headerOf(m_base);
+    const int sizeClass = sizeClassOf(bytes);
+    *at<std::uint64_t>(m_base, offset) = header->freeLists[sizeClass];
+    header->freeLists[sizeClass] = offset;
+}
+
+bool SharedTaskStore::storeString(const string& text, std::uint64_t& offset, std::uint32_t& length) {
+    offset = 0;
+    length = 0;
+    if (text.empty()) {
+        return true;
+    }
+    if (text.size() > UINT32_MAX || (offset = allocate(text.size())) == 0) {
+        return false;
+    }
+    std::memcpy(m_base + offset, text.data(), text.size());
+    length = static_cast<std::uint32_t>(text.size());
+    return true;
+}
+
+void SharedTaskStore::markOutOfSpace() {
+    headerOf(m_base)->flags.fetch_or(OUT_OF_SPACE, std::memory_order_relaxed);
+}
+
+std::uint32_t SharedTaskStore::slotAt(int personIndex) const {
+    return at<std::uint32_t>(m_base, headerOf(m_base)->order)[personIndex];
+}
+
+void SharedTaskStore::linkAfter(std::uint32_t slot, std::uint64_t previous, std::uint64_t node) {
+    PersonRecord& record = at<PersonRecord>(m_base, headerOf(m_base)->records)[slot];
+    TaskNode* newNode = at<TaskNode>(m_base, node);
+    newNode->owner = slot;
+    newNode->prev.value = previous;
+    newNode->next = (previous != 0) ? at<TaskNode>(m_base, previous)->next : record.head;
+    if (newNode->next.value != 0) {
+        at<TaskNode>(m_base, newNode->next)->prev.value = node;
+    }
+    else {
+        record.tail.value = node;
+    }
+    if (previous != 0) {
+        at<TaskNode>(m_base, previous)->next.value = node;
+    }
+    else {
+        record.head.value = node;
+    }
+    record.numOfTasks++;
+}
+
+void SharedTaskStore::unlink(std::uint64_t node) {
+    TaskNode* oldNode = at<TaskNode>(m_base, node);
+    PersonRecord& record = at<PersonRecord>(m_base, headerOf(m_base)->records)[oldNode->owner];
+    if (oldNode->prev.value != 0) {
+        at<TaskNode>(m_base, oldNode->prev)->next = oldNode->next;
+    }
+    else {
+        record.head = oldNode->next;
+    }
+    if (oldNode->next.value != 0) {
+        at<TaskNode>(m_base, oldNode->next)->prev = oldNode->prev;
+    }
+    else {
+        record.tail = oldNode->prev;
+    }
+    record.numOfTasks--;
+}
+
+void SharedTaskStore::freeNode(std::uint64_t node) {
+    const TaskNode* oldNode = at<TaskNode>(m_base, node);
+    deallocate(oldNode->description.value, oldNode->descriptionLength);
+    // the task may have a newer node already (see setTasks())
+    if (m_nodeOfTask[oldNode->id] == node) {
+        m_nodeOfTask[oldNode->id] = 0;
+    }
+    deallocate(node, sizeof(TaskNode));
+}
+
+std::uint64_t SharedTaskStore::createNode(std::uint32_t slot, const Task& task) {
+    const std::uint64_t node = allocate(sizeof(TaskNode));
+    if (node == 0) {
+        return 0;
+    }
+    TaskNode* newNode = at<TaskNode>(m_base, node);
+    if (!storeString(task.getDescription(), newNode->description.value, newNode->descriptionLength)) {
+        deallocate(node, sizeof(TaskNode));
+        return 0;
+    }
+    newNode->next.value = 0;
+    newNode->prev.value = 0;
+    newNode->owner = slot;
+    newNode->id = task.getId();
+    newNode->priority = task.getPriority();
+    newNode->type = static_cast<std::uint8_t>(task.getType());
+    if (task.getId() >= static_cast<int>(m_nodeOfTask.size())) {
+        m_nodeOfTask.resize(task.getId() + 1);
+    }
+    m_nodeOfTask[task.getId()] = node;
+    return node;
+}
+
+void SharedTaskStore::relinkInOrder(std::uint32_t slot, std::vector<std::uint64_t>& nodes) {
+    PersonRecord& record = at<PersonRecord>(m_base, headerOf(m_base)->records)[slot];
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        TaskNode* node = at<TaskNode>(m_base, nodes[i]);
+        node->owner = slot;
+        node->prev.value = (i > 0) ? nodes[i - 1] : 0;
+        node->next.value = (i + 1 < nodes.size()) ? nodes[i + 1] : 0;
+    }
+    record.head.value = nodes.empty() ? 0 : nodes.front();
+    record.tail.value = nodes.empty() ? 0 : nodes.back();
+    record.numOfTasks = static_cast<std::uint32_t>(nodes.size());
+}
+
+// ---------------------------------- changes --------------------------------- //
+
+void SharedTaskStore::addPerson(const string& personName) {
+    if (isOutOfSpace() || m_freeSlots.empty()) {
+        return;
+    }
+    Header* header = headerOf(m_base);
+    const std::uint32_t slot = m_freeSlots.back();
+    PersonRecord& record = at<PersonRecord>(m_base, header->records)[slot];
+    record = PersonRecord();
+    if (!storeString(personName, record.name.value, record.nameLength)) {
+        return;
+    }
+    m_freeSlots.pop_back();
+    at<std::uint32_t>(m_base, header->order)[header->numOfPersons++] = slot;
+}
+
+void SharedTaskStore::removePerson(int personIndex) {
+    if (isOutOfSpace()) {
+        return;
+    }
+    Header* header = headerOf(m_base);
+    const std::uint32_t slot = slotAt(personIndex);
+    PersonRecord& record = at<PersonRecord>(m_base, header->records)[slot];
+    for (std::uint64_t node = record.head.value; node != 0;) {
+        const std::uint64_t next = at<TaskNode>(m_base, node)->next.value;
+        freeNode(node);
+        node = next;
+    }
+    deallocate(record.name.value, record.nameLength);
+    record = PersonRecord();
+    m_freeSlots.push_back(slot);
+
+    std::uint32_t* order = at<std::uint32_t>(m_base, header->order);
+    std::copy(order + personIndex + 1, order + header->numOfPersons, order + personIndex);
+    header->numOfPersons--;
+}
+
+void SharedTaskStore::insertTask(int personIndex, const Task& task) {
+    if (isOutOfSpace()) {
+        return;
+    }
+    const std::uint32_t slot = slotAt(personIndex);
+    const std::uint64_t node = createNode(slot, task);
+    if (node == 0) {
+        return;
+    }
+    // after every task that comes first in the person's order
+    std::uint64_t previous = 0;
+    std::uint64_t current = at<PersonRecord>(m_base, headerOf(m_base)->records)[slot].head.value;
+    while (current != 0) {
+        const TaskNode* curNode = at<TaskNode>(m_base, current);
+        if (curNode->priority < task.getPriority() ||
+            (curNode->priority == task.getPriority() && curNode->id > task.getId())) {
+            break;
+        }
+        previous = current;
+        current = curNode->next.value;
+    }
+    linkAfter(slot, previous, node);
+}
+
+void SharedTaskStore::removeTask(int taskId) {
+    if (isOutOfSpace() || taskId < 0 || taskId >= static_cast<int>(m_nodeOfTask.size()) ||
+        m_nodeOfTask[taskId] == 0) {
+        return;
+    }
+    const std::uint64_t node = m_nodeOfTask[taskId];
+    unlink(node);
+    freeNode(node);
+}
+
+void SharedTaskStore::clearTasks(int personIndex) {
+    if (isOutOfSpace()) {
+        return;
+    }
+    const std::uint32_t slot = slotAt(personIndex);
+    PersonRecord& record = at<PersonRecord>(m_base, headerOf(m_base)->records)[slot];
+    for (std::uint64_t node = record.head.value; node != 0;) {
+        const std::uint64_t next = at<TaskNode>(m_base, node)->next.value;
+        freeNode(node);
+        node = next;
+    }
+    record.head.value = 0;
+    record.tail.value = 0;
+    record.numOfTasks = 0;
+}
+
+void SharedTaskStore::appendTask(int personIndex, const Task& task) {
+    if (isOutOfSpace()) {
+        return;
+    }
+    const std::uint32_t slot = slotAt(personIndex);
+    const std::uint64_t node = createNode(slot, task);
+    if (node == 0) {
+        return;
+    }
+    linkAfter(slot, at<PersonRecord>(m_base, headerOf(m_base)->records)[slot].tail.value, node);
+}
+
+void SharedTaskStore::moveTasks(int fromPersonIndex, int toPersonIndex) {
+    if (isOutOfSpace() || fromPersonIndex == toPersonIndex) {
+        return;
+    }
+    const std::uint32_t fromSlot = slotAt(fromPersonIndex);
+    const std::uint32_t toSlot = slotAt(toPersonIndex);
+    PersonRecord* records = at<PersonRecord>(m_base, headerOf(m_base)->records);
+    std::vector<std::uint64_t> nodes;
+    nodes.reserve(records[fromSlot].numOfTasks + records[toSlot].numOfTasks);
+    std::uint64_t a = records[toSlot].head.value;
+    std::uint64_t b = records[fromSlot].head.value;
+    while (a != 0 || b != 0) {
+        const TaskNode* nodeA = (a != 0) ? at<TaskNode>(m_base, a) : nullptr;
+        const TaskNode* nodeB = (b != 0) ? at<TaskNode>(m_base, b) : nullptr;
+        const bool takeA = nodeB == nullptr ||
+                           (nodeA != nullptr && (nodeA->priority > nodeB->priority ||
+                                                 (nodeA->priority == nodeB->priority && nodeA->id < nodeB->id)));
+        if (takeA) {
+            nodes.push_back(a);
+            a = nodeA->next.value;
+        }
+        else {
+            nodes.push_back(b);
+            b = nodeB->next.value;
+        }
+    }
+    relinkInOrder(toSlot, nodes);
+    std::vector<std::uint64_t> none;
+    relinkInOrder(fromSlot, none);
+}
+
+void SharedTaskStore::bumpPriorityByType(TaskTypeSet types, int priority) {
+    if (isOutOfSpace()) {
+        return;
+    }
+    Header* header = headerOf(m_base);
+    PersonRecord* records = at<PersonRecord>(m_base, header->records);
+    std::vector<std::uint64_t> nodes;
+    for (std::uint32_t i = 0; i < header->numOfPersons; ++i) {
+        const std::uint32_t slot = slotAt(static_cast<int>(i));
+        bool bumped = false;
+        nodes.clear();
+        for (std::uint64_t node = records[slot].head.value; node != 0; node = at<TaskNode>(m_base, node)->next.value) {
+            TaskNode* curNode = at<TaskNode>(m_base, node);
+            if (types.contains(static_cast<TaskType>(curNode->type))) {
+                curNode->priority = std::max(Task::MIN_PRIORITY, std::min(curNode->priority + priority,
+                                                                          Task::MAX_PRIORITY));
+                bumped = true;
+            }
+            nodes.push_back(node);
+        }
+        if (!bumped) {
+            continue;
+        }
+        std::stable_sort(nodes.begin(), nodes.end(), [this](std::uint64_t a, std::uint64_t b) {
+            const TaskNode* nodeA = at<TaskNode>(m_base, a);
+            const TaskNode* nodeB = at<TaskNode>(m_base, b);
+            return nodeA->priority > nodeB->priority || (nodeA->priority == nodeB->priority && nodeA->id < nodeB->id);
+        });
+        relinkInOrder(slot, nodes);
+    }
+}
+
+// ------------------------------ SharedTaskReader ----------------------------- //
+
+SharedTaskReader::SharedTaskReader(const string& name) {
+    m_fd = shm_open(name.c_str(), O_RDONLY | O_CLOEXEC, 0);
+    if (m_fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "shm_open");
+    }
+    struct stat status;
+    if (fstat(m_fd, &status) < 0 ||
+        (m_base = static_cast<const char*>(mmap(nullptr, status.st_size, PROT_READ, MAP_SHARED, m_fd, 0))) ==
+        MAP_FAILED) {
+        const int error = errno;
+        close(m_fd);
+        throw std::system_error(error, std::generic_category(), "mapping a shared task store");
+    }
+    m_size = static_cast<std::size_t>(status.st_size);
+    const Header* header = reinterpret_cast<const Header*>(m_base);
+    if (m_size < sizeof(Header) || header->magic != MAGIC || header->layoutVersion != LAYOUT_VERSION ||
+        header->segmentSize != m_size) {
+        munmap(const_cast<char*>(m_base), m_size);
+        close(m_fd);
+        throw std::runtime_error("Not a shared task store: " + name);
+    }
+}
+
+SharedTaskReader::~SharedTaskReader() {
+    munmap(const_cast<char*>(m_base), m_size);
+    close(m_fd);
+}
+
+SharedTaskReader::Contents SharedTaskReader::read() const {
+    const TornReader reader(m_base, m_size);
+    Contents contents;
+    readConsistently(m_base, m_numOfRetries, [&reader, &contents]() {
+        return reader.readPersons(nullptr, contents);
+    });
+    return contents;
+}
+
+std::vector<Task> SharedTaskReader::readTasks(const string& personName) const {
+    const TornReader reader(m_base, m_size);
+    Contents contents;
+    readConsistently(m_base, m_numOfRetries, [&reader, &contents, &personName]() {
+        return reader.readPersons(&personName, contents);
+    });
+    return contents.persons.empty() ? std::vector<Task>() : std::move(contents.persons.front().second);
+}
+
+bool SharedTaskReader::isClosed() const {
+    return reinterpret_cast<const Header*>(m_base)->flags.load(std::memory_order_acquire) & CLOSED;
+}
+
+unsigned long long SharedTaskReader::getNumOfRetries() const {
+    return m_numOfRetries;
+}
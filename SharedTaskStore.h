@@ -0,0 +1,204 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Task.h"
+#include "TaskTypeSet.h"
+
+using std::string;
+
+/**
+ * @brief The persons and tasks of a TaskManager, kept in a POSIX shared-memory segment for other processes.
+ *
+ * The segment holds a person table and, for every person, a doubly linked list of task nodes in the
+ * person's order (highest priority first), with the descriptions and names in blocks of their own. The
+ * segment is mapped at a different address in every process, so nothing in it is a pointer: every link is
+ * the offset of its target from the start of the segment. Blocks come from power-of-two size classes with a
+ * free list each, so a freed node or description is reused by the next one of its size.
+ *
+ * One process writes (the TaskManager's, see TaskManager::enableSharedMemory()) and any number read, with
+ * a seqlock: the writer makes the sequence odd before a change and even after it, and a reader copies what
+ * it needs, then checks that the sequence is the even value it started with - and tries again if not.
+ * Readers never block the writer, and never take a lock. A reader's copy may be torn before the check, so
+ * every offset and length it follows is bounds-checked first.
+ *
+ * Every TaskManager mutation is one write section, so readers see whole mutations only - a reassign, say,
+ * never shows the tasks at both persons. An assign costs a walk to its place in the list, a complete or an
+ * eviction O(1), a bump a pass over every task and a sort of the lists it changed, a reassign or a merge a
+ * merge of two lists, and a rebalance a rewrite of every list.
+ */
+class SharedTaskStore {
+    string m_name;
+    int m_fd = -1;
+    char* m_base = nullptr;
+    std::size_t m_size = 0;
+    std::vector<std::uint64_t> m_nodeOfTask; // by task id, the offset of its node (0 when it has none)
+    std::vector<std::uint32_t> m_freeSlots;  // person table slots not in use
+
+    // blocks of the segment's heap - 0 when it is full (and the store is marked out of space)
+    std::uint64_t allocate(std::size_t bytes);
+    void deallocate(std::uint64_t offset, std::size_t bytes);
+    // copies a string into a new block - false when the segment is full
+    bool storeString(const string& text, std::uint64_t& offset, std::uint32_t& length);
+
+    // the slot of the person at an index in order of addition
+    std::uint32_t slotAt(int personIndex) const;
+    void linkAfter(std::uint32_t slot, std::uint64_t previous, std::uint64_t node);
+    void unlink(std::uint64_t node);
+    void freeNode(std::uint64_t node);
+    // a node for a task, not linked yet - 0 when the segment is full
+    std::uint64_t createNode(std::uint32_t slot, const Task& task);
+    void relinkInOrder(std::uint32_t slot, std::vector<std::uint64_t>& nodes);
+    void markOutOfSpace();
+
+public:
+    /**
+     * @brief Makes a write section of a SharedTaskStore - readers retry reads that overlap it.
+     *
+     * Sections do not nest. A null store makes a section that does nothing, so code that only sometimes
+     * has a store needs no branches.
+     */
+    class WriteSection {
+        SharedTaskStore* m_store;
+        const unsigned long long& m_version;
+
+    public:
+        /**
+         * @brief Opens the section.
+         *
+         * @param store The store written in the section, or nullptr.
+         * @param version The TaskManager's version, published to the readers when the section closes.
+         */
+        WriteSection(SharedTaskStore* store, const unsigned long long& version);
+
+        ~WriteSection();
+
+        WriteSection(const WriteSection& other) = delete;
+        WriteSection& operator=(const WriteSection& other) = delete;
+    };
+
+    /**
+     * @brief Creates the segment and maps it - a segment left by an earlier writer of the same name is
+     * replaced.
+     *
+     * @param name The name of the segment, like "/tasks" (see shm_open).
+     * @param segmentBytes The size of the segment. It never grows - once it is full, the store stops
+     *                     following the TaskManager and readers get an error.
+     * @param maxPersons The most persons the TaskManager holds.
+     * @throws std::invalid_argument If the name is not "/" and a name, or the segment is too small for the
+     *                               person table.
+     * @throws std::system_error If the segment cannot be created or mapped.
+     */
+    SharedTaskStore(const string& name, std::size_t segmentBytes, int maxPersons);
+
+    /**
+     * @brief Marks the segment closed, unmaps it and removes its name - readers that opened it keep their
+     * mapping.
+     */
+    ~SharedTaskStore();
+
+    SharedTaskStore(const SharedTaskStore& other) = delete;
+    SharedTaskStore& operator=(const SharedTaskStore& other) = delete;
+
+    // the changes below are made in a write section, and mirror the TaskManager's changes one for one
+
+    void addPerson(const string& personName);
+    // the persons after it move up one place, like in TaskManager
+    void removePerson(int personIndex);
+    void insertTask(int personIndex, const Task& task);
+    void removeTask(int taskId);
+    // empties a person's task list, to be filled again with appendTask() - O(tasks the person had)
+    void clearTasks(int personIndex);
+    // adds a task after the person's last one, in O(1) - the tasks must be appended in the person's order
+    void appendTask(int personIndex, const Task& task);
+    // moves every task of one person to another, merging the lists
+    void moveTasks(int fromPersonIndex, int toPersonIndex);
+    void bumpPriorityByType(TaskTypeSet types, int priority);
+
+    /**
+     * @brief Gets the bytes of the segment in use - blocks on free lists included.
+     *
+     * @return std::size_t The offset of the end of the used part of the segment.
+     */
+    std::size_t bytesUsed() const;
+
+    /**
+     * @brief Checks whether the segment ran out of space - the store does not follow the TaskManager after.
+     *
+     * @return true If an allocation failed.
+     */
+    bool isOutOfSpace() const;
+};
+
+/**
+ * @brief Reads the persons and tasks a SharedTaskStore keeps, from any process on the host.
+ *
+ * Maps the segment read-only. Reads take no lock and never stop the writer - a read that overlaps a write
+ * section is thrown away and tried again (see SharedTaskStore), so every result is one the TaskManager
+ * really had, between two of its mutations.
+ */
+class SharedTaskReader {
+    int m_fd = -1;
+    const char* m_base = nullptr;
+    std::size_t m_size = 0;
+    mutable unsigned long long m_numOfRetries = 0;
+
+public:
+    /**
+     * @brief The tasks of every person, as of one version of the TaskManager.
+     */
+    struct Contents {
+        unsigned long long version = 0;
+        std::vector<std::pair<string, std::vector<Task>>> persons; // in order of addition
+    };
+
+    /**
+     * @brief Opens a segment and maps it.
+     *
+     * @param name The name the writer created the segment with.
+     * @throws std::system_error If the segment cannot be opened or mapped.
+     * @throws std::runtime_error If the segment is not a task store.
+     */
+    explicit SharedTaskReader(const string& name);
+
+    ~SharedTaskReader();
+
+    SharedTaskReader(const SharedTaskReader& other) = delete;
+    SharedTaskReader& operator=(const SharedTaskReader& other) = delete;
+
+    /**
+     * @brief Reads the tasks of every person.
+     *
+     * @return Contents The persons, their tasks from the highest priority to the lowest, and the version.
+     * @throws std::runtime_error If the store ran out of space, so it no longer follows the TaskManager.
+     */
+    Contents read() const;
+
+    /**
+     * @brief Reads the tasks of one person.
+     *
+     * @param personName The name of the person.
+     * @return std::vector<Task> The person's tasks from the highest priority to the lowest - none if there
+     *                           is no such person.
+     * @throws std::runtime_error If the store ran out of space, so it no longer follows the TaskManager.
+     */
+    std::vector<Task> readTasks(const string& personName) const;
+
+    /**
+     * @brief Checks whether the writer is gone - the contents will not change any more.
+     *
+     * @return true If the writing SharedTaskStore was destroyed.
+     */
+    bool isClosed() const;
+
+    /**
+     * @brief Gets the number of reads that overlapped a write section and were tried again.
+     *
+     * @return unsigned long long The number of retries so far.
+     */
+    unsigned long long getNumOfRetries() const;
+};
@@ -1,16 +1,70 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
 #include <iostream>
+#include <iterator>
 #include <random>
 #include <stdexcept>
+#include <type_traits>
+#include <vector>
 
+#include "AllocationTracker.h"
+#include "BlockSearch.h"
+#include "Metrics.h"
 #include "SortedList.h"
 
 namespace mtm {
 
+    template <typename Iterator>
+    class IteratorView;
+
+    namespace detail {
+
+        // what one SortedList node holds: a single element...
+        template <typename T, bool Unrolled>
+        struct SortedListPayload {
+            static constexpr unsigned int CAPACITY = 1;
+
+            T m_data;
+
+            explicit SortedListPayload(const T& data) : m_data(data) {}
+
+            unsigned int count() const { return 1; }
+            const T& item(unsigned int) const { return m_data; }
+        };
+
+        // ...or, for trivially copyable types, a block of up to CAPACITY elements (an unrolled list).
+        // the elements of a block are kept sorted and shifted around with memmove
+        template <typename T>
+        struct SortedListPayload<T, true> {
+            static constexpr std::size_t BLOCK_BYTES = 256;
+            static constexpr unsigned int CAPACITY = (BLOCK_BYTES / sizeof(T) > 4) ? BLOCK_BYTES / sizeof(T) : 4;
+
+            unsigned int m_count;
+            T m_items[CAPACITY];
+
+            SortedListPayload() : m_count(0) {}
+            explicit SortedListPayload(const T& data) : m_count(1) { m_items[0] = data; }
+
+            unsigned int count() const { return m_count; }
+            const T& item(unsigned int index) const { return m_items[index]; }
+        };
+
+    }
+
     template <typename T>
     class SortedList {
+        // trivially copyable elements (int, packed sort keys...) are stored many per node, everything else keeps
+        // one node per element. the choice is made at compile time and does not change the interface - except
+        // for iterator validity: an iterator is a block and a position in it, so in the unrolled layout
+        // insert and remove shift the elements under the iterators into the list
+        static constexpr bool UNROLLED = std::is_trivially_copyable<T>::value &&
+                                         std::is_trivially_default_constructible<T>::value;
+
         class Node;
+        class NodeBatch;
 
         Node* m_head;
         Node* m_tail;
@@ -18,6 +72,35 @@ namespace mtm {
 
         void clear();
 
+        // appends an element that is not greater than the current last one
+        void pushBack(const T& newData);
+
+        // unlinks the node from the chain, without deleting it
+        void unlinkNode(Node* node);
+
+        // deletes every node after last (every node when last is nullptr), last becomes the tail
+        void truncateAfter(Node* last);
+
+        // operator= of the unrolled layout: refills the existing blocks in place
+        void assignBlocks(const SortedList& other);
+
+        void swapContents(SortedList& other);
+
+        // linked layout only: links nodes, sorted and not in any list, into their places. if comparing throws,
+        // the list is left unchanged
+        void linkSortedNodes(const std::vector<Node*>& nodes);
+
+        // unrolled layout only: replaces the list with its merge with the sorted range [first, last)
+        template <typename Iterator>
+        void mergeValues(Iterator first, Iterator last);
+
+        // unrolled layout only: puts newData at position index of node, splitting the node when it is full
+        void insertIntoBlock(Node* node, unsigned int index, const T& newData);
+
+        // unrolled layout only: the first position in node holding an element lower than newData.
+        // blocks of int are searched with vector compares, see BlockSearch.h
+        static unsigned int blockInsertIndex(const Node* node, const T& newData);
+
     public:
 
         // constructors
@@ -26,10 +109,15 @@ namespace mtm {
 
         SortedList(const SortedList& other);
 
+        // takes the other list's nodes in O(1), the other list is left empty
+        SortedList(SortedList&& other) noexcept;
+
         ~SortedList();
 
         SortedList& operator=(const SortedList& other);
 
+        SortedList& operator=(SortedList&& other) noexcept;
+
         // iterator
 
         class ConstIterator;
@@ -38,14 +126,56 @@ namespace mtm {
 
         ConstIterator end() const;
 
+        using ReverseConstIterator = std::reverse_iterator<ConstIterator>;
+
+        ReverseConstIterator rbegin() const;
+
+        ReverseConstIterator rend() const;
+
+        // lazy view over the whole list, see SortedListView.h
+        IteratorView<ConstIterator> view() const;
+
+        // the list cut into consecutive views of segmentLength elements (the last one may be shorter).
+        // the result is random access, so it can be handed to parallel algorithms, see SortedListView.h
+        std::vector<IteratorView<ConstIterator>> segments(int segmentLength) const;
+
         // methods
 
+        // with one node per element no iterator is invalidated. in the unrolled layout every iterator into the
+        // list is invalidated - elements move within their block, or to a new one when a full block is split
         void insert(const T& newData);
 
+        // inserts every element of [first, last) - or none of them, if copying or comparing an element throws.
+        // invalidates iterators like insert(newData)
+        template <typename InputIterator>
+        void insert(InputIterator first, InputIterator last);
+
+        // with one node per element only iterators to the removed element are invalidated. in the unrolled
+        // layout every iterator into the list is invalidated - the elements after the removed one move back a
+        // position, so an iterator to the next element would now see the one after it
         void remove(const ConstIterator& givenIt);
 
+        // moves every element of other to the end (or the front) of this list in O(1). other's elements must all
+        // belong after this list's elements or all before them - otherwise std::invalid_argument is thrown
+        void splice(SortedList&& other);
+
+        // moves every element of other into this list in linear time, reusing other's nodes. equal elements of
+        // this list stay in front of other's. if comparing throws, both lists are left unchanged
+        void merge(SortedList&& other);
+
+        // detaches the elements from position to the end into a new list, without copying them
+        SortedList split(const ConstIterator& position);
+
+        // detaches the elements that satisfy predicate into a new list, both keep their order.
+        // predicate is called once for every element, in the list's order
+        template <typename Predicate>
+        SortedList split(Predicate predicate);
+
         int length() const;
 
+        // bytes of one list node (element included), for memory footprint reports
+        static std::size_t nodeSize();
+
         template <typename Function>
         SortedList filter(Function filterFunction) const;
 
@@ -60,8 +190,8 @@ namespace mtm {
          *
          * constructors and destructor:
          * 1. SortedList() - creates an empty list.
-         * 2. copy constructor
-         * 3. operator= - assignment operator
+         * 2. copy constructor (and a move constructor)
+         * 3. operator= - assignment operator (copy and move)
          * 4. ~SortedList() - destructor
          *
          * iterator:
@@ -75,40 +205,101 @@ namespace mtm {
          * 10. length - returns the number of elements in the list
          * 11. filter - returns a new list with elements that satisfy a given condition
          * 12. apply - returns a new list with elements that were modified by an operation
+         * 13. view - returns a lazy view of the list that can be filtered / transformed / taken without copying
+         * 14. rbegin / rend - reverse iteration, from the lowest element to the highest
+         * 15. segments - a random access index of sub-ranges, for chunked / parallel processing
+         * 16. splice / merge / split - move elements between lists without copying them
          */
 
     };
 
     template<typename T>
-    class SortedList<T>::Node {
+    class SortedList<T>::Node : public detail::SortedListPayload<T, SortedList<T>::UNROLLED> {
         friend SortedList;
 
-        T m_data;
+        using Payload = detail::SortedListPayload<T, SortedList<T>::UNROLLED>;
+
         Node* m_next;
         Node* m_prev;
 
-        // constructor
+        // constructors
         explicit Node(const T& data, Node* next = nullptr, Node* prev = nullptr);
 
+        // an empty block, unrolled layout only
+        Node(Node* next, Node* prev);
+
+        ~Node();
+
+        // every node goes through here, so an installed AllocationTracker sees all of them
+        static void* operator new(std::size_t size);
+        static void operator delete(void* memory, std::size_t size);
+
+    };
+
+    /**
+     * nodes built ahead of a change to a list (linked layout).
+     *
+     * everything that can throw - allocating, copying and comparing the elements - happens while the nodes are
+     * still in the batch, and a batch that is destroyed before it was handed over frees them. the list itself is
+     * only relinked afterwards, which cannot throw, so the change is all or nothing without building a copy of the
+     * whole list.
+     */
+    template <typename T>
+    class SortedList<T>::NodeBatch {
+        std::vector<Node*> m_nodes;
+
+    public:
+        explicit NodeBatch(std::size_t expectedSize = 0);
+        NodeBatch(const NodeBatch& other) = delete;
+        NodeBatch& operator=(const NodeBatch& other) = delete;
+        ~NodeBatch();
+
+        void add(const T& data);
+
+        // stable, from the greatest element to the lowest
+        void sort();
+
+        const std::vector<Node*>& nodes() const;
+
+        // links the nodes after the tail of list, in their current order. the batch is empty afterwards
+        void appendTo(SortedList& list);
+
+        // the nodes were linked somewhere else, the batch no longer owns them
+        void release();
     };
 
     template <class T>
     class SortedList<T>::ConstIterator {
         friend SortedList;
 
+        const SortedList* m_list; // needed to step back from end() to the tail
         Node* m_currentNode;
+        unsigned int m_index; // position inside the node, always 0 without the unrolled layout
 
         // private constructors
-        explicit ConstIterator(Node* node);
+        ConstIterator(const SortedList* list, Node* node, unsigned int index = 0);
 
     public:
 
+        // iterator traits
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        ConstIterator();
         ConstIterator(const ConstIterator& other) = default;
         ConstIterator& operator=(const ConstIterator& other) = default;
         ~ConstIterator() = default;
 
         const T& operator*() const; // unary operator
+        const T* operator->() const;
         ConstIterator& operator++();
+        ConstIterator operator++(int);
+        ConstIterator& operator--();
+        ConstIterator operator--(int);
+        bool operator==(const ConstIterator& other) const;
         bool operator!=(const ConstIterator& other) const;
 
     /**
@@ -125,6 +316,8 @@ namespace mtm {
      * 5. operator* - returns the element the iterator points to
      * 6. operator++ - advances the iterator to the next element
      * 7. operator!= - returns true if the iterator points to a different element
+     * 8. operator-- - moves the iterator to the previous element (end() moves to the last element)
+     * 9. operator== / operator-> and the standard iterator traits, so the iterator works with <algorithm>
      *
      */
     };
@@ -135,20 +328,24 @@ namespace mtm {
     SortedList<T>::SortedList() : m_head(nullptr), m_tail(nullptr), m_size(0) {}
 
     template<typename T>
-    SortedList<T>::SortedList(const SortedList &other) : m_head(nullptr), m_tail(nullptr), m_size(other.m_size) {
-        Node* prev = nullptr;
-        for (ConstIterator It = other.begin(); It != other.end(); ++It) {
-            Node* newNode = new Node(*It, nullptr, nullptr);
-            if (m_head == nullptr) {
-                m_head = newNode;
-            }
-            else {
-                prev->m_next = newNode;
-                prev->m_next->m_prev = prev;
+    SortedList<T>::SortedList(const SortedList &other) : m_head(nullptr), m_tail(nullptr), m_size(0) {
+        try {
+            for (ConstIterator It = other.begin(); It != other.end(); ++It) {
+                pushBack(*It);
             }
-            prev = newNode;
         }
-        m_tail = prev;
+        catch (...) {
+            clear(); // the destructor does not run for a half built object
+            throw;
+        }
+    }
+
+    template<typename T>
+    SortedList<T>::SortedList(SortedList&& other) noexcept :
+        m_head(other.m_head), m_tail(other.m_tail), m_size(other.m_size) {
+        other.m_head = nullptr;
+        other.m_tail = nullptr;
+        other.m_size = 0;
     }
 
     template<typename T>
@@ -162,31 +359,42 @@ namespace mtm {
             return *this;
         }
 
-        Node* newHead = nullptr;
-        Node* newTail = nullptr;
-        unsigned int newSize = other.m_size;
-
-        // TODO: make a helper for this
-        Node* prev = nullptr;
-        for (ConstIterator It = other.begin(); It != other.end(); ++It) {
-            Node* newNode = new Node(*It, nullptr, nullptr);
-            if (newHead == nullptr) {
-                newHead = newNode;
+        if constexpr (UNROLLED) {
+            assignBlocks(other);
+        }
+        else {
+            // existing nodes are reused when assigning an element cannot throw. every other element is copied into a
+            // batch first, and only then is the list touched - so a throwing copy leaves it as it was
+            const unsigned int reused = std::is_nothrow_copy_assignable<T>::value ? std::min(m_size, other.m_size) : 0;
+            ConstIterator source = other.begin();
+            std::advance(source, reused);
+            NodeBatch batch(other.m_size - reused);
+            for (; source != other.end(); ++source) {
+                batch.add(*source);
             }
-            else {
-                prev->m_next = newNode;
-                prev->m_next->m_prev = prev;
+
+            Node* last = nullptr;
+            Node* target = m_head;
+            source = other.begin();
+            for (unsigned int i = 0; i < reused; ++i, ++source) {
+                target->m_data = *source;
+                last = target;
+                target = target->m_next;
             }
-            prev = newNode;
+            truncateAfter(last);
+            m_size = reused;
+            batch.appendTo(*this);
         }
-        newTail = prev;
-        // helper ends here
 
-        clear();
+        return *this;
+    }
 
-        m_head = newHead;
-        m_tail = newTail;
-        m_size = newSize;
+    template <typename T>
+    SortedList<T>& SortedList<T>::operator=(SortedList&& other) noexcept {
+        if (this != &other) {
+            clear();
+            swapContents(other);
+        }
 
         return *this;
     }
@@ -195,21 +403,42 @@ namespace mtm {
 
     template<typename T>
     void SortedList<T>::insert(const T& newData) {
+        MTM_METRICS_ONLY(unsigned int comparisons = 0;)
         if (m_head == nullptr) {
             m_head = m_tail = new Node(newData, nullptr, nullptr);
         }
-        else if (newData > m_head->m_data) {
-            Node* newNode = new Node(newData, m_head, nullptr);
-            m_head->m_prev = newNode;
-            m_head = newNode;
+        else if (MTM_METRICS_ONLY(++comparisons,) newData > m_head->item(0)) {
+            if constexpr (UNROLLED) {
+                insertIntoBlock(m_head, 0, newData);
+            }
+            else {
+                Node* newNode = new Node(newData, m_head, nullptr);
+                m_head->m_prev = newNode;
+                m_head = newNode;
+            }
         }
-        else if (!(newData > m_tail->m_data)) {
-            Node* newNode = new Node(newData, nullptr, m_tail);
-            m_tail->m_next = newNode;
-            m_tail = newNode;
+        else if (MTM_METRICS_ONLY(++comparisons,) !(newData > m_tail->item(m_tail->count() - 1))) {
+            if constexpr (UNROLLED) {
+                insertIntoBlock(m_tail, m_tail->count(), newData);
+            }
+            else {
+                Node* newNode = new Node(newData, nullptr, m_tail);
+                m_tail->m_next = newNode;
+                m_tail = newNode;
+            }
+        }
+        else if constexpr (UNROLLED) {
+            // skip whole blocks by their last element, then search inside the first block that can take it
+            Node* cur = m_head;
+            while (MTM_METRICS_ONLY(++comparisons,) !(newData > cur->item(cur->count() - 1))) {
+                cur = cur->m_next;
+            }
+            MTM_METRICS_ONLY(comparisons += cur->count();)
+            insertIntoBlock(cur, blockInsertIndex(cur, newData), newData);
         }
         else {
             for (ConstIterator It = begin(); It != end(); ++It) {
+                MTM_METRICS_ONLY(comparisons += 2;)
                 if (!(newData > *It) && newData > It.m_currentNode->m_next->m_data) {
                     Node* newNode = new Node(newData, It.m_currentNode->m_next, It.m_currentNode);
                     It.m_currentNode->m_next = newNode;
@@ -220,35 +449,200 @@ namespace mtm {
         }
 
         m_size++;
+        MTM_METRICS_RECORD_INSERT(comparisons, m_size);
     }
 
     template<typename T>
-    void SortedList<T>::remove(const ConstIterator &givenIt) {
-        Node* victim = givenIt.m_currentNode;
-        if (victim == nullptr) {
+    template<typename InputIterator>
+    void SortedList<T>::insert(InputIterator first, InputIterator last) {
+        if constexpr (UNROLLED) {
+            // copying cannot throw here, comparing might: the merge goes into a new list that replaces this one
+            std::vector<T> added(first, last);
+            std::stable_sort(added.begin(), added.end(), [](const T& a, const T& b) { return a > b; });
+            mergeValues(added.begin(), added.end());
+        }
+        else {
+            NodeBatch batch;
+            for (; first != last; ++first) {
+                batch.add(*first);
+            }
+            batch.sort();
+            linkSortedNodes(batch.nodes());
+            batch.release();
+        }
+    }
+
+    template<typename T>
+    void SortedList<T>::splice(SortedList&& other) {
+        if (this == &other || other.m_head == nullptr) {
+            return;
+        }
+        if (m_head == nullptr) {
+            swapContents(other);
+        }
+        else if (!(*other.begin() > *rbegin())) {
+            m_tail->m_next = other.m_head;
+            other.m_head->m_prev = m_tail;
+            m_tail = other.m_tail;
+        }
+        else if (*other.rbegin() > *begin()) {
+            other.m_tail->m_next = m_head;
+            m_head->m_prev = other.m_tail;
+            m_head = other.m_head;
+        }
+        else {
+            throw std::invalid_argument("spliced list overlaps the list");
+        }
+        if (other.m_head != nullptr) {
+            m_size += other.m_size;
+            other.m_head = nullptr;
+            other.m_tail = nullptr;
+            other.m_size = 0;
+        }
+    }
+
+    template<typename T>
+    void SortedList<T>::merge(SortedList&& other) {
+        if (this == &other || other.m_head == nullptr) {
+            return;
+        }
+        // lists that do not interleave (or an empty one) are only linked together
+        if (m_head == nullptr || !(*other.begin() > *rbegin()) || *other.rbegin() > *begin()) {
+            splice(std::move(other));
             return;
         }
-        if (victim == m_head) {
-            m_head = victim->m_next;
+
+        if constexpr (UNROLLED) {
+            mergeValues(other.begin(), other.end());
+            other.clear();
         }
-        else if (victim == m_tail) {
-            m_tail = victim->m_prev;
+        else {
+            std::vector<Node*> nodes;
+            nodes.reserve(other.m_size);
+            for (Node* cur = other.m_head; cur != nullptr; cur = cur->m_next) {
+                nodes.push_back(cur);
+            }
+            linkSortedNodes(nodes);
+            other.m_head = nullptr;
+            other.m_tail = nullptr;
+            other.m_size = 0;
         }
-        Node* victimNext = givenIt.m_currentNode->m_next;
-        Node* victimPrev = givenIt.m_currentNode->m_prev;
+    }
 
-        if (victimNext && victimPrev) {
-            victimPrev->m_next = victimNext;
-            victimNext->m_prev = victimPrev;
+    template<typename T>
+    SortedList<T> SortedList<T>::split(const ConstIterator& position) {
+        if (position.m_list != this) {
+            throw std::invalid_argument("position is not in this list");
+        }
+        SortedList detached;
+        Node* first = position.m_currentNode;
+        if (first == nullptr) {
+            return detached;
+        }
+        if constexpr (UNROLLED) {
+            // a block cut in the middle gives its upper part to a new block, which starts the detached list
+            if (position.m_index > 0) {
+                Node* upper = new Node(first->m_next, first);
+                upper->m_count = first->m_count - position.m_index;
+                std::memcpy(upper->m_items, first->m_items + position.m_index, upper->m_count * sizeof(T));
+                first->m_count = position.m_index;
+                if (first->m_next != nullptr) {
+                    first->m_next->m_prev = upper;
+                }
+                else {
+                    m_tail = upper;
+                }
+                first->m_next = upper;
+                first = upper;
+            }
         }
 
-        else if (!(!victimNext && !victimPrev)) {
-            Node*& toLink = (victimNext) ? victimNext->m_prev : victimPrev->m_next;
-            toLink = nullptr;
+        unsigned int detachedSize = 0;
+        for (Node* cur = first; cur != nullptr; cur = cur->m_next) {
+            detachedSize += cur->count();
+        }
+        detached.m_head = first;
+        detached.m_tail = m_tail;
+        detached.m_size = detachedSize;
+        m_tail = first->m_prev;
+        if (m_tail != nullptr) {
+            m_tail->m_next = nullptr;
+        }
+        else {
+            m_head = nullptr;
+        }
+        first->m_prev = nullptr;
+        m_size -= detachedSize;
+
+        return detached;
+    }
+
+    template<typename T>
+    template<typename Predicate>
+    SortedList<T> SortedList<T>::split(Predicate predicate) {
+        SortedList detached;
+        if constexpr (UNROLLED) {
+            // both halves are rebuilt - the elements are trivially copyable, and a throwing predicate changes nothing
+            SortedList kept;
+            for (ConstIterator It = begin(); It != end(); ++It) {
+                if (predicate(*It)) {
+                    detached.pushBack(*It);
+                }
+                else {
+                    kept.pushBack(*It);
+                }
+            }
+            swapContents(kept);
+        }
+        else {
+            // the predicate runs on every element before any node moves
+            std::vector<bool> selected;
+            selected.reserve(m_size);
+            for (ConstIterator It = begin(); It != end(); ++It) {
+                selected.push_back(predicate(*It));
+            }
+
+            Node* cur = m_head;
+            for (bool isSelected : selected) {
+                Node* next = cur->m_next;
+                if (isSelected) {
+                    unlinkNode(cur);
+                    cur->m_prev = detached.m_tail;
+                    if (detached.m_tail == nullptr) {
+                        detached.m_head = cur;
+                    }
+                    else {
+                        detached.m_tail->m_next = cur;
+                    }
+                    detached.m_tail = cur;
+                    detached.m_size++;
+                    m_size--;
+                }
+                cur = next;
+            }
+        }
+
+        return detached;
+    }
+
+    template<typename T>
+    void SortedList<T>::remove(const ConstIterator &givenIt) {
+        Node* victim = givenIt.m_currentNode;
+        if (victim == nullptr) {
+            return;
+        }
+        if constexpr (UNROLLED) {
+            if (victim->m_count > 1) {
+                const unsigned int index = givenIt.m_index;
+                std::memmove(victim->m_items + index, victim->m_items + index + 1,
+                             (victim->m_count - index - 1) * sizeof(T));
+                victim->m_count--;
+                m_size--;
+                return;
+            }
         }
 
-        victim->m_next = nullptr;
-        victim->m_prev = nullptr;
+        unlinkNode(victim);
         delete victim;
         m_size--;
     }
@@ -258,13 +652,19 @@ namespace mtm {
         return m_size;
     }
 
+    template<typename T>
+    std::size_t SortedList<T>::nodeSize() {
+        return sizeof(Node);
+    }
+
     template<typename T>
     template<typename Function>
     SortedList<T> SortedList<T>::filter(Function filterFunction) const {
+        // the order is kept, so the elements are only appended
         SortedList newList;
         for (ConstIterator It = begin(); It != end(); ++It) {
             if (filterFunction(*It)) {
-                newList.insert(*It);
+                newList.pushBack(*It);
             }
         }
 
@@ -274,10 +674,29 @@ namespace mtm {
     template<typename T>
     template<typename Function>
     SortedList<T> SortedList<T>::apply(Function applyFunction) const {
+        // the results are sorted once (stable, like inserting them one by one) instead of searching a place for each
         SortedList newList;
-        for (ConstIterator It = begin(); It != end(); ++It) {
-            Node* curNode = It.m_currentNode;
-            newList.insert(applyFunction(curNode->m_data));
+        if constexpr (UNROLLED) {
+            std::vector<T> results;
+            results.reserve(m_size);
+            for (ConstIterator It = begin(); It != end(); ++It) {
+                results.push_back(applyFunction(*It));
+            }
+            auto greater = [](const T& a, const T& b) { return a > b; };
+            if (!std::is_sorted(results.begin(), results.end(), greater)) {
+                std::stable_sort(results.begin(), results.end(), greater);
+            }
+            for (const T& result : results) {
+                newList.pushBack(result);
+            }
+        }
+        else {
+            NodeBatch batch(m_size);
+            for (ConstIterator It = begin(); It != end(); ++It) {
+                batch.add(applyFunction(*It));
+            }
+            batch.sort();
+            batch.appendTo(newList);
         }
 
         return newList;
@@ -287,25 +706,116 @@ namespace mtm {
 
     template <typename T>
     typename SortedList<T>::ConstIterator SortedList<T>::begin() const {
-        return ConstIterator(m_head);
+        return ConstIterator(this, m_head);
     }
 
     template <typename T>
     typename SortedList<T>::ConstIterator SortedList<T>::end() const {
-        return ConstIterator(nullptr);
+        return ConstIterator(this, nullptr);
+    }
+
+    template <typename T>
+    typename SortedList<T>::ReverseConstIterator SortedList<T>::rbegin() const {
+        return ReverseConstIterator(end());
+    }
+
+    template <typename T>
+    typename SortedList<T>::ReverseConstIterator SortedList<T>::rend() const {
+        return ReverseConstIterator(begin());
     }
 
     // ---------------------------------- Node ---------------------------------- //
 
     template <typename T>
-    SortedList<T>::Node::Node(const T& data, Node* next, Node* prev) : m_data(data), m_next(next), m_prev(prev) {}
+    SortedList<T>::Node::Node(const T& data, Node* next, Node* prev) : Payload(data), m_next(next), m_prev(prev) {
+        MTM_METRICS_NODE_ALLOCATED();
+    }
+
+    template <typename T>
+    SortedList<T>::Node::Node(Node* next, Node* prev) : Payload(), m_next(next), m_prev(prev) {
+        MTM_METRICS_NODE_ALLOCATED();
+    }
+
+    template <typename T>
+    SortedList<T>::Node::~Node() {
+        MTM_METRICS_NODE_FREED();
+    }
+
+    template <typename T>
+    void* SortedList<T>::Node::operator new(std::size_t size) {
+        return allocateNode(size);
+    }
+
+    template <typename T>
+    void SortedList<T>::Node::operator delete(void* memory, std::size_t size) {
+        deallocateNode(memory, size);
+    }
+
+    // -------------------------------- NodeBatch -------------------------------- //
+
+    template <typename T>
+    SortedList<T>::NodeBatch::NodeBatch(std::size_t expectedSize) {
+        m_nodes.reserve(expectedSize);
+    }
+
+    template <typename T>
+    SortedList<T>::NodeBatch::~NodeBatch() {
+        for (Node* node : m_nodes) {
+            delete node;
+        }
+    }
+
+    template <typename T>
+    void SortedList<T>::NodeBatch::add(const T& data) {
+        // the slot first, so a node is never allocated without a place to free it from
+        m_nodes.push_back(nullptr);
+        m_nodes.back() = new Node(data, nullptr, nullptr);
+    }
+
+    template <typename T>
+    void SortedList<T>::NodeBatch::sort() {
+        auto greater = [](const Node* a, const Node* b) { return a->m_data > b->m_data; };
+        if (!std::is_sorted(m_nodes.begin(), m_nodes.end(), greater)) {
+            std::stable_sort(m_nodes.begin(), m_nodes.end(), greater);
+        }
+    }
+
+    template <typename T>
+    const std::vector<typename SortedList<T>::Node*>& SortedList<T>::NodeBatch::nodes() const {
+        return m_nodes;
+    }
+
+    template <typename T>
+    void SortedList<T>::NodeBatch::appendTo(SortedList& list) {
+        for (Node* node : m_nodes) {
+            node->m_prev = list.m_tail;
+            if (list.m_tail == nullptr) {
+                list.m_head = node;
+            }
+            else {
+                list.m_tail->m_next = node;
+            }
+            list.m_tail = node;
+        }
+        list.m_size += m_nodes.size();
+        m_nodes.clear();
+    }
+
+    template <typename T>
+    void SortedList<T>::NodeBatch::release() {
+        m_nodes.clear();
+    }
 
     // -------------------------------- Iterator -------------------------------- //
 
     // constructors
 
     template <typename T>
-    SortedList<T>::ConstIterator::ConstIterator(Node *node) : m_currentNode(node) {}
+    SortedList<T>::ConstIterator::ConstIterator() : m_list(nullptr), m_currentNode(nullptr), m_index(0) {}
+
+    template <typename T>
+    SortedList<T>::ConstIterator::ConstIterator(const SortedList* list, Node *node, unsigned int index) :
+        m_list(list), m_currentNode(node), m_index(index) {}
 
     // operators
 
@@ -314,7 +824,12 @@ namespace mtm {
         if (m_currentNode == nullptr) {
             throw std::out_of_range("out of range"); // incase we are out of range
         }
-        return m_currentNode->m_data; // return the data inside the node that the iterator is pointing to
+        return m_currentNode->item(m_index); // return the data inside the node that the iterator is pointing to
+    }
+
+    template <typename T>
+    const T* SortedList<T>::ConstIterator::operator->() const {
+        return &(**this);
     }
 
     template <typename T>
@@ -322,13 +837,56 @@ namespace mtm {
         if (m_currentNode == nullptr) {
             throw std::out_of_range("out of range");
         }
+        if constexpr (UNROLLED) {
+            if (++m_index < m_currentNode->m_count) {
+                return *this;
+            }
+            m_index = 0;
+        }
         m_currentNode = m_currentNode->m_next;
         return *this;
     }
 
+    template <typename T>
+    typename SortedList<T>::ConstIterator SortedList<T>::ConstIterator::operator++(int) {
+        ConstIterator old = *this;
+        ++*this;
+        return old;
+    }
+
+    template <typename T>
+    typename SortedList<T>::ConstIterator& SortedList<T>::ConstIterator::operator--() {
+        if constexpr (UNROLLED) {
+            if (m_currentNode != nullptr && m_index > 0) {
+                --m_index;
+                return *this;
+            }
+        }
+        // end() steps back to the tail, so rbegin() and std::prev(end()) reach the lowest element in O(1)
+        Node* previous = (m_currentNode == nullptr) ? (m_list ? m_list->m_tail : nullptr) : m_currentNode->m_prev;
+        if (previous == nullptr) {
+            throw std::out_of_range("out of range");
+        }
+        m_currentNode = previous;
+        m_index = previous->count() - 1;
+        return *this;
+    }
+
+    template <typename T>
+    typename SortedList<T>::ConstIterator SortedList<T>::ConstIterator::operator--(int) {
+        ConstIterator old = *this;
+        --*this;
+        return old;
+    }
+
+    template <typename T>
+    bool SortedList<T>::ConstIterator::operator==(const ConstIterator& other) const {
+        return m_currentNode == other.m_currentNode && m_index == other.m_index;
+    }
+
     template <typename T>
     bool SortedList<T>::ConstIterator::operator!=(const ConstIterator& other) const {
-        return m_currentNode != other.m_currentNode;
+        return !(*this == other);
     }
 
     // ---------------------------------- Helper ---------------------------------- //
@@ -348,9 +906,229 @@ namespace mtm {
 
         m_head = nullptr;
         m_tail = nullptr;
+        m_size = 0;
+    }
+
+    template<typename T>
+    void SortedList<T>::pushBack(const T& newData) {
+        if constexpr (UNROLLED) {
+            if (m_tail != nullptr && m_tail->m_count < Node::CAPACITY) {
+                m_tail->m_items[m_tail->m_count++] = newData;
+                m_size++;
+                return;
+            }
+        }
+
+        Node* newNode = new Node(newData, nullptr, m_tail);
+        if (m_tail == nullptr) {
+            m_head = newNode;
+        }
+        else {
+            m_tail->m_next = newNode;
+        }
+        m_tail = newNode;
+        m_size++;
+    }
+
+    template<typename T>
+    void SortedList<T>::unlinkNode(Node* node) {
+        if (node == m_head) {
+            m_head = node->m_next;
+        }
+        if (node == m_tail) {
+            m_tail = node->m_prev;
+        }
+        Node* nodeNext = node->m_next;
+        Node* nodePrev = node->m_prev;
+
+        if (nodeNext && nodePrev) {
+            nodePrev->m_next = nodeNext;
+            nodeNext->m_prev = nodePrev;
+        }
+
+        else if (!(!nodeNext && !nodePrev)) {
+            Node*& toLink = (nodeNext) ? nodeNext->m_prev : nodePrev->m_next;
+            toLink = nullptr;
+        }
+
+        node->m_next = nullptr;
+        node->m_prev = nullptr;
+    }
+
+    template<typename T>
+    void SortedList<T>::swapContents(SortedList& other) {
+        std::swap(m_head, other.m_head);
+        std::swap(m_tail, other.m_tail);
+        std::swap(m_size, other.m_size);
+    }
+
+    template<typename T>
+    void SortedList<T>::linkSortedNodes(const std::vector<Node*>& nodes) {
+        // the node every new node goes in front of (nullptr - after the tail), all found before relinking
+        std::vector<Node*> positions;
+        positions.reserve(nodes.size());
+        Node* cur = m_head;
+        for (Node* newNode : nodes) {
+            while (cur != nullptr && !(newNode->m_data > cur->m_data)) {
+                cur = cur->m_next;
+            }
+            positions.push_back(cur);
+        }
+
+        // nothing below throws
+        for (std::size_t i = 0; i < positions.size(); ++i) {
+            Node* newNode = nodes[i];
+            Node* before = positions[i];
+            newNode->m_next = before;
+            newNode->m_prev = (before != nullptr) ? before->m_prev : m_tail;
+            if (newNode->m_prev != nullptr) {
+                newNode->m_prev->m_next = newNode;
+            }
+            else {
+                m_head = newNode;
+            }
+            if (before != nullptr) {
+                before->m_prev = newNode;
+            }
+            else {
+                m_tail = newNode;
+            }
+        }
+        m_size += positions.size();
+    }
+
+    template<typename T>
+    template<typename Iterator>
+    void SortedList<T>::mergeValues(Iterator first, Iterator last) {
+        SortedList merged;
+        for (ConstIterator It = begin(); It != end(); ++It) {
+            for (; first != last && *first > *It; ++first) {
+                merged.pushBack(*first);
+            }
+            merged.pushBack(*It);
+        }
+        for (; first != last; ++first) {
+            merged.pushBack(*first);
+        }
+        swapContents(merged);
+    }
+
+    template<typename T>
+    void SortedList<T>::truncateAfter(Node* last) {
+        Node* cur = (last != nullptr) ? last->m_next : m_head;
+        while (cur) {
+            Node* toDelete = cur;
+            cur = cur->m_next;
+            delete toDelete;
+        }
+
+        if (last != nullptr) {
+            last->m_next = nullptr;
+        }
+        else {
+            m_head = nullptr;
+        }
+        m_tail = last;
+    }
+
+    template<typename T>
+    void SortedList<T>::assignBlocks(const SortedList& other) {
+        // only the blocks this list is missing are allocated, and before anything changes. copying trivially
+        // copyable elements cannot throw, so from there on the refill cannot fail halfway
+        const unsigned int neededBlocks = (other.m_size + Node::CAPACITY - 1) / Node::CAPACITY;
+        unsigned int ownBlocks = 0;
+        for (Node* cur = m_head; cur != nullptr; cur = cur->m_next) {
+            ++ownBlocks;
+        }
+        Node* extraHead = nullptr;
+        try {
+            for (unsigned int i = ownBlocks; i < neededBlocks; ++i) {
+                extraHead = new Node(extraHead, nullptr);
+            }
+        }
+        catch (...) {
+            while (extraHead) {
+                Node* toDelete = extraHead;
+                extraHead = extraHead->m_next;
+                delete toDelete;
+            }
+            throw;
+        }
+        while (extraHead) {
+            Node* block = extraHead;
+            extraHead = extraHead->m_next;
+            block->m_next = nullptr;
+            block->m_prev = m_tail;
+            if (m_tail == nullptr) {
+                m_head = block;
+            }
+            else {
+                m_tail->m_next = block;
+            }
+            m_tail = block;
+        }
+
+        Node* block = nullptr;
+        for (const Node* source = other.m_head; source != nullptr; source = source->m_next) {
+            for (unsigned int i = 0; i < source->m_count; ++i) {
+                if (block == nullptr || block->m_count == Node::CAPACITY) {
+                    block = (block == nullptr) ? m_head : block->m_next;
+                    block->m_count = 0;
+                }
+                block->m_items[block->m_count++] = source->m_items[i];
+            }
+        }
+        truncateAfter(block);
+        m_size = other.m_size;
     }
 
+    template<typename T>
+    void SortedList<T>::insertIntoBlock(Node* node, unsigned int index, const T& newData) {
+        // the front of a block may just as well be the back of the previous one, if that one has room
+        if (index == 0 && node->m_prev != nullptr && node->m_prev->m_count < Node::CAPACITY) {
+            node = node->m_prev;
+            index = node->m_count;
+        }
+
+        if (node->m_count == Node::CAPACITY) {
+            // split the full block in half, and continue in the half the position fell into
+            Node* upper = new Node(node->m_next, node);
+            const unsigned int half = Node::CAPACITY / 2;
+            upper->m_count = Node::CAPACITY - half;
+            std::memcpy(upper->m_items, node->m_items + half, upper->m_count * sizeof(T));
+            node->m_count = half;
+            if (node->m_next != nullptr) {
+                node->m_next->m_prev = upper;
+            }
+            else {
+                m_tail = upper;
+            }
+            node->m_next = upper;
+
+            if (index > half) {
+                node = upper;
+                index -= half;
+            }
+        }
+
+        std::memmove(node->m_items + index + 1, node->m_items + index, (node->m_count - index) * sizeof(T));
+        node->m_items[index] = newData;
+        node->m_count++;
+    }
 
+    template<typename T>
+    unsigned int SortedList<T>::blockInsertIndex(const Node* node, const T& newData) {
+        // equal elements keep their insertion order, so the new one goes after them
+        if constexpr (std::is_same<T, int>::value) {
+            return blocksearch::countNotLess(node->m_items, node->m_count, newData);
+        }
+        unsigned int index = 0;
+        while (index < node->m_count && !(newData > node->m_items[index])) {
+            ++index;
+        }
+        return index;
+    }
 
 }
 
+#include "SortedListView.h"
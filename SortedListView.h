@@ -0,0 +1,418 @@
+#pragma once
+
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "SortedList.h"
+
+namespace mtm {
+
+    /**
+     * Lazy, composable views over a SortedList.
+     *
+     * A view never owns or copies elements: it only remembers where to start, where to stop and which
+     * operations to run on each element, and does the work while it is being iterated. Views are chained
+     * with filter / transform / take, and a real SortedList is only built when materialize() is called:
+     *
+     *      SortedList<int> result = list.view().filter(isEven).transform(square).take(10).materialize();
+     *
+     * A view is only valid as long as the list it was created from is alive and unchanged, and an iterator
+     * of a view is only valid as long as the view itself is alive (it points at the view's function object).
+     */
+
+    template <typename Base, typename Predicate>
+    class FilterView;
+
+    template <typename Base, typename Function>
+    class TransformView;
+
+    template <typename Base>
+    class TakeView;
+
+    // -------------------------------- ViewBase -------------------------------- //
+
+    /**
+     * common combinators of every view. Derived must provide value_type, begin() and end().
+     */
+    template <typename Derived>
+    class ViewBase {
+        const Derived& derived() const;
+
+    public:
+
+        template <typename Predicate>
+        FilterView<Derived, Predicate> filter(Predicate predicate) const;
+
+        template <typename Function>
+        TransformView<Derived, Function> transform(Function function) const;
+
+        TakeView<Derived> take(int count) const;
+
+        // evaluates the view and builds a new sorted list out of its elements
+        auto materialize() const;
+
+        // evaluates the view and counts its elements, without building anything
+        int count() const;
+    };
+
+    // ------------------------------ IteratorView ------------------------------ //
+
+    /**
+     * the source of every chain - a plain [begin, end) range of another container.
+     */
+    template <typename Iterator>
+    class IteratorView : public ViewBase<IteratorView<Iterator>> {
+        Iterator m_begin;
+        Iterator m_end;
+
+    public:
+        using value_type = std::decay_t<decltype(*std::declval<const Iterator&>())>;
+        using iterator = Iterator;
+
+        IteratorView(const Iterator& begin, const Iterator& end);
+
+        Iterator begin() const;
+        Iterator end() const;
+    };
+
+    // ------------------------------- FilterView ------------------------------- //
+
+    template <typename Base, typename Predicate>
+    class FilterView : public ViewBase<FilterView<Base, Predicate>> {
+        Base m_base;
+        Predicate m_predicate;
+
+    public:
+        using value_type = typename Base::value_type;
+
+        class Iterator;
+        using iterator = Iterator;
+
+        FilterView(const Base& base, Predicate predicate);
+
+        Iterator begin() const;
+        Iterator end() const;
+    };
+
+    template <typename Base, typename Predicate>
+    class FilterView<Base, Predicate>::Iterator {
+        friend FilterView;
+
+        typename Base::iterator m_current;
+        typename Base::iterator m_end;
+        const Predicate* m_predicate;
+
+        Iterator(const typename Base::iterator& current, const typename Base::iterator& end,
+                 const Predicate* predicate);
+
+        // moves forward until an element satisfies the predicate (or the range ends)
+        void skipRejected();
+
+    public:
+        decltype(auto) operator*() const;
+        Iterator& operator++();
+        bool operator!=(const Iterator& other) const;
+    };
+
+    // ------------------------------ TransformView ----------------------------- //
+
+    template <typename Base, typename Function>
+    class TransformView : public ViewBase<TransformView<Base, Function>> {
+        Base m_base;
+        Function m_function;
+
+    public:
+        using value_type = std::decay_t<std::invoke_result_t<const Function&, const typename Base::value_type&>>;
+
+        class Iterator;
+        using iterator = Iterator;
+
+        TransformView(const Base& base, Function function);
+
+        Iterator begin() const;
+        Iterator end() const;
+    };
+
+    template <typename Base, typename Function>
+    class TransformView<Base, Function>::Iterator {
+        friend TransformView;
+
+        typename Base::iterator m_current;
+        const Function* m_function;
+
+        Iterator(const typename Base::iterator& current, const Function* function);
+
+    public:
+        value_type operator*() const;
+        Iterator& operator++();
+        bool operator!=(const Iterator& other) const;
+    };
+
+    // -------------------------------- TakeView -------------------------------- //
+
+    template <typename Base>
+    class TakeView : public ViewBase<TakeView<Base>> {
+        Base m_base;
+        int m_count;
+
+    public:
+        using value_type = typename Base::value_type;
+
+        class Iterator;
+        using iterator = Iterator;
+
+        TakeView(const Base& base, int count);
+
+        Iterator begin() const;
+        Iterator end() const;
+    };
+
+    template <typename Base>
+    class TakeView<Base>::Iterator {
+        friend TakeView;
+
+        typename Base::iterator m_current;
+        typename Base::iterator m_end;
+        int m_remaining;
+
+        Iterator(const typename Base::iterator& current, const typename Base::iterator& end, int remaining);
+
+        bool isDone() const;
+
+    public:
+        decltype(auto) operator*() const;
+        Iterator& operator++();
+        bool operator!=(const Iterator& other) const;
+    };
+
+    // ------------------------------- SortedList ------------------------------- //
+
+    template <typename T>
+    IteratorView<typename SortedList<T>::ConstIterator> SortedList<T>::view() const {
+        return IteratorView<ConstIterator>(begin(), end());
+    }
+
+    template <typename T>
+    std::vector<IteratorView<typename SortedList<T>::ConstIterator>> SortedList<T>::segments(int segmentLength) const {
+        if (segmentLength <= 0) {
+            throw std::invalid_argument("segment length must be positive");
+        }
+
+        // one sequential walk samples every segmentLength-th node, after that every segment stands on its own
+        std::vector<IteratorView<ConstIterator>> segmentList;
+        segmentList.reserve(m_size / segmentLength + 1);
+        ConstIterator segmentBegin = begin();
+        int counter = 0;
+        for (ConstIterator It = begin(); It != end(); ++It) {
+            if (counter == segmentLength) {
+                segmentList.emplace_back(segmentBegin, It);
+                segmentBegin = It;
+                counter = 0;
+            }
+            ++counter;
+        }
+        if (counter > 0) {
+            segmentList.emplace_back(segmentBegin, end());
+        }
+
+        return segmentList;
+    }
+
+    // -------------------------------- ViewBase -------------------------------- //
+
+    template <typename Derived>
+    const Derived& ViewBase<Derived>::derived() const {
+        return static_cast<const Derived&>(*this);
+    }
+
+    template <typename Derived>
+    template <typename Predicate>
+    FilterView<Derived, Predicate> ViewBase<Derived>::filter(Predicate predicate) const {
+        return FilterView<Derived, Predicate>(derived(), predicate);
+    }
+
+    template <typename Derived>
+    template <typename Function>
+    TransformView<Derived, Function> ViewBase<Derived>::transform(Function function) const {
+        return TransformView<Derived, Function>(derived(), function);
+    }
+
+    template <typename Derived>
+    TakeView<Derived> ViewBase<Derived>::take(int count) const {
+        return TakeView<Derived>(derived(), count);
+    }
+
+    template <typename Derived>
+    auto ViewBase<Derived>::materialize() const {
+        SortedList<typename Derived::value_type> newList;
+        for (auto It = derived().begin(); It != derived().end(); ++It) {
+            newList.insert(*It);
+        }
+
+        return newList;
+    }
+
+    template <typename Derived>
+    int ViewBase<Derived>::count() const {
+        int counter = 0;
+        for (auto It = derived().begin(); It != derived().end(); ++It) {
+            ++counter;
+        }
+
+        return counter;
+    }
+
+    // ------------------------------ IteratorView ------------------------------ //
+
+    template <typename Iterator>
+    IteratorView<Iterator>::IteratorView(const Iterator& begin, const Iterator& end) : m_begin(begin), m_end(end) {}
+
+    template <typename Iterator>
+    Iterator IteratorView<Iterator>::begin() const {
+        return m_begin;
+    }
+
+    template <typename Iterator>
+    Iterator IteratorView<Iterator>::end() const {
+        return m_end;
+    }
+
+    // ------------------------------- FilterView ------------------------------- //
+
+    template <typename Base, typename Predicate>
+    FilterView<Base, Predicate>::FilterView(const Base& base, Predicate predicate) :
+        m_base(base), m_predicate(predicate) {}
+
+    template <typename Base, typename Predicate>
+    typename FilterView<Base, Predicate>::Iterator FilterView<Base, Predicate>::begin() const {
+        return Iterator(m_base.begin(), m_base.end(), &m_predicate);
+    }
+
+    template <typename Base, typename Predicate>
+    typename FilterView<Base, Predicate>::Iterator FilterView<Base, Predicate>::end() const {
+        return Iterator(m_base.end(), m_base.end(), &m_predicate);
+    }
+
+    template <typename Base, typename Predicate>
+    FilterView<Base, Predicate>::Iterator::Iterator(const typename Base::iterator& current,
+                                                    const typename Base::iterator& end,
+                                                    const Predicate* predicate) :
+        m_current(current), m_end(end), m_predicate(predicate) {
+        skipRejected();
+    }
+
+    template <typename Base, typename Predicate>
+    void FilterView<Base, Predicate>::Iterator::skipRejected() {
+        while (m_current != m_end && !(*m_predicate)(*m_current)) {
+            ++m_current;
+        }
+    }
+
+    template <typename Base, typename Predicate>
+    decltype(auto) FilterView<Base, Predicate>::Iterator::operator*() const {
+        return *m_current;
+    }
+
+    template <typename Base, typename Predicate>
+    typename FilterView<Base, Predicate>::Iterator& FilterView<Base, Predicate>::Iterator::operator++() {
+        ++m_current;
+        skipRejected();
+        return *this;
+    }
+
+    template <typename Base, typename Predicate>
+    bool FilterView<Base, Predicate>::Iterator::operator!=(const Iterator& other) const {
+        return m_current != other.m_current;
+    }
+
+    // ------------------------------ TransformView ----------------------------- //
+
+    template <typename Base, typename Function>
+    TransformView<Base, Function>::TransformView(const Base& base, Function function) :
+        m_base(base), m_function(function) {}
+
+    template <typename Base, typename Function>
+    typename TransformView<Base, Function>::Iterator TransformView<Base, Function>::begin() const {
+        return Iterator(m_base.begin(), &m_function);
+    }
+
+    template <typename Base, typename Function>
+    typename TransformView<Base, Function>::Iterator TransformView<Base, Function>::end() const {
+        return Iterator(m_base.end(), &m_function);
+    }
+
+    template <typename Base, typename Function>
+    TransformView<Base, Function>::Iterator::Iterator(const typename Base::iterator& current,
+                                                      const Function* function) :
+        m_current(current), m_function(function) {}
+
+    template <typename Base, typename Function>
+    typename TransformView<Base, Function>::value_type TransformView<Base, Function>::Iterator::operator*() const {
+        return (*m_function)(*m_current);
+    }
+
+    template <typename Base, typename Function>
+    typename TransformView<Base, Function>::Iterator& TransformView<Base, Function>::Iterator::operator++() {
+        ++m_current;
+        return *this;
+    }
+
+    template <typename Base, typename Function>
+    bool TransformView<Base, Function>::Iterator::operator!=(const Iterator& other) const {
+        return m_current != other.m_current;
+    }
+
+    // -------------------------------- TakeView -------------------------------- //
+
+    template <typename Base>
+    TakeView<Base>::TakeView(const Base& base, int count) : m_base(base), m_count(count) {}
+
+    template <typename Base>
+    typename TakeView<Base>::Iterator TakeView<Base>::begin() const {
+        return Iterator(m_base.begin(), m_base.end(), m_count);
+    }
+
+    template <typename Base>
+    typename TakeView<Base>::Iterator TakeView<Base>::end() const {
+        return Iterator(m_base.end(), m_base.end(), 0);
+    }
+
+    template <typename Base>
+    TakeView<Base>::Iterator::Iterator(const typename Base::iterator& current, const typename Base::iterator& end,
+                                       int remaining) :
+        m_current(current), m_end(end), m_remaining(remaining) {}
+
+    template <typename Base>
+    bool TakeView<Base>::Iterator::isDone() const {
+        return m_remaining <= 0 || !(m_current != m_end);
+    }
+
+    template <typename Base>
+    decltype(auto) TakeView<Base>::Iterator::operator*() const {
+        return *m_current;
+    }
+
+    template <typename Base>
+    typename TakeView<Base>::Iterator& TakeView<Base>::Iterator::operator++() {
+        // at the limit, jump to the end instead of stepping - a filtered base would scan the rest of the list
+        if (--m_remaining <= 0) {
+            m_current = m_end;
+        }
+        else {
+            ++m_current;
+        }
+        return *this;
+    }
+
+    template <typename Base>
+    bool TakeView<Base>::Iterator::operator!=(const Iterator& other) const {
+        // every exhausted iterator is "end", no matter where it stopped
+        if (isDone() || other.isDone()) {
+            return isDone() != other.isDone();
+        }
+        return m_current != other.m_current;
+    }
+
+}
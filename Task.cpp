@@ -1,20 +1,12 @@
 
 #include "Task.h"
+#include "MemoryUsage.h"
 
 // Constructor
 Task::Task(int priority, TaskType type, const string &desc)
-    : m_description(desc), m_priority(priority), m_type(type)
+    : m_description(desc), m_type(type)
 {
-    // enforce priority range of 0-100
-    // 0 is lowest priority, 100 is highest
-    if (m_priority < 0)
-    {
-        m_priority = 0;
-    }
-    else if (m_priority > 100)
-    {
-        m_priority = 100;
-    }
+    setPriority(priority);
 }
 
 Task::Task(int priority, const string &desc)
@@ -37,10 +29,28 @@ string Task::getDescription() const {
     return m_description;
 }
 
+std::size_t Task::getDescriptionHeapBytes() const {
+    return MemoryUsage::stringHeapBytes(m_description);
+}
+
 int Task::getPriority() const {
     return m_priority;
 }
 
+void Task::setPriority(int newPriority) {
+    // enforce priority range of 0-100
+    // 0 is lowest priority, 100 is highest
+    m_priority = newPriority;
+    if (m_priority < MIN_PRIORITY)
+    {
+        m_priority = MIN_PRIORITY;
+    }
+    else if (m_priority > MAX_PRIORITY)
+    {
+        m_priority = MAX_PRIORITY;
+    }
+}
+
 
 // Overloaded operators
 ostream &operator<<(ostream& os, const Task& task) {
@@ -1,6 +1,7 @@
 
 #pragma once
 
+#include <cstddef>
 #include <iostream>
 #include <string>
 
@@ -23,6 +24,11 @@ enum class TaskType {
     General
 };
 
+/**
+ * @brief Number of values in the TaskType enum, for tables indexed by task type.
+ */
+const int NUM_TASK_TYPES = static_cast<int>(TaskType::General) + 1;
+
 /**
  * @brief Converts a TaskType enum to its corresponding string representation.
  *
@@ -35,6 +41,13 @@ string taskTypeToString(TaskType type);
  * @brief Class representing a task.
  */
 class Task {
+public:
+    /**
+     * @brief The range every task priority is clamped to.
+     */
+    static constexpr int MIN_PRIORITY = 0;
+    static constexpr int MAX_PRIORITY = 100;
+
 private:
     int m_id;
     string m_description;
@@ -80,6 +93,13 @@ public:
      */
     string getDescription() const;
 
+    /**
+     * @brief Gets the heap memory owned by the description of the task.
+     *
+     * @return std::size_t The size of the description's heap buffer (0 for short descriptions).
+     */
+    std::size_t getDescriptionHeapBytes() const;
+
     /**
      * @brief Gets the priority of the task.
      *
@@ -87,6 +107,13 @@ public:
      */
     int getPriority() const;
 
+    /**
+     * @brief Sets the priority of the task.
+     *
+     * @param newPriority The new priority, enforced to be in range [0, 100].
+     */
+    void setPriority(int newPriority);
+
     /**
      * @brief Gets the type of the task.
      *
@@ -0,0 +1,252 @@
+#include "TaskBucketQueue.h"
+
+#include <iterator>
+#include <stdexcept>
+
+// --------------------------------- helpers -------------------------------- //
+
+int TaskBucketQueue::bucketOf(const Task& task) {
+    return task.getPriority() - Task::MIN_PRIORITY;
+}
+
+void TaskBucketQueue::mergeById(Bucket& into, Bucket& from) {
+    if (from.empty()) {
+        return;
+    }
+    // the usual case - every moved task is newer than the ones already there
+    if (into.empty() || into.back().getId() < from.front().getId()) {
+        into.splice(into.end(), from);
+        return;
+    }
+    into.merge(from, [](const Task& a, const Task& b) { return a.getId() < b.getId(); });
+}
+
+void TaskBucketQueue::updateNonEmpty(int bucket) {
+    const std::uint64_t bit = std::uint64_t(1) << (bucket % BITS_PER_WORD);
+    if (m_buckets[bucket].empty()) {
+        m_nonEmpty[bucket / BITS_PER_WORD] &= ~bit;
+    }
+    else {
+        m_nonEmpty[bucket / BITS_PER_WORD] |= bit;
+    }
+}
+
+int TaskBucketQueue::highestBucketBelow(int bucket) const {
+    if (bucket <= 0) {
+        return -1;
+    }
+    int word = (bucket - 1) / BITS_PER_WORD;
+    const int bitsInWord = (bucket - 1) % BITS_PER_WORD + 1;
+    std::uint64_t bits = m_nonEmpty[word];
+    if (bitsInWord < BITS_PER_WORD) {
+        bits &= (std::uint64_t(1) << bitsInWord) - 1;
+    }
+    while (bits == 0) {
+        if (--word < 0) {
+            return -1;
+        }
+        bits = m_nonEmpty[word];
+    }
+    return word * BITS_PER_WORD + (BITS_PER_WORD - 1 - __builtin_clzll(bits));
+}
+
+int TaskBucketQueue::lowestBucket() const {
+    for (int word = 0; word < NUM_WORDS; ++word) {
+        if (m_nonEmpty[word] != 0) {
+            return word * BITS_PER_WORD + __builtin_ctzll(m_nonEmpty[word]);
+        }
+    }
+    return -1;
+}
+
+// ---------------------------------- queue --------------------------------- //
+
+TaskBucketQueue::ConstIterator TaskBucketQueue::begin() const {
+    return ConstIterator(this, highestBucketBelow(NUM_BUCKETS));
+}
+
+TaskBucketQueue::ConstIterator TaskBucketQueue::end() const {
+    return ConstIterator(this, -1);
+}
+
+int TaskBucketQueue::length() const {
+    return m_size;
+}
+
+void TaskBucketQueue::insert(const Task& task) {
+    const int bucket = bucketOf(task);
+    Bucket& tasks = m_buckets[bucket];
+    auto position = tasks.end();
+    while (position != tasks.begin() && std::prev(position)->getId() > task.getId()) {
+        --position;
+    }
+    tasks.insert(position, task);
+    m_size++;
+    updateNonEmpty(bucket);
+}
+
+const Task& TaskBucketQueue::highest() const {
+    const int bucket = highestBucketBelow(NUM_BUCKETS);
+    if (bucket < 0) {
+        throw std::out_of_range("The task queue is empty");
+    }
+    return m_buckets[bucket].front();
+}
+
+const Task& TaskBucketQueue::lowest() const {
+    const int bucket = lowestBucket();
+    if (bucket < 0) {
+        throw std::out_of_range("The task queue is empty");
+    }
+    return m_buckets[bucket].back();
+}
+
+Task TaskBucketQueue::popHighest() {
+    const int bucket = highestBucketBelow(NUM_BUCKETS);
+    if (bucket < 0) {
+        throw std::out_of_range("The task queue is empty");
+    }
+    Task task = std::move(m_buckets[bucket].front());
+    m_buckets[bucket].pop_front();
+    m_size--;
+    updateNonEmpty(bucket);
+    return task;
+}
+
+Task TaskBucketQueue::popLowest() {
+    const int bucket = lowestBucket();
+    if (bucket < 0) {
+        throw std::out_of_range("The task queue is empty");
+    }
+    Task task = std::move(m_buckets[bucket].back());
+    m_buckets[bucket].pop_back();
+    m_size--;
+    updateNonEmpty(bucket);
+    return task;
+}
+
+std::vector<Task> TaskBucketQueue::extractIf(const std::function<bool(const Task&)>& predicate) {
+    std::vector<Task> extracted;
+    for (int bucket = highestBucketBelow(NUM_BUCKETS); bucket >= 0; bucket = highestBucketBelow(bucket)) {
+        Bucket& tasks = m_buckets[bucket];
+        for (auto It = tasks.begin(); It != tasks.end();) {
+            if (predicate(*It)) {
+                extracted.push_back(std::move(*It));
+                It = tasks.erase(It);
+                m_size--;
+            }
+            else {
+                ++It;
+            }
+        }
+        updateNonEmpty(bucket);
+    }
+    return extracted;
+}
+
+void TaskBucketQueue::forEachFromLowest(const std::function<bool(const Task&)>& visit) const {
+    for (int bucket = lowestBucket(); bucket >= 0 && bucket < NUM_BUCKETS; ++bucket) {
+        for (auto It = m_buckets[bucket].rbegin(); It != m_buckets[bucket].rend(); ++It) {
+            if (!visit(*It)) {
+                return;
+            }
+        }
+    }
+}
+
+std::array<int, TaskBucketQueue::NUM_BUCKETS> TaskBucketQueue::bumpPriorityByType(TaskTypeSet types,
+                                                                                  int priority) {
+    std::array<int, NUM_BUCKETS> movedFrom = {};
+    if (priority != 0) {
+        bumpPriorities([types, priority, &movedFrom](const Task& task) {
+            if (!types.contains(task.getType())) {
+                return 0;
+            }
+            movedFrom[bucketOf(task)]++;
+            return priority;
+        });
+    }
+    return movedFrom;
+}
+
+void TaskBucketQueue::bumpPriorities(const std::function<int(const Task&)>& amountOf) {
+    // every bumped task leaves its bucket first, so none is moved twice whichever way the priorities go
+    std::array<Bucket, NUM_BUCKETS> moved;
+    std::array<bool, NUM_BUCKETS> outOfOrder = {};
+    for (int bucket = highestBucketBelow(NUM_BUCKETS); bucket >= 0; bucket = highestBucketBelow(bucket)) {
+        Bucket& tasks = m_buckets[bucket];
+        for (auto It = tasks.begin(); It != tasks.end();) {
+            auto next = std::next(It);
+            const int amount = amountOf(*It);
+            if (amount != 0) {
+                It->setPriority(It->getPriority() + amount);
+                Bucket& newTasks = moved[bucketOf(*It)];
+                outOfOrder[bucketOf(*It)] |= !newTasks.empty() && newTasks.back().getId() > It->getId();
+                newTasks.splice(newTasks.end(), tasks, It);
+            }
+            It = next;
+        }
+    }
+
+    for (int bucket = 0; bucket < NUM_BUCKETS; ++bucket) {
+        if (outOfOrder[bucket]) {
+            // tasks from several old buckets, each run by id - a stable merge sort of the nodes, no copies
+            moved[bucket].sort([](const Task& a, const Task& b) { return a.getId() < b.getId(); });
+        }
+        mergeById(m_buckets[bucket], moved[bucket]);
+        updateNonEmpty(bucket);
+    }
+}
+
+void TaskBucketQueue::merge(TaskBucketQueue&& other) {
+    if (this == &other) {
+        return;
+    }
+    for (int bucket = 0; bucket < NUM_BUCKETS; ++bucket) {
+        mergeById(m_buckets[bucket], other.m_buckets[bucket]);
+        updateNonEmpty(bucket);
+    }
+    m_size += other.m_size;
+    other.m_size = 0;
+    other.m_nonEmpty = {};
+}
+
+std::size_t TaskBucketQueue::nodeSize() {
+    // a std::list node - the task and two links
+    return sizeof(Task) + 2 * sizeof(void*);
+}
+
+// ------------------------------ ConstIterator ----------------------------- //
+
+TaskBucketQueue::ConstIterator::ConstIterator(const TaskBucketQueue* queue, int bucket) :
+    m_queue(queue), m_bucket(bucket) {
+    if (m_bucket >= 0) {
+        m_current = m_queue->m_buckets[m_bucket].begin();
+    }
+}
+
+const Task& TaskBucketQueue::ConstIterator::operator*() const {
+    return *m_current;
+}
+
+const Task* TaskBucketQueue::ConstIterator::operator->() const {
+    return &*m_current;
+}
+
+TaskBucketQueue::ConstIterator& TaskBucketQueue::ConstIterator::operator++() {
+    if (++m_current == m_queue->m_buckets[m_bucket].end()) {
+        m_bucket = m_queue->highestBucketBelow(m_bucket);
+        if (m_bucket >= 0) {
+            m_current = m_queue->m_buckets[m_bucket].begin();
+        }
+    }
+    return *this;
+}
+
+bool TaskBucketQueue::ConstIterator::operator!=(const ConstIterator& other) const {
+    return !(*this == other);
+}
+
+bool TaskBucketQueue::ConstIterator::operator==(const ConstIterator& other) const {
+    return m_bucket == other.m_bucket && (m_bucket < 0 || m_current == other.m_current);
+}
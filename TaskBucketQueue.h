@@ -0,0 +1,179 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <vector>
+
+#include "Task.h"
+#include "TaskTypeSet.h"
+
+/**
+ * @brief A task store that uses the bounded priority range instead of comparisons.
+ *
+ * Every possible priority has its own bucket, a FIFO of tasks ordered by id, and a bitmap tells which buckets
+ * are non-empty. Inserting a task is O(1) (tasks usually arrive with increasing ids), the highest and lowest
+ * tasks are found with one find-first-set over the bitmap, and bumping a task type moves nodes from bucket to
+ * bucket with splices. Iterating gives the tasks in the exact order of operator> - priority from the highest,
+ * and the lowest id first among equal priorities - the same order a SortedList<Task> keeps.
+ */
+class TaskBucketQueue {
+public:
+    /**
+     * @brief Number of buckets, one per possible priority.
+     */
+    static constexpr int NUM_BUCKETS = Task::MAX_PRIORITY - Task::MIN_PRIORITY + 1;
+
+private:
+    static constexpr int BITS_PER_WORD = 64;
+    static constexpr int NUM_WORDS = (NUM_BUCKETS + BITS_PER_WORD - 1) / BITS_PER_WORD;
+
+    using Bucket = std::list<Task>;
+
+    std::array<Bucket, NUM_BUCKETS> m_buckets;
+    std::array<std::uint64_t, NUM_WORDS> m_nonEmpty = {}; // bit i is set iff m_buckets[i] has tasks
+    int m_size = 0;
+
+    static int bucketOf(const Task& task);
+    // moves every task of from into into, both ordered by id
+    static void mergeById(Bucket& into, Bucket& from);
+
+    void updateNonEmpty(int bucket);
+    // the highest non-empty bucket below bucket, or -1
+    int highestBucketBelow(int bucket) const;
+    // the lowest non-empty bucket, or -1
+    int lowestBucket() const;
+
+public:
+    class ConstIterator;
+
+    /**
+     * @brief Gets an iterator to the highest priority task.
+     *
+     * @return ConstIterator The first task in operator> order.
+     */
+    ConstIterator begin() const;
+
+    /**
+     * @brief Gets the past-the-end iterator.
+     *
+     * @return ConstIterator The end of the tasks.
+     */
+    ConstIterator end() const;
+
+    /**
+     * @brief Gets the number of tasks in the queue.
+     *
+     * @return int The number of tasks.
+     */
+    int length() const;
+
+    /**
+     * @brief Inserts a task, in O(1) when its id is the highest of its priority.
+     *
+     * @param task The task to be inserted.
+     */
+    void insert(const Task& task);
+
+    /**
+     * @brief Gets the highest priority task, in O(1).
+     *
+     * @return const Task& The highest priority task.
+     * @throws std::out_of_range If the queue is empty.
+     */
+    const Task& highest() const;
+
+    /**
+     * @brief Gets the lowest priority task, in O(1).
+     *
+     * @return const Task& The lowest priority task.
+     * @throws std::out_of_range If the queue is empty.
+     */
+    const Task& lowest() const;
+
+    /**
+     * @brief Removes the highest priority task, in O(1).
+     *
+     * @return Task The removed task.
+     * @throws std::out_of_range If the queue is empty.
+     */
+    Task popHighest();
+
+    /**
+     * @brief Removes the lowest priority task, in O(1).
+     *
+     * @return Task The removed task.
+     * @throws std::out_of_range If the queue is empty.
+     */
+    Task popLowest();
+
+    /**
+     * @brief Removes the tasks that satisfy a predicate.
+     *
+     * @param predicate Called once for every task, from the highest priority to the lowest.
+     * @return std::vector<Task> The removed tasks, from the highest priority to the lowest.
+     */
+    std::vector<Task> extractIf(const std::function<bool(const Task&)>& predicate);
+
+    /**
+     * @brief Calls a function with the tasks from the lowest priority up - the reverse of the iterators' order.
+     *
+     * @param visit Called with every task until it returns false.
+     */
+    void forEachFromLowest(const std::function<bool(const Task&)>& visit) const;
+
+    /**
+     * @brief Adds an amount to the priority of every task of some types, by splicing them into their new buckets.
+     *
+     * O(number of tasks) to find the tasks of the types, no task is copied.
+     *
+     * @param types The types of tasks whose priority changes.
+     * @param priority The amount added - the new priorities are clamped to [0, 100] like any priority.
+     * @return std::array<int, NUM_BUCKETS> How many tasks left every bucket, indexed by their old priority.
+     */
+    std::array<int, NUM_BUCKETS> bumpPriorityByType(TaskTypeSet types, int priority);
+
+    /**
+     * @brief Adds an amount of its own to the priority of every task, in one pass over the buckets.
+     *
+     * @param amountOf Called once for every task, from the highest priority to the lowest, and returns the
+     *                 amount to add to its priority (0 leaves the task where it is).
+     */
+    void bumpPriorities(const std::function<int(const Task&)>& amountOf);
+
+    /**
+     * @brief Moves every task of another queue into this one, bucket by bucket, without copying them.
+     *
+     * @param other The queue whose tasks are moved - left empty.
+     */
+    void merge(TaskBucketQueue&& other);
+
+    /**
+     * @brief Gets the bytes of one bucket node (task included), for memory footprint reports.
+     *
+     * @return std::size_t The size of one node.
+     */
+    static std::size_t nodeSize();
+};
+
+/**
+ * @brief Walks the tasks from the highest priority to the lowest, skipping empty buckets with the bitmap.
+ */
+class TaskBucketQueue::ConstIterator {
+    friend TaskBucketQueue;
+
+    const TaskBucketQueue* m_queue;
+    int m_bucket; // -1 at the end
+    Bucket::const_iterator m_current;
+
+    ConstIterator(const TaskBucketQueue* queue, int bucket);
+
+public:
+    const Task& operator*() const;
+    const Task* operator->() const;
+    ConstIterator& operator++();
+    bool operator!=(const ConstIterator& other) const;
+    bool operator==(const ConstIterator& other) const;
+};
@@ -1,99 +1,785 @@
 
 #include "TaskManager.h"
+#include "Metrics.h"
 
-TaskManager::TaskManager() = default;
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <queue>
+
+namespace {
+    long long taskLoad(const Task &task, RebalanceMeasure measure) {
+        return measure == RebalanceMeasure::TaskCount ? 1 : task.getPriority();
+    }
+
+    long long personLoad(const Person &person, RebalanceMeasure measure, const TaskType *type) {
+        const TaskStats &personStats = person.stats();
+        if (measure == RebalanceMeasure::TaskCount) {
+            return type ? personStats.getCountByType(*type) : personStats.getTotalCount();
+        }
+        long long load = 0;
+        if (type == nullptr) {
+            for (int priority = Task::MIN_PRIORITY; priority <= Task::MAX_PRIORITY; ++priority) {
+                load += static_cast<long long>(priority) * personStats.getCountByPriority(priority);
+            }
+            return load;
+        }
+        person.forEachTask([type, &load](const Task &curTask) {
+            if (curTask.getType() == *type) {
+                load += curTask.getPriority();
+            }
+            return true;
+        });
+        return load;
+    }
+
+    // how many of the lowest tasks (of type, if given) add up to at most budget - or, with overshoot, the fewest
+    // that reach it - and their load. walkFromLowest calls its visitor with the tasks from the lowest up, until
+    // the visitor returns false
+    template <class WalkFromLowest>
+    int countLowestTasks(WalkFromLowest walkFromLowest, long long budget, bool overshoot, RebalanceMeasure measure,
+                         const TaskType *type, long long &load) {
+        int numOfTasks = 0;
+        load = 0;
+        walkFromLowest([&](const Task &curTask) {
+            if (load >= budget) {
+                return false;
+            }
+            if (type != nullptr && curTask.getType() != *type) {
+                return true;
+            }
+            if (!overshoot && load + taskLoad(curTask, measure) > budget) {
+                return false; // the tasks only get heavier from here
+            }
+            load += taskLoad(curTask, measure);
+            ++numOfTasks;
+            return true;
+        });
+        return numOfTasks;
+    }
+
+    // fills a person's list in the shared store anew
+    void copyTasksToSharedStore(SharedTaskStore &store, int personIndex, const Person &person) {
+        store.clearTasks(personIndex);
+        person.forEachTask([&store, personIndex](const Task &curTask) {
+            store.appendTask(personIndex, curTask);
+            return true;
+        });
+    }
+
+    SortedList<Task> detachLowest(Person &person, int numOfTasks, const TaskType *type) {
+        if (type == nullptr) {
+            return person.detachLowestTasks(numOfTasks);
+        }
+        // the predicate sees the tasks from the highest to the lowest, the last numOfTasks of the type are taken
+        const int skipped = person.stats().getCountByType(*type) - numOfTasks;
+        int seen = 0;
+        return person.detachTasks([type, skipped, &seen](const Task &curTask) {
+            return curTask.getType() == *type && seen++ >= skipped;
+        });
+    }
+}
+
+TaskManager::TaskManager() : TaskManager(MAX_PERSONS) {}
+
+TaskManager::TaskManager(int maxPersons, TaskStorage taskStorage) : m_taskStorage(taskStorage) {
+    if (maxPersons <= 0) {
+        throw std::invalid_argument("A TaskManager needs room for at least one person");
+    }
+    m_personArray = std::vector<Person>(maxPersons);
+}
 
 void TaskManager::assignTask(const string &personName, const Task &task) {
-    Task newTask = task;
-    newTask.setId(m_newestTaskId++);
+    MTM_METRICS_TIME_OPERATION(AssignTask);
+    EvictedTasks evicted;
+    {
+        std::lock_guard<std::mutex> lock(m_versionMutex);
+        SharedTaskStore::WriteSection shared(m_sharedStore.get(), m_version);
+        Task newTask = task;
+        newTask.setId(m_newestTaskId++);
+
+        Person* curPerson = findPerson(personName);
+        if (curPerson == nullptr) {
+            curPerson = addPerson(personName);
+        }
+        curPerson->assignTask(newTask, collectEvictions(personName, evicted));
+        if (m_sharedStore) {
+            m_sharedStore->insertTask(indexOf(curPerson), newTask);
+        }
+        m_stats.add(newTask);
+        m_countsByTypeAndPriority[static_cast<int>(newTask.getType())]
+                                 [newTask.getPriority() - Task::MIN_PRIORITY]++;
+        if (m_descriptionIndex) {
+            m_descriptionIndex->add(newTask);
+        }
+        m_version++;
+        if (m_changeFeed.hasSubscribers()) {
+            publishChange(ChangeType::TaskAssigned, personName, newTask.getId(), newTask.getPriority(),
+                          newTask.getType());
+        }
+        forgetEvictedTasks(evicted);
+    }
+    m_changeFeed.deliver();
+    reportEvictions(evicted);
+}
+
+int TaskManager::assignTasks(const string &personName, const std::vector<Task> &tasks) {
+    MTM_METRICS_TIME_OPERATION(AssignTask);
+    EvictedTasks evicted;
+    int firstId;
+    {
+        std::lock_guard<std::mutex> lock(m_versionMutex);
+        firstId = m_newestTaskId;
+        if (tasks.empty()) {
+            return firstId;
+        }
+        SharedTaskStore::WriteSection shared(m_sharedStore.get(), m_version);
+        Person* curPerson = findPerson(personName);
+        if (curPerson == nullptr) {
+            curPerson = addPerson(personName);
+        }
+
+        std::vector<Task> newTasks = tasks;
+        for (Task& newTask : newTasks) {
+            newTask.setId(m_newestTaskId++);
+            m_stats.add(newTask);
+            m_countsByTypeAndPriority[static_cast<int>(newTask.getType())]
+                                     [newTask.getPriority() - Task::MIN_PRIORITY]++;
+            if (m_descriptionIndex) {
+                m_descriptionIndex->add(newTask);
+            }
+        }
+        curPerson->assignTasks(newTasks, collectEvictions(personName, evicted));
+        if (m_sharedStore) {
+            for (const Task& newTask : newTasks) {
+                m_sharedStore->insertTask(indexOf(curPerson), newTask);
+            }
+        }
+        m_version++;
+        if (m_changeFeed.hasSubscribers()) {
+            for (const Task& newTask : newTasks) {
+                publishChange(ChangeType::TaskAssigned, personName, newTask.getId(), newTask.getPriority(),
+                              newTask.getType());
+            }
+        }
+        forgetEvictedTasks(evicted);
+    }
+    m_changeFeed.deliver();
+    reportEvictions(evicted);
+    return firstId;
+}
 
-    Person* curPerson = findPerson(personName);
-    if (curPerson == nullptr) {
-        curPerson = addPerson(personName);
+void TaskManager::setPersonCapacity(const string &personName, int capacity) {
+    if (capacity < 0) {
+        throw std::invalid_argument("A person's capacity cannot be negative");
+    }
+    EvictedTasks evicted;
+    {
+        std::lock_guard<std::mutex> lock(m_versionMutex);
+        SharedTaskStore::WriteSection shared(m_sharedStore.get(), m_version);
+        Person* curPerson = findPerson(personName);
+        if (curPerson == nullptr) {
+            curPerson = addPerson(personName);
+        }
+        curPerson->setCapacity(capacity, collectEvictions(personName, evicted));
+        if (!evicted.empty()) {
+            m_version++;
+            forgetEvictedTasks(evicted);
+        }
     }
-    curPerson->assignTask(newTask);
+    m_changeFeed.deliver();
+    reportEvictions(evicted);
+}
+
+void TaskManager::setEvictionCallback(std::function<void(const string &personName, const Task &task)> onEvicted) {
+    std::lock_guard<std::mutex> lock(m_versionMutex);
+    m_onEvicted = std::move(onEvicted);
 }
 
-void TaskManager::completeTask(const string &personName) {
-    if (Person* curPerson = findPerson(personName)) {
-        curPerson->completeTask();
+int TaskManager::completeTask(const string &personName) {
+    MTM_METRICS_TIME_OPERATION(CompleteTask);
+    int completedId = -1;
+    {
+        std::lock_guard<std::mutex> lock(m_versionMutex);
+        Person* curPerson = findPerson(personName);
+        if (curPerson == nullptr) {
+            return completedId;
+        }
+        SharedTaskStore::WriteSection shared(m_sharedStore.get(), m_version);
+        if (curPerson->stats().getTotalCount() > 0) {
+            const Task& completedTask = curPerson->getHighestPriorityTask();
+            m_stats.remove(completedTask);
+            m_countsByTypeAndPriority[static_cast<int>(completedTask.getType())]
+                                     [completedTask.getPriority() - Task::MIN_PRIORITY]--;
+            if (m_descriptionIndex) {
+                m_descriptionIndex->remove(completedTask.getId());
+            }
+            if (m_changeFeed.hasSubscribers()) {
+                publishChange(ChangeType::TaskCompleted, personName, completedTask.getId(),
+                              completedTask.getPriority(), completedTask.getType());
+            }
+        }
+        completedId = curPerson->completeTask();
+        if (m_sharedStore) {
+            m_sharedStore->removeTask(completedId);
+        }
+        m_version++;
     }
+    m_changeFeed.deliver();
+    return completedId;
 }
 
 void TaskManager::bumpPriorityByType(TaskType type, int priority) {
-    if (priority > 0) {
+    bumpPriorityByType(TaskTypeSet(type), priority);
+}
+
+void TaskManager::bumpPriorityByType(TaskTypeSet types, int priority) {
+    MTM_METRICS_TIME_OPERATION(BumpPriorityByType);
+    if (priority <= 0 || types.empty()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_versionMutex);
+        SharedTaskStore::WriteSection shared(m_sharedStore.get(), m_version);
         for (unsigned int i = 0; i < m_numOfPersons; ++i) {
-            Person& curPerson = m_personArray[i];
-            const SortedList<Task>& curTaskList = curPerson.getTasks();
-            SortedList<Task> newTaskList = curTaskList.apply([&type, &priority](const Task& curTask) -> Task {
-                if (curTask.getType() == type) {
-                    const int newPriority = curTask.getPriority() + priority;
-                    Task newTask(newPriority, curTask.getType(), curTask.getDescription());
-                    newTask.setId(curTask.getId());
-                    return newTask;
+            m_personArray[i].bumpPriorityByType(types, priority);
+        }
+        if (m_sharedStore) {
+            m_sharedStore->bumpPriorityByType(types, priority);
+        }
+        if (m_descriptionIndex) {
+            m_descriptionIndex->bumpPriorityByType(types, priority, m_newestTaskId);
+        }
+        for (int type = 0; type < NUM_TASK_TYPES; ++type) {
+            if (types.contains(static_cast<TaskType>(type))) {
+                m_stats.changePriorities(m_countsByTypeAndPriority[type], priority);
+            }
+        }
+        m_version++;
+        if (m_changeFeed.hasSubscribers()) {
+            // one event per type, so subscribers see the same events as for separate bumps
+            for (int type = 0; type < NUM_TASK_TYPES; ++type) {
+                if (types.contains(static_cast<TaskType>(type))) {
+                    publishChange(ChangeType::PriorityBumped, "", -1, priority, static_cast<TaskType>(type));
                 }
-                return curTask;
-            });
-            curPerson.setTasks(newTaskList);
+            }
+        }
+    }
+    m_changeFeed.deliver();
+}
+
+void TaskManager::reassignAllTasks(const string &fromPersonName, const string &toPersonName) {
+    EvictedTasks evicted;
+    {
+        std::lock_guard<std::mutex> lock(m_versionMutex);
+        Person* fromPerson = findPerson(fromPersonName);
+        if (fromPerson == nullptr || fromPersonName == toPersonName) {
+            return;
+        }
+        SharedTaskStore::WriteSection shared(m_sharedStore.get(), m_version);
+        const int numOfTasks = moveAllTasks(fromPerson, toPersonName);
+        findPerson(toPersonName)->trimToCapacity(collectEvictions(toPersonName, evicted));
+        m_version++;
+        if (m_changeFeed.hasSubscribers()) {
+            publishMove(ChangeType::TasksReassigned, toPersonName, fromPersonName, numOfTasks);
+        }
+        forgetEvictedTasks(evicted);
+    }
+    m_changeFeed.deliver();
+    reportEvictions(evicted);
+}
+
+void TaskManager::mergePersons(const string &personName, const string &otherPersonName) {
+    EvictedTasks evicted;
+    {
+        std::lock_guard<std::mutex> lock(m_versionMutex);
+        Person* otherPerson = findPerson(otherPersonName);
+        if (otherPerson == nullptr || personName == otherPersonName) {
+            return;
+        }
+        SharedTaskStore::WriteSection shared(m_sharedStore.get(), m_version);
+        int numOfTasks = 0;
+        if (findPerson(personName) == nullptr) {
+            // the merged person leaves before the new one is added - in a full table its place is the only one
+            Person merged(otherPersonName, m_taskStorage);
+            numOfTasks = merged.mergeTasksFrom(*otherPerson);
+            removePerson(otherPerson);
+            Person* person = addPerson(personName);
+            person->mergeTasksFrom(merged);
+            if (m_sharedStore) {
+                copyTasksToSharedStore(*m_sharedStore, indexOf(person), *person);
+            }
+        }
+        else {
+            numOfTasks = moveAllTasks(otherPerson, personName);
+            removePerson(otherPerson);
+        }
+        findPerson(personName)->trimToCapacity(collectEvictions(personName, evicted));
+        m_version++;
+        if (m_changeFeed.hasSubscribers()) {
+            publishMove(ChangeType::PersonsMerged, personName, otherPersonName, numOfTasks);
+        }
+        forgetEvictedTasks(evicted);
+    }
+    m_changeFeed.deliver();
+    reportEvictions(evicted);
+}
+
+RebalanceReport TaskManager::rebalance(const RebalancePolicy &policy) {
+    RebalanceReport report;
+    EvictedTasks evicted;
+    {
+        std::lock_guard<std::mutex> lock(m_versionMutex);
+        SharedTaskStore::WriteSection shared(m_sharedStore.get(), m_version);
+        if (!policy.perTaskType) {
+            rebalanceTasks(policy.measure, nullptr, report);
         }
+        else {
+            for (int type = 0; type < NUM_TASK_TYPES; ++type) {
+                const TaskType taskType = static_cast<TaskType>(type);
+                rebalanceTasks(policy.measure, &taskType, report);
+            }
+        }
+
+        if (report.tasksMoved > 0) {
+            // the moves are not tracked task by task - every list is written anew
+            if (m_sharedStore) {
+                for (unsigned int i = 0; i < m_numOfPersons; ++i) {
+                    copyTasksToSharedStore(*m_sharedStore, static_cast<int>(i), m_personArray[i]);
+                }
+            }
+            for (unsigned int i = 0; i < m_numOfPersons; ++i) {
+                m_personArray[i].trimToCapacity(collectEvictions(m_personArray[i].getName(), evicted));
+            }
+            m_version++;
+            if (m_changeFeed.hasSubscribers()) {
+                publishMove(ChangeType::TasksRebalanced, "", "", static_cast<int>(report.tasksMoved));
+            }
+            forgetEvictedTasks(evicted);
+        }
+    }
+    m_changeFeed.deliver();
+    reportEvictions(evicted);
+    return report;
+}
+
+void TaskManager::enableDescriptionIndex() {
+    std::lock_guard<std::mutex> lock(m_versionMutex);
+    if (m_descriptionIndex) {
+        return;
+    }
+    // the posting lists are kept by ascending id, so the tasks are added in the order they were assigned
+    std::vector<Task> allTasks;
+    allTasks.reserve(m_stats.getTotalCount());
+    for (unsigned int i = 0; i < m_numOfPersons; ++i) {
+        m_personArray[i].forEachTask([&allTasks](const Task& curTask) {
+            allTasks.push_back(curTask);
+            return true;
+        });
+    }
+    std::sort(allTasks.begin(), allTasks.end(), [](const Task &a, const Task &b) {
+        return a.getId() < b.getId();
+    });
+    auto newIndex = std::make_unique<DescriptionIndex>();
+    for (const Task& curTask : allTasks) {
+        newIndex->add(curTask);
+    }
+    m_descriptionIndex = std::move(newIndex);
+}
+
+void TaskManager::enableSharedMemory(const string &segmentName, std::size_t segmentBytes) {
+    std::lock_guard<std::mutex> lock(m_versionMutex);
+    if (m_sharedStore) {
+        return;
+    }
+    auto newStore = std::make_unique<SharedTaskStore>(segmentName, segmentBytes,
+                                                      static_cast<int>(m_personArray.size()));
+    {
+        SharedTaskStore::WriteSection shared(newStore.get(), m_version);
+        for (unsigned int i = 0; i < m_numOfPersons; ++i) {
+            newStore->addPerson(m_personArray[i].getName());
+            copyTasksToSharedStore(*newStore, static_cast<int>(i), m_personArray[i]);
+        }
+    }
+    m_sharedStore = std::move(newStore);
+}
+
+std::vector<Task> TaskManager::searchDescriptions(const string &query, int k) const {
+    MTM_METRICS_TIME_OPERATION(SearchDescriptions);
+    std::lock_guard<std::mutex> lock(m_versionMutex);
+    if (m_descriptionIndex) {
+        return m_descriptionIndex->search(query, k);
+    }
+
+    const std::vector<string> queryTokens = DescriptionIndex::tokenize(query);
+    std::vector<Task> matches;
+    if (queryTokens.empty() || k <= 0) {
+        return matches;
+    }
+    for (unsigned int i = 0; i < m_numOfPersons; ++i) {
+        m_personArray[i].forEachTask([&queryTokens, &matches](const Task& curTask) {
+            const std::vector<string> tokens = DescriptionIndex::tokenize(curTask.getDescription());
+            const bool hasAll = std::all_of(queryTokens.begin(), queryTokens.end(), [&tokens](const string &token) {
+                return std::find(tokens.begin(), tokens.end(), token) != tokens.end();
+            });
+            if (hasAll) {
+                matches.push_back(curTask);
+            }
+            return true;
+        });
     }
+    const std::size_t numOfResults = std::min(matches.size(), static_cast<std::size_t>(k));
+    std::partial_sort(matches.begin(), matches.begin() + numOfResults, matches.end(), std::greater<Task>());
+    matches.erase(matches.begin() + numOfResults, matches.end());
+    return matches;
 }
 
 void TaskManager::printAllEmployees() const {
+    std::lock_guard<std::mutex> lock(m_versionMutex);
     for (unsigned int i = 0; i < m_numOfPersons; ++i) {
         std::cout << m_personArray[i] << std::endl;
     }
 }
 
 void TaskManager::printTasksByType(TaskType type) const {
-    const SortedList<Task> listOfAllTasks = createListOfAllTasks();
-    const SortedList<Task> listToPrint = listOfAllTasks.filter([&type](const Task& curTask) -> bool {
-        if (curTask.getType() == type) {
-            return true;
-        }
-        return false;
-    });
-    printTaskList(listToPrint);
+    printTasksByType(TaskTypeSet(type));
+}
+
+void TaskManager::printTasksByType(TaskTypeSet types) const {
+    MTM_METRICS_TIME_OPERATION(PrintTasksByType);
+    // the other types are left out while the list is built, instead of filtered out of a list of everything
+    SortedList<Task> tasksToPrint;
+    {
+        std::lock_guard<std::mutex> lock(m_versionMutex);
+        tasksToPrint = createListOfAllTasks(types);
+    }
+    printTaskList(tasksToPrint);
 }
 
 void TaskManager::printAllTasks() const {
-    printTaskList(createListOfAllTasks());
+    SortedList<Task> tasksToPrint;
+    {
+        std::lock_guard<std::mutex> lock(m_versionMutex);
+        tasksToPrint = createListOfAllTasks();
+    }
+    printTaskList(tasksToPrint);
 }
 
-// -------------------------------- helpers -------------------------------- //
+TaskStats TaskManager::stats() const {
+    std::lock_guard<std::mutex> lock(m_versionMutex);
+    return m_stats;
+}
 
-Person* TaskManager::findPerson(const string &personName) {
-    for (Person& curPerson : m_personArray) {
-        if (curPerson.getName() == personName) {
-            return &curPerson;
+TaskStats TaskManager::stats(const string &personName) const {
+    std::lock_guard<std::mutex> lock(m_versionMutex);
+    if (const Person* curPerson = findAddedPerson(personName)) {
+        return curPerson->stats();
+    }
+
+    return TaskStats();
+}
+
+std::shared_ptr<const SortedList<Task>> TaskManager::snapshotTasks(const string &personName) const {
+    Person::FrozenTasks frozen;
+    {
+        std::lock_guard<std::mutex> lock(m_versionMutex);
+        if (const Person* curPerson = findAddedPerson(personName)) {
+            frozen = curPerson->freezeTasks();
+        }
+    }
+    if (frozen.tasks == nullptr && frozen.buckets == nullptr) {
+        return std::make_shared<const SortedList<Task>>();
+    }
+
+    return frozen.toList(); // the pending bumps are applied (and the buckets listed) without the lock
+}
+
+ChangeFeed& TaskManager::changeFeed() {
+    return m_changeFeed;
+}
+
+TaskManagerSnapshot TaskManager::snapshot() const {
+    TaskManagerSnapshot newSnapshot;
+    std::vector<Person::FrozenTasks> frozen;
+    {
+        std::lock_guard<std::mutex> lock(m_versionMutex);
+        const unsigned int numOfPersons = m_numOfPersons.load(std::memory_order_relaxed);
+        newSnapshot.m_persons.reserve(numOfPersons);
+        frozen.reserve(numOfPersons);
+        for (unsigned int i = 0; i < numOfPersons; ++i) {
+            newSnapshot.m_persons.push_back({m_personArray[i].getName(), nullptr});
+            frozen.push_back(m_personArray[i].freezeTasks());
         }
+        newSnapshot.m_stats = m_stats;
+        newSnapshot.m_version = m_version;
+    }
+    // the pending bumps are applied (and the buckets listed) without the lock
+    for (std::size_t i = 0; i < frozen.size(); ++i) {
+        newSnapshot.m_persons[i].tasks = frozen[i].toList();
     }
 
-    return nullptr;
+    return newSnapshot;
+}
+
+MemoryUsage TaskManager::memoryUsage() const {
+    MemoryUsage usage;
+    std::lock_guard<std::mutex> lock(m_versionMutex);
+    usage.personTableBytes = m_personArray.size() * sizeof(Person);
+    for (const Person& curPerson : m_personArray) {
+        usage.personTableBytes += curPerson.getNameHeapBytes();
+    }
+
+    const std::size_t numOfTasks = m_stats.getTotalCount();
+    usage.taskPayloadBytes = numOfTasks * sizeof(Task);
+    if (m_taskStorage == TaskStorage::Buckets) {
+        usage.personTableBytes += m_numOfPersons * sizeof(TaskBucketQueue);
+        usage.listNodeBytes = numOfTasks * (TaskBucketQueue::nodeSize() - sizeof(Task));
+    }
+    else {
+        usage.listNodeBytes = numOfTasks * (SortedList<Task>::nodeSize() - sizeof(Task));
+    }
+    for (unsigned int i = 0; i < m_numOfPersons; ++i) {
+        // walked in place - a list copy of the tasks would allocate as much as is being measured
+        m_personArray[i].forEachTask([&usage](const Task& curTask) {
+            usage.descriptionHeapBytes += curTask.getDescriptionHeapBytes();
+            return true;
+        });
+    }
+    if (m_descriptionIndex) {
+        usage.searchIndexBytes = m_descriptionIndex->memoryBytes();
+    }
+
+    return usage;
+}
+
+// -------------------------------- helpers -------------------------------- //
+
+Person* TaskManager::findPerson(const string &personName) {
+    auto found = m_personIndex.find(personName);
+    return (found != m_personIndex.end()) ? &m_personArray[found->second] : nullptr;
+}
+
+const Person *TaskManager::findAddedPerson(const string &personName) const {
+    // persons are added and moved (mergePersons) under m_versionMutex only, so callers on other threads hold it
+    auto found = m_personIndex.find(personName);
+    return (found != m_personIndex.end()) ? &m_personArray[found->second] : nullptr;
 }
 
 Person *TaskManager::addPerson(const string &personName) {
-    if (m_numOfPersons >= MAX_PERSONS) {
+    if (m_numOfPersons >= m_personArray.size()) {
         throw std::runtime_error("Max Number of People Reached");
     }
-    m_personArray[m_numOfPersons++] = Person(personName);
+    const unsigned int newIndex = m_numOfPersons.load(std::memory_order_relaxed);
+    m_personArray[newIndex] = Person(personName, m_taskStorage);
+    m_personIndex.emplace(personName, newIndex);
+    m_numOfPersons.store(newIndex + 1, std::memory_order_release);
+    if (m_sharedStore) {
+        m_sharedStore->addPerson(personName);
+    }
+    if (m_changeFeed.hasSubscribers()) {
+        publishChange(ChangeType::PersonAdded, personName, -1, 0, TaskType::General);
+    }
+
+    return &m_personArray[newIndex];
+}
 
-    return &m_personArray[m_numOfPersons - 1];
+void TaskManager::removePerson(Person *person) {
+    // the persons after it move up one place, so the order of addition is kept. moving a person only swaps
+    // pointers, its tasks stay unshared
+    const unsigned int numOfPersons = m_numOfPersons.load(std::memory_order_relaxed);
+    if (m_sharedStore) {
+        m_sharedStore->removePerson(indexOf(person));
+    }
+    m_personIndex.erase(person->getName());
+    Person* lastPerson = &m_personArray[numOfPersons - 1];
+    for (Person* curPerson = person; curPerson != lastPerson; ++curPerson) {
+        *curPerson = std::move(*(curPerson + 1));
+        m_personIndex[curPerson->getName()] = static_cast<unsigned int>(curPerson - m_personArray.data());
+    }
+    *lastPerson = Person();
+    m_numOfPersons.store(numOfPersons - 1, std::memory_order_release);
 }
 
-SortedList<Task> TaskManager::createListOfAllTasks() const {
+int TaskManager::moveAllTasks(Person *fromPerson, const string &toPersonName) {
+    Person* toPerson = findPerson(toPersonName);
+    if (toPerson == nullptr) {
+        toPerson = addPerson(toPersonName);
+    }
+    // the totals do not change, the tasks only change hands
+    const int numOfTasks = toPerson->mergeTasksFrom(*fromPerson);
+    if (m_sharedStore) {
+        m_sharedStore->moveTasks(indexOf(fromPerson), indexOf(toPerson));
+    }
+    return numOfTasks;
+}
+
+int TaskManager::indexOf(const Person *person) const {
+    return static_cast<int>(person - m_personArray.data());
+}
+
+void TaskManager::rebalanceTasks(RebalanceMeasure measure, const TaskType *type, RebalanceReport &report) {
+    const unsigned int numOfPersons = m_numOfPersons.load(std::memory_order_relaxed);
+    if (numOfPersons < 2) {
+        return;
+    }
+
+    std::vector<long long> loads(numOfPersons);
+    long long totalLoad = 0;
+    for (unsigned int i = 0; i < numOfPersons; ++i) {
+        loads[i] = personLoad(m_personArray[i], measure, type);
+        totalLoad += loads[i];
+        report.maxLoadBefore = std::max(report.maxLoadBefore, loads[i]);
+    }
+
+    // everyone gets the average, and the heaviest persons keep the remainder - so the fewest tasks move
+    std::vector<unsigned int> byLoad(numOfPersons);
+    std::iota(byLoad.begin(), byLoad.end(), 0);
+    std::stable_sort(byLoad.begin(), byLoad.end(), [&loads](unsigned int a, unsigned int b) {
+        return loads[a] > loads[b];
+    });
+    std::vector<long long> targets(numOfPersons, totalLoad / numOfPersons);
+    for (long long i = 0; i < totalLoad % numOfPersons; ++i) {
+        targets[byLoad[i]]++;
+    }
+
+    // the donors split their lowest tasks off into a pool...
+    std::vector<SortedList<Task>> pool;
+    std::vector<long long> poolLoads;
+    for (unsigned int i = 0; i < numOfPersons; ++i) {
+        if (loads[i] <= targets[i]) {
+            continue;
+        }
+        long long chunkLoad = 0;
+        const Person &donor = m_personArray[i];
+        const int numOfTasks = countLowestTasks([&donor](const auto &visit) { donor.forEachTask(visit, true); },
+                                                loads[i] - targets[i], false, measure, type, chunkLoad);
+        if (numOfTasks > 0) {
+            pool.push_back(detachLowest(m_personArray[i], numOfTasks, type));
+            poolLoads.push_back(chunkLoad);
+            loads[i] -= chunkLoad;
+            report.tasksMoved += numOfTasks;
+        }
+    }
+
+    // ...which the receivers take whole, or cut from its lowest end when a chunk is more than they need. a
+    // receiver may go over its target by one task, otherwise summed priorities would leave pieces nobody takes
+    for (unsigned int i = 0; i < numOfPersons && !pool.empty(); ++i) {
+        while (loads[i] < targets[i] && !pool.empty()) {
+            const long long need = targets[i] - loads[i];
+            if (poolLoads.back() <= need) {
+                loads[i] += poolLoads.back();
+                m_personArray[i].mergeTasks(std::move(pool.back()));
+                pool.pop_back();
+                poolLoads.pop_back();
+                continue;
+            }
+            long long pieceLoad = 0;
+            SortedList<Task>& chunk = pool.back();
+            const int numOfTasks = countLowestTasks([&chunk](const auto &visit) {
+                for (auto It = chunk.rbegin(); It != chunk.rend() && visit(*It); ++It) {}
+            }, need, true, measure, nullptr, pieceLoad);
+            m_personArray[i].mergeTasks(chunk.split(std::prev(chunk.end(), numOfTasks)));
+            poolLoads.back() -= pieceLoad;
+            loads[i] += pieceLoad;
+        }
+    }
+
+    // receivers that went over their targets leave a few tasks behind - they go to the least loaded persons
+    if (!pool.empty()) {
+        using LoadOfPerson = std::pair<long long, unsigned int>;
+        std::priority_queue<LoadOfPerson, std::vector<LoadOfPerson>, std::greater<LoadOfPerson>> leastLoaded;
+        for (unsigned int i = 0; i < numOfPersons; ++i) {
+            leastLoaded.push({loads[i], i});
+        }
+        for (std::size_t chunk = 0; chunk < pool.size(); ++chunk) {
+            const unsigned int receiver = leastLoaded.top().second;
+            leastLoaded.pop();
+            loads[receiver] += poolLoads[chunk];
+            m_personArray[receiver].mergeTasks(std::move(pool[chunk]));
+            leastLoaded.push({loads[receiver], receiver});
+        }
+    }
+
+    for (unsigned int i = 0; i < numOfPersons; ++i) {
+        report.maxLoadAfter = std::max(report.maxLoadAfter, loads[i]);
+    }
+}
+
+Person::EvictionCallback TaskManager::collectEvictions(const string &personName, EvictedTasks &evicted) {
+    return [&personName, &evicted](const Task &evictedTask) {
+        evicted.emplace_back(personName, evictedTask);
+    };
+}
+
+void TaskManager::forgetEvictedTasks(const EvictedTasks &evicted) {
+    for (const auto &[personName, evictedTask] : evicted) {
+        m_stats.remove(evictedTask);
+        m_countsByTypeAndPriority[static_cast<int>(evictedTask.getType())]
+                                 [evictedTask.getPriority() - Task::MIN_PRIORITY]--;
+        if (m_descriptionIndex) {
+            m_descriptionIndex->remove(evictedTask.getId());
+        }
+        if (m_sharedStore) {
+            m_sharedStore->removeTask(evictedTask.getId());
+        }
+        if (m_changeFeed.hasSubscribers()) {
+            publishChange(ChangeType::TaskEvicted, personName, evictedTask.getId(), evictedTask.getPriority(),
+                          evictedTask.getType());
+        }
+    }
+}
+
+void TaskManager::reportEvictions(const EvictedTasks &evicted) const {
+    if (evicted.empty()) {
+        return;
+    }
+    std::function<void(const string &, const Task &)> onEvicted;
+    {
+        std::lock_guard<std::mutex> lock(m_versionMutex);
+        onEvicted = m_onEvicted;
+    }
+    if (onEvicted) {
+        for (const auto &[personName, evictedTask] : evicted) {
+            onEvicted(personName, evictedTask);
+        }
+    }
+}
+
+SortedList<Task> TaskManager::createListOfAllTasks(TaskTypeSet types) const {
     SortedList<Task> newListOfTasks;
     for (unsigned int i = 0; i < m_numOfPersons; ++i) {
-        const Person& curPerson = m_personArray[i];
-        const SortedList<Task>& curTaskList = curPerson.getTasks();
-        for (const Task& curTask : curTaskList) {
-            newListOfTasks.insert(curTask);
-        }
+        m_personArray[i].forEachTask([types, &newListOfTasks](const Task& curTask) {
+            if (types.contains(curTask.getType())) {
+                newListOfTasks.insert(curTask);
+            }
+            return true;
+        });
     }
 
     return newListOfTasks;
 }
 
+void TaskManager::publishChange(ChangeType type, const string &personName, int taskId, int priority,
+                                TaskType taskType) {
+    ChangeEvent event;
+    event.type = type;
+    event.personName = personName;
+    event.taskId = taskId;
+    event.priority = priority;
+    event.taskType = taskType;
+    m_changeFeed.publish(event);
+}
+
+void TaskManager::publishMove(ChangeType type, const string &personName, const string &otherPersonName,
+                              int numOfTasks) {
+    ChangeEvent event;
+    event.type = type;
+    event.personName = personName;
+    event.otherPersonName = otherPersonName;
+    event.count = numOfTasks;
+    m_changeFeed.publish(event);
+}
+
 void TaskManager::printTaskList(const SortedList<Task> &listToPrint) {
     for (const Task& curTask : listToPrint) {
         std::cout << curTask << std::endl;
@@ -1,9 +1,24 @@
 
 #pragma once
 
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "ChangeFeed.h"
+#include "DescriptionIndex.h"
+#include "MemoryUsage.h"
 #include "Person.h"
+#include "Rebalance.h"
+#include "SharedTaskStore.h"
 #include "SortedList.h"
 #include "Task.h"
+#include "TaskManagerSnapshot.h"
+#include "TaskStats.h"
+#include "TaskTypeSet.h"
 
 /**
  * @brief Class managing tasks assigned to multiple persons.
@@ -11,18 +26,51 @@
 class TaskManager {
 private:
     /**
-     * @brief Maximum number of persons the TaskManager can handle.
+     * @brief Default maximum number of persons the TaskManager can handle.
      */
     static const int MAX_PERSONS = 10;
-    Person m_personArray[MAX_PERSONS];
-    unsigned int m_numOfPersons = 0;
+    std::vector<Person> m_personArray; // one place per person it can handle, never resized
+    std::unordered_map<string, unsigned int> m_personIndex; // name -> place in m_personArray, of added persons
+    // changed only under m_versionMutex, which the lookups from other threads take as well
+    std::atomic<unsigned int> m_numOfPersons{0};
+    TaskStorage m_taskStorage; // how every added person stores its tasks
     int m_newestTaskId = 0;
+    TaskStats m_stats;
+    // the tasks by type and priority - a bump moves whole rows here (and in m_stats) while the persons apply
+    // it to their tasks lazily
+    int m_countsByTypeAndPriority[NUM_TASK_TYPES][TaskStats::NUM_PRIORITIES] = {};
+    ChangeFeed m_changeFeed;
+    std::unique_ptr<DescriptionIndex> m_descriptionIndex; // null until enableDescriptionIndex()
+    std::unique_ptr<SharedTaskStore> m_sharedStore; // null until enableSharedMemory()
+    std::function<void(const string &, const Task &)> m_onEvicted; // see setEvictionCallback()
+
+    // every mutation runs under m_versionMutex and bumps m_version, so snapshot() sees whole mutations only
+    mutable std::mutex m_versionMutex;
+    unsigned long long m_version = 0;
 
     // Note - Additional private fields and methods can be added if needed.
 
     Person *findPerson(const string &personName);
+    const Person *findAddedPerson(const string &personName) const;
     Person *addPerson(const string &personName);
-    SortedList<Task> createListOfAllTasks() const;
+    // the place of a person in order of addition
+    int indexOf(const Person *person) const;
+    void removePerson(Person *person);
+    int moveAllTasks(Person *fromPerson, const string &toPersonName);
+    void rebalanceTasks(RebalanceMeasure measure, const TaskType *type, RebalanceReport &report);
+
+    // the tasks persons evicted during one mutation, with the names of the persons
+    using EvictedTasks = std::vector<std::pair<string, Task>>;
+    // collects the tasks a person evicts into evicted - by reference, for the call it is passed to only
+    static Person::EvictionCallback collectEvictions(const string &personName, EvictedTasks &evicted);
+    // takes evicted tasks out of the totals and the description index, and publishes them
+    void forgetEvictedTasks(const EvictedTasks &evicted);
+    // hands evicted tasks to the eviction callback - called without m_versionMutex held
+    void reportEvictions(const EvictedTasks &evicted) const;
+    SortedList<Task> createListOfAllTasks(TaskTypeSet types = TaskTypeSet::all()) const;
+
+    void publishChange(ChangeType type, const string &personName, int taskId, int priority, TaskType taskType);
+    void publishMove(ChangeType type, const string &personName, const string &otherPersonName, int numOfTasks);
 
     static void printTaskList(const SortedList<Task> &listToPrint);
 
@@ -34,6 +82,15 @@ public:
      */
     TaskManager();
 
+    /**
+     * @brief Constructor to create a TaskManager object for a given number of persons.
+     *
+     * @param maxPersons The maximum number of persons the TaskManager can handle.
+     * @param taskStorage How the persons store their tasks (default is TaskStorage::List) - TaskStorage::Buckets
+     *                    makes assigning and completing O(1), at about 2.5KB of bucket table per person.
+     */
+    explicit TaskManager(int maxPersons, TaskStorage taskStorage = TaskStorage::List);
+
     /**
      * @brief Deleted copy constructor to prevent copying of TaskManager objects.
      */
@@ -47,25 +104,156 @@ public:
     /**
      * @brief Assigns a task to a person.
      *
+     * If the person is at its capacity (see setPersonCapacity()), its lowest priority task - possibly the new
+     * one - is evicted.
+     *
      * @param personName The name of the person to whom the task will be assigned.
      * @param task The task to be assigned.
      */
     void assignTask(const string &personName, const Task &task);
 
+    /**
+     * @brief Caps the number of tasks a person holds, evicting its lowest priority tasks above the cap.
+     *
+     * From then on an assign to a full person evicts its lowest priority task in O(1), and so do moves
+     * (reassignAllTasks, mergePersons, rebalance) for every task they carry the person over its capacity.
+     * Evicted tasks leave the stats and are published as ChangeType::TaskEvicted and handed to the eviction
+     * callback (see setEvictionCallback()).
+     *
+     * @param personName The name of the person (added if needed, like in assignTask).
+     * @param capacity The most tasks the person holds, 0 for no limit.
+     * @throws std::invalid_argument If the capacity is negative.
+     */
+    void setPersonCapacity(const string &personName, int capacity);
+
+    /**
+     * @brief Sets the function called with every task a person evicts to stay within its capacity.
+     *
+     * Called after the TaskManager is unlocked, so it may call back into the TaskManager - e.g. to assign the
+     * evicted task to someone else.
+     *
+     * @param onEvicted Called with the name of the person and the evicted task (nullptr for none).
+     */
+    void setEvictionCallback(std::function<void(const string &personName, const Task &task)> onEvicted);
+
+    /**
+     * @brief Assigns several tasks to a person at once, under one lock and with one merge into the person's list.
+     *
+     * The same as assigning them one by one, in their order (capacity evictions included) - only cheaper.
+     *
+     * @param personName The name of the person to whom the tasks will be assigned.
+     * @param tasks The tasks to be assigned.
+     * @return int The id given to the first task - the others get the ids after it, in their order.
+     */
+    int assignTasks(const string &personName, const std::vector<Task> &tasks);
+
     /**
      * @brief Completes the highest priority task assigned to a person.
      *
      * @param personName The name of the person who will complete the task.
+     * @return int The id of the completed task, or -1 if there is no such person.
      */
-    void completeTask(const string &personName);
+    int completeTask(const string &personName);
 
     /**
      * @brief Bumps the priority of all tasks of a specific type.
      *
+     * O(number of persons): every person records the bump and applies it when its tasks are next read or
+     * completed (see Person::bumpPriorityByType), while stats() is up to date right away.
+     *
      * @param type The type of tasks whose priority will be bumped.
      * @param priority The amount by which the priority will be increased.
      */
     void bumpPriorityByType(TaskType type, int priority);
+
+    /**
+     * @brief Bumps the priority of all tasks of several types at once, in one pass over the persons.
+     *
+     * The same as bumping every type on its own, and publishes one PriorityBumped event per type.
+     *
+     * @param types The types of tasks whose priority will be bumped.
+     * @param priority The amount by which the priority will be increased.
+     */
+    void bumpPriorityByType(TaskTypeSet types, int priority);
+
+    /**
+     * @brief Moves every task of one person to another, relinking the task lists instead of copying them.
+     *
+     * Nothing happens if there is no person named fromPersonName. The tasks keep their ids.
+     *
+     * @param fromPersonName The name of the person whose tasks are moved - left with no tasks.
+     * @param toPersonName The name of the person receiving the tasks (added if needed, like in assignTask).
+     */
+    void reassignAllTasks(const string &fromPersonName, const string &toPersonName);
+
+    /**
+     * @brief Merges one person into another: every task moves over, and the merged person is removed.
+     *
+     * Frees the merged person's place for a new person - or gives it to personName, if that is a new person, so
+     * a full table can merge into a new name. Nothing happens if there is no person named otherPersonName.
+     *
+     * @param personName The name of the person that remains (added if needed, like in assignTask).
+     * @param otherPersonName The name of the person merged into it.
+     */
+    void mergePersons(const string &personName, const string &otherPersonName);
+
+    /**
+     * @brief Redistributes tasks so that every person carries about the same load.
+     *
+     * Persons above the average give away their lowest priority tasks, and persons below it receive them.
+     * Tasks are moved by splitting and merging the persons' task lists - no task is copied or allocated.
+     *
+     * Cost: the loads come from the per-person counters, O(persons) - except a PrioritySum per type, which
+     * walks every task once. Then O(persons * log persons) to plan, O(tasks moved) to split them off the
+     * donors, and for every piece a merge into the receiver, linear in the part of its list the piece
+     * interleaves with (O(1) when the piece only holds lower priorities).
+     *
+     * Persons with a capacity (see setPersonCapacity()) evict the lowest priority tasks they receive above it.
+     *
+     * @param policy What is balanced: the number of tasks or their summed priority, optionally per TaskType.
+     * @return RebalanceReport The number of tasks moved and the highest load before and after.
+     */
+    RebalanceReport rebalance(const RebalancePolicy &policy = RebalancePolicy());
+
+    /**
+     * @brief Starts keeping an inverted index of the task descriptions, for searchDescriptions().
+     *
+     * Indexes the tasks assigned so far (walks them once), and from then on every assign, complete and bump
+     * keeps the index up to date at O(1) each (O(words in the description) for an assign). Nothing happens if
+     * the index is already kept.
+     */
+    void enableDescriptionIndex();
+
+    /**
+     * @brief Finds the highest priority tasks whose description has every word of a query.
+     *
+     * Words are runs of letters and digits, compared case-insensitively. With the description index (see
+     * enableDescriptionIndex()) this walks the posting lists of the query's words only, otherwise it scans
+     * every task.
+     *
+     * @param query The words to be searched for.
+     * @param k The largest number of tasks returned.
+     * @return std::vector<Task> The matching tasks, at most k, from the highest priority to the lowest.
+     */
+    std::vector<Task> searchDescriptions(const string &query, int k) const;
+
+    /**
+     * @brief Starts keeping the persons and their tasks in a POSIX shared-memory segment, for other processes
+     * to read with a SharedTaskReader.
+     *
+     * Copies the persons and tasks so far into the segment, and from then on every mutation changes the
+     * segment too, in the same step as the TaskManager (see SharedTaskStore for the costs). Readers take no
+     * lock - they never wait for the TaskManager, nor it for them. The segment is removed when the TaskManager
+     * is destroyed. Nothing happens if the TaskManager already keeps a segment.
+     *
+     * @param segmentName The name of the segment, like "/tasks" - an older segment of that name is replaced.
+     * @param segmentBytes The size of the segment. It never grows - if the tasks outgrow it, it stops following
+     *                     the TaskManager, and readers get an error.
+     * @throws std::invalid_argument If the name is not valid, or the segment is too small for the persons.
+     * @throws std::system_error If the segment cannot be created.
+     */
+    void enableSharedMemory(const string &segmentName, std::size_t segmentBytes);
+
     /**
      * @brief Prints all employees and their tasks.
      */
@@ -78,8 +266,75 @@ public:
      */
     void printTasksByType(TaskType type) const;
 
+    /**
+     * @brief Prints all tasks of any of several types, in one pass over the tasks.
+     *
+     * @param types The types of tasks to be printed.
+     */
+    void printTasksByType(TaskTypeSet types) const;
+
     /**
      * @brief Prints all tasks assigned to all employees.
      */
     void printAllTasks() const;
+
+    /**
+     * @brief Gets the aggregate counters of all tasks, without scanning any task list.
+     *
+     * @return TaskStats A copy of the stats of all tasks assigned to all employees, taken under the lock the
+     *         mutations hold - so it may be called while another thread (like a TaskPipeline) changes the tasks.
+     */
+    TaskStats stats() const;
+
+    /**
+     * @brief Gets the aggregate counters of the tasks assigned to a person.
+     *
+     * @param personName The name of the person.
+     * @return TaskStats The stats of the person's tasks (empty if there is no such person).
+     */
+    TaskStats stats(const string &personName) const;
+
+    /**
+     * @brief Reports how much memory the TaskManager holds, broken down by what holds it.
+     *
+     * @return MemoryUsage The memory report (walks all tasks once).
+     */
+    MemoryUsage memoryUsage() const;
+
+    /**
+     * @brief Gets the feed on which every mutation of the TaskManager is published.
+     *
+     * Subscribe here to follow assignments, completions, bumps and new persons instead of polling full dumps.
+     * Every mutation delivers its events after it releases the lock, so consumer threads may read this
+     * TaskManager (stats, snapshots, searches) - but a BackpressurePolicy::Block consumer must not change it, or
+     * the delivery waits for room that consumer never makes.
+     *
+     * @return ChangeFeed& The change feed of the TaskManager.
+     */
+    ChangeFeed& changeFeed();
+
+    /**
+     * @brief Takes an immutable snapshot of the tasks assigned to a person.
+     *
+     * May be called on any thread while this TaskManager keeps assigning, completing and bumping tasks,
+     * and the snapshot may be iterated for as long as it is held. The writers wait only while the person's
+     * tasks are frozen (see Person::freezeTasks()) - the pending bumps are applied to a copy after the lock
+     * is released, by the thread that takes the snapshot.
+     *
+     * @param personName The name of the person.
+     * @return std::shared_ptr<const SortedList<Task>> The person's tasks (an empty list if there is no such person).
+     */
+    std::shared_ptr<const SortedList<Task>> snapshotTasks(const string &personName) const;
+
+    /**
+     * @brief Takes a consistent point-in-time snapshot of all persons and tasks.
+     *
+     * May be called on any thread while this TaskManager keeps changing. Writers only wait for the person
+     * lists to be shared and their pending bumps copied - O(number of persons + pending bumps) - and the first
+     * later change of a shared list copies it instead. The persons with pending bumps get them applied to a
+     * copy of their list after the lock is released, by the thread that takes the snapshot.
+     *
+     * @return TaskManagerSnapshot An immutable view of the whole TaskManager, with reports like printAllTasks().
+     */
+    TaskManagerSnapshot snapshot() const;
 };
@@ -0,0 +1,66 @@
+#include "TaskManagerSnapshot.h"
+
+using std::endl;
+
+// Getters
+unsigned long long TaskManagerSnapshot::getVersion() const {
+    return m_version;
+}
+
+int TaskManagerSnapshot::getNumOfPersons() const {
+    return static_cast<int>(m_persons.size());
+}
+
+const string& TaskManagerSnapshot::getPersonName(int index) const {
+    return m_persons.at(index).name;
+}
+
+const SortedList<Task>& TaskManagerSnapshot::getTasks(int index) const {
+    return *m_persons.at(index).tasks;
+}
+
+const TaskStats& TaskManagerSnapshot::stats() const {
+    return m_stats;
+}
+
+// Reports
+void TaskManagerSnapshot::printAllEmployees(ostream& os) const {
+    for (const PersonView& curPerson : m_persons) {
+        os << "Person: " << curPerson.name << endl;
+        for (const Task& curTask : *curPerson.tasks) {
+            os << curTask << endl;
+        }
+        os << endl;
+    }
+}
+
+void TaskManagerSnapshot::printTasksByType(TaskType type, ostream& os) const {
+    printTasksByType(TaskTypeSet(type), os);
+}
+
+void TaskManagerSnapshot::printTasksByType(TaskTypeSet types, ostream& os) const {
+    for (const Task& curTask : createListOfAllTasks(types)) {
+        os << curTask << endl;
+    }
+}
+
+void TaskManagerSnapshot::printAllTasks(ostream& os) const {
+    for (const Task& curTask : createListOfAllTasks()) {
+        os << curTask << endl;
+    }
+}
+
+// -------------------------------- helpers -------------------------------- //
+
+SortedList<Task> TaskManagerSnapshot::createListOfAllTasks(TaskTypeSet types) const {
+    SortedList<Task> newListOfTasks;
+    for (const PersonView& curPerson : m_persons) {
+        for (const Task& curTask : *curPerson.tasks) {
+            if (types.contains(curTask.getType())) {
+                newListOfTasks.insert(curTask);
+            }
+        }
+    }
+
+    return newListOfTasks;
+}
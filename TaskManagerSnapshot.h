@@ -0,0 +1,106 @@
+#pragma once
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "SortedList.h"
+#include "Task.h"
+#include "TaskStats.h"
+#include "TaskTypeSet.h"
+
+using mtm::SortedList;
+using std::ostream;
+using std::string;
+
+/**
+ * @brief A consistent, immutable point-in-time view of a whole TaskManager.
+ *
+ * Built by TaskManager::snapshot(): every person's task list is shared, not copied, unless the person has
+ * bumps pending or keeps its tasks in buckets - then the snapshot gets a list of its own (see
+ * Person::freezeTasks()). The snapshot can be read and reported on any thread for as long as it is held, while
+ * the TaskManager keeps changing.
+ */
+class TaskManagerSnapshot {
+    friend class TaskManager;
+
+    struct PersonView {
+        string name;
+        std::shared_ptr<const SortedList<Task>> tasks;
+    };
+
+    unsigned long long m_version = 0;
+    std::vector<PersonView> m_persons;
+    TaskStats m_stats;
+
+    SortedList<Task> createListOfAllTasks(TaskTypeSet types = TaskTypeSet::all()) const;
+
+public:
+    /**
+     * @brief Gets the version of the TaskManager this snapshot shows.
+     *
+     * @return unsigned long long The number of mutations the TaskManager went through before the snapshot.
+     */
+    unsigned long long getVersion() const;
+
+    /**
+     * @brief Gets the number of persons in the snapshot.
+     *
+     * @return int The number of persons.
+     */
+    int getNumOfPersons() const;
+
+    /**
+     * @brief Gets the name of a person in the snapshot.
+     *
+     * @param index The index of the person, in order of addition.
+     * @return const string& The name of the person.
+     */
+    const string& getPersonName(int index) const;
+
+    /**
+     * @brief Gets the tasks of a person in the snapshot.
+     *
+     * @param index The index of the person, in order of addition.
+     * @return const SortedList<Task>& The tasks of the person.
+     */
+    const SortedList<Task>& getTasks(int index) const;
+
+    /**
+     * @brief Gets the aggregate counters of all tasks in the snapshot.
+     *
+     * @return const TaskStats& The stats of all tasks.
+     */
+    const TaskStats& stats() const;
+
+    /**
+     * @brief Prints all employees and their tasks, like TaskManager::printAllEmployees().
+     *
+     * @param os The output stream.
+     */
+    void printAllEmployees(ostream& os = std::cout) const;
+
+    /**
+     * @brief Prints all tasks of a specific type, like TaskManager::printTasksByType().
+     *
+     * @param type The type of tasks to be printed.
+     * @param os The output stream.
+     */
+    void printTasksByType(TaskType type, ostream& os = std::cout) const;
+
+    /**
+     * @brief Prints all tasks of any of several types, like TaskManager::printTasksByType(TaskTypeSet).
+     *
+     * @param types The types of tasks to be printed.
+     * @param os The output stream.
+     */
+    void printTasksByType(TaskTypeSet types, ostream& os = std::cout) const;
+
+    /**
+     * @brief Prints all tasks assigned to all employees, like TaskManager::printAllTasks().
+     *
+     * @param os The output stream.
+     */
+    void printAllTasks(ostream& os = std::cout) const;
+};
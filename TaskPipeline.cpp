@@ -0,0 +1,200 @@
+#include "TaskPipeline.h"
+
+#include <stdexcept>
+#include <algorithm>
+#include <vector>
+
+TaskPipeline::TaskPipeline(TaskManager& manager, int maxBatchSize) :
+    m_manager(manager), m_maxBatchSize(maxBatchSize), m_newest(nullptr), m_oldest(nullptr) {
+    if (maxBatchSize <= 0) {
+        throw std::invalid_argument("A pipeline batch needs room for at least one command");
+    }
+    Command* stub = new Command();
+    m_newest.store(stub, std::memory_order_relaxed);
+    m_oldest = stub;
+    m_owner = std::thread([this]() { run(); });
+}
+
+TaskPipeline::~TaskPipeline() {
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_stopping.store(true);
+    }
+    m_wake.notify_one();
+    m_owner.join();
+    delete m_oldest;
+}
+
+std::future<int> TaskPipeline::assignTask(const string& personName, const Task& task) {
+    Command* command = new Command();
+    command->kind = CommandKind::Assign;
+    command->personName = personName;
+    command->task = task;
+    std::future<int> result = std::get<std::promise<int>>(command->result).get_future();
+    push(command);
+    return result;
+}
+
+std::future<int> TaskPipeline::completeTask(const string& personName) {
+    Command* command = new Command();
+    command->kind = CommandKind::Complete;
+    command->personName = personName;
+    std::future<int> result = std::get<std::promise<int>>(command->result).get_future();
+    push(command);
+    return result;
+}
+
+std::future<void> TaskPipeline::bumpPriorityByType(TaskTypeSet types, int priority) {
+    Command* command = new Command();
+    command->kind = CommandKind::Bump;
+    command->types = types;
+    command->amount = priority;
+    std::future<void> result = command->result.emplace<std::promise<void>>().get_future();
+    push(command);
+    return result;
+}
+
+// -------------------------------- helpers -------------------------------- //
+
+void TaskPipeline::push(Command* command) {
+    Command* previous = m_newest.exchange(command, std::memory_order_acq_rel);
+    // seq_cst, like m_ownerWaiting - either the owner sees this command before it sleeps, or this sees it asleep
+    previous->next.store(command, std::memory_order_seq_cst);
+    if (m_ownerWaiting.load(std::memory_order_seq_cst)) {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_wake.notify_one();
+    }
+}
+
+TaskPipeline::Command* TaskPipeline::pop() {
+    Command* next = m_oldest->next.load(std::memory_order_acquire);
+    if (next != nullptr) {
+        m_oldest = next;
+    }
+    return next;
+}
+
+void TaskPipeline::run() {
+    std::vector<Command*> batch;
+    batch.reserve(m_maxBatchSize);
+    int idleRounds = 0;
+    while (true) {
+        // the popped commands stay alive until the batch is applied - the last one is the next stub
+        Command* stub = m_oldest;
+        for (Command* command; static_cast<int>(batch.size()) < m_maxBatchSize && (command = pop()) != nullptr;) {
+            batch.push_back(command);
+        }
+
+        if (batch.empty() && ++idleRounds < MAX_IDLE_ROUNDS) {
+            std::this_thread::yield();
+            continue;
+        }
+        if (batch.empty()) {
+            idleRounds = 0;
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            m_ownerWaiting.store(true, std::memory_order_seq_cst);
+            m_wake.wait(lock, [this]() {
+                return m_oldest->next.load(std::memory_order_seq_cst) != nullptr || m_stopping.load();
+            });
+            m_ownerWaiting.store(false, std::memory_order_relaxed);
+            if (m_oldest->next.load(std::memory_order_acquire) == nullptr) {
+                return; // stopping, and everything submitted before is applied
+            }
+            continue;
+        }
+
+        idleRounds = 0;
+        apply(batch.data(), batch.data() + batch.size());
+        delete stub;
+        for (std::size_t i = 0; i + 1 < batch.size(); ++i) {
+            delete batch[i];
+        }
+        batch.clear();
+    }
+}
+
+void TaskPipeline::apply(Command** first, Command** last) {
+    while (first != last) {
+        if ((*first)->kind != CommandKind::Bump) {
+            Command** segmentEnd = first;
+            while (segmentEnd != last && (*segmentEnd)->kind != CommandKind::Bump) {
+                ++segmentEnd;
+            }
+            applyByPerson(first, segmentEnd);
+            first = segmentEnd;
+            continue;
+        }
+
+        // a bump touches every person, so the commands around it are not moved across it
+        Command* command = *first;
+        try {
+            m_manager.bumpPriorityByType(command->types, command->amount);
+            std::get<std::promise<void>>(command->result).set_value();
+        }
+        catch (...) {
+            std::get<std::promise<void>>(command->result).set_exception(std::current_exception());
+        }
+        ++first;
+    }
+}
+
+void TaskPipeline::applyByPerson(Command** first, Command** last) {
+    // commands on different persons commute, so every person's commands are applied together, in their order -
+    // and the persons in the order of their first command, so new persons are added in the order they came
+    m_byPerson.clear();
+    for (Command** It = first; It != last; ++It) {
+        m_byPerson.push_back(It);
+    }
+    std::sort(m_byPerson.begin(), m_byPerson.end(), [](Command** a, Command** b) {
+        const int order = (*a)->personName.compare((*b)->personName);
+        return order < 0 || (order == 0 && a < b);
+    });
+    m_groups.clear();
+    for (std::size_t i = 0; i < m_byPerson.size(); ++i) {
+        if (i == 0 || (*m_byPerson[i])->personName != (*m_byPerson[i - 1])->personName) {
+            m_groups.push_back(i);
+        }
+    }
+    std::sort(m_groups.begin(), m_groups.end(), [this](std::size_t a, std::size_t b) {
+        return m_byPerson[a] < m_byPerson[b];
+    });
+
+    for (std::size_t groupStart : m_groups) {
+        const string& personName = (*m_byPerson[groupStart])->personName;
+        std::size_t i = groupStart;
+        while (i < m_byPerson.size() && (*m_byPerson[i])->personName == personName) {
+            Command* command = *m_byPerson[i];
+            if (command->kind == CommandKind::Complete) {
+                std::promise<int>& result = std::get<std::promise<int>>(command->result);
+                try {
+                    result.set_value(m_manager.completeTask(personName));
+                }
+                catch (...) {
+                    result.set_exception(std::current_exception());
+                }
+                ++i;
+                continue;
+            }
+
+            // a run of assigns - one assignTasks() call
+            const std::size_t runStart = i;
+            m_tasks.clear();
+            while (i < m_byPerson.size() && (*m_byPerson[i])->kind == CommandKind::Assign &&
+                   (*m_byPerson[i])->personName == personName) {
+                m_tasks.push_back((*m_byPerson[i])->task);
+                ++i;
+            }
+            try {
+                const int firstId = m_manager.assignTasks(personName, m_tasks);
+                for (std::size_t j = runStart; j < i; ++j) {
+                    std::get<std::promise<int>>((*m_byPerson[j])->result).set_value(firstId + int(j - runStart));
+                }
+            }
+            catch (...) {
+                for (std::size_t j = runStart; j < i; ++j) {
+                    std::get<std::promise<int>>((*m_byPerson[j])->result).set_exception(std::current_exception());
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <variant>
+#include <vector>
+
+#include "Task.h"
+#include "TaskManager.h"
+#include "TaskTypeSet.h"
+
+using std::string;
+
+/**
+ * @brief Asynchronous front-end of a TaskManager: any number of threads submit commands, and one owner thread
+ * applies them, in batches.
+ *
+ * Submitting is a lock-free push onto a multi-producer / single-consumer queue, and returns a future of the
+ * command's result. The owner thread takes up to a batch of commands at a time and applies them person by
+ * person: commands on different persons commute, so every person's commands in the batch are applied together,
+ * in the order they were queued, and a run of assigns to a person is one TaskManager::assignTasks call (one
+ * lookup, one lock, one merge). Bumps touch every person - nothing is moved across them. So the commands of
+ * one producer take effect in the order it submitted them, and a producer that assigns a task and then
+ * completes one sees its own assign. Task ids follow the order the commands are applied in.
+ *
+ * The TaskManager may still be read directly (stats, memory reports, prints, snapshots, searches) while the
+ * pipeline runs, since every reader takes the lock the owner thread's changes hold - but it should only be
+ * changed through the pipeline, or the batches interleave with the other changes.
+ */
+class TaskPipeline {
+    enum class CommandKind { Assign, Complete, Bump };
+
+    struct Command {
+        std::atomic<Command*> next{nullptr};
+        CommandKind kind = CommandKind::Assign;
+        string personName;
+        Task task{Task::MIN_PRIORITY, TaskType::General}; // Assign
+        TaskTypeSet types;         // Bump
+        int amount = 0;            // Bump
+        // the id given or completed for Assign and Complete, nothing for Bump
+        std::variant<std::promise<int>, std::promise<void>> result;
+    };
+
+    // how many times the owner finds the queue empty, yielding in between, before it goes to sleep
+    static constexpr int MAX_IDLE_ROUNDS = 64;
+
+    TaskManager& m_manager;
+    const int m_maxBatchSize;
+
+    // an intrusive linked queue: producers swap themselves in at m_newest, the owner pops after m_oldest,
+    // which is the last command it took (or a stub)
+    std::atomic<Command*> m_newest;
+    Command* m_oldest;
+
+    // the owner sleeps only when the queue is empty, and producers take the mutex only to wake it
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    std::atomic<bool> m_ownerWaiting{false};
+    std::atomic<bool> m_stopping{false};
+    std::thread m_owner;
+
+    // owner thread only - kept between batches so applying one allocates nothing of its own
+    std::vector<Command**> m_byPerson;
+    std::vector<std::size_t> m_groups; // where every person's commands start in m_byPerson
+    std::vector<Task> m_tasks;
+
+    void push(Command* command);
+    // the oldest queued command, or nullptr if there is none. owner thread only
+    Command* pop();
+    void run();
+    // applies commands [first, last) of a batch
+    void apply(Command** first, Command** last);
+    // applies commands with no bump among them, person by person
+    void applyByPerson(Command** first, Command** last);
+
+public:
+    /**
+     * @brief Starts the owner thread of a TaskManager.
+     *
+     * @param manager The TaskManager the commands are applied to - must outlive the pipeline.
+     * @param maxBatchSize The most commands applied in one batch (default is 256).
+     * @throws std::invalid_argument If maxBatchSize is not positive.
+     */
+    explicit TaskPipeline(TaskManager& manager, int maxBatchSize = 256);
+
+    /**
+     * @brief Applies every command submitted so far, then stops the owner thread.
+     */
+    ~TaskPipeline();
+
+    TaskPipeline(const TaskPipeline& other) = delete;
+    TaskPipeline& operator=(const TaskPipeline& other) = delete;
+
+    /**
+     * @brief Submits the assignment of a task to a person (see TaskManager::assignTask).
+     *
+     * @param personName The name of the person to whom the task will be assigned.
+     * @param task The task to be assigned.
+     * @return std::future<int> The id given to the task, or the exception the assign threw.
+     */
+    std::future<int> assignTask(const string& personName, const Task& task);
+
+    /**
+     * @brief Submits the completion of a person's highest priority task (see TaskManager::completeTask).
+     *
+     * @param personName The name of the person who will complete the task.
+     * @return std::future<int> The id of the completed task (-1 if there is no such person), or the exception
+     *                          the completion threw.
+     */
+    std::future<int> completeTask(const string& personName);
+
+    /**
+     * @brief Submits a bump of the priority of all tasks of some types (see TaskManager::bumpPriorityByType).
+     *
+     * @param types The types of tasks whose priority will be bumped.
+     * @param priority The amount by which the priority will be increased.
+     * @return std::future<void> Ready once the bump is applied.
+     */
+    std::future<void> bumpPriorityByType(TaskTypeSet types, int priority);
+};
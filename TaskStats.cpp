@@ -0,0 +1,94 @@
+#include "TaskStats.h"
+
+#include <algorithm>
+
+// Incremental updates
+void TaskStats::add(const Task& task) {
+    m_priorityHistogram[task.getPriority() - Task::MIN_PRIORITY]++;
+    m_typeCounts[static_cast<int>(task.getType())]++;
+    m_totalCount++;
+}
+
+void TaskStats::remove(const Task& task) {
+    m_priorityHistogram[task.getPriority() - Task::MIN_PRIORITY]--;
+    m_typeCounts[static_cast<int>(task.getType())]--;
+    m_totalCount--;
+}
+
+void TaskStats::changePriority(int oldPriority, int newPriority, int count) {
+    m_priorityHistogram[oldPriority - Task::MIN_PRIORITY] -= count;
+    m_priorityHistogram[newPriority - Task::MIN_PRIORITY] += count;
+}
+
+void TaskStats::changePriorities(int (&countsByPriority)[NUM_PRIORITIES], int amount) {
+    // from the end the tasks move toward, so no count is moved twice
+    for (int step = 0; step < NUM_PRIORITIES; ++step) {
+        const int oldPriority = (amount > 0) ? Task::MAX_PRIORITY - step : Task::MIN_PRIORITY + step;
+        const int newPriority = std::clamp(oldPriority + amount, Task::MIN_PRIORITY, Task::MAX_PRIORITY);
+        const int count = countsByPriority[oldPriority - Task::MIN_PRIORITY];
+        if (count > 0 && newPriority != oldPriority) {
+            changePriority(oldPriority, newPriority, count);
+            countsByPriority[newPriority - Task::MIN_PRIORITY] += count;
+            countsByPriority[oldPriority - Task::MIN_PRIORITY] = 0;
+        }
+    }
+}
+
+void TaskStats::add(const TaskStats& other) {
+    for (int i = 0; i < NUM_PRIORITIES; ++i) {
+        m_priorityHistogram[i] += other.m_priorityHistogram[i];
+    }
+    for (int i = 0; i < NUM_TASK_TYPES; ++i) {
+        m_typeCounts[i] += other.m_typeCounts[i];
+    }
+    m_totalCount += other.m_totalCount;
+}
+
+void TaskStats::remove(const TaskStats& other) {
+    for (int i = 0; i < NUM_PRIORITIES; ++i) {
+        m_priorityHistogram[i] -= other.m_priorityHistogram[i];
+    }
+    for (int i = 0; i < NUM_TASK_TYPES; ++i) {
+        m_typeCounts[i] -= other.m_typeCounts[i];
+    }
+    m_totalCount -= other.m_totalCount;
+}
+
+// Queries
+int TaskStats::getTotalCount() const {
+    return m_totalCount;
+}
+
+int TaskStats::getCountByPriority(int priority) const {
+    if (priority < Task::MIN_PRIORITY || priority > Task::MAX_PRIORITY) {
+        return 0;
+    }
+    return m_priorityHistogram[priority - Task::MIN_PRIORITY];
+}
+
+int TaskStats::getCountInPriorityRange(int minPriority, int maxPriority) const {
+    if (minPriority < Task::MIN_PRIORITY) {
+        minPriority = Task::MIN_PRIORITY;
+    }
+    if (maxPriority > Task::MAX_PRIORITY) {
+        maxPriority = Task::MAX_PRIORITY;
+    }
+    int count = 0;
+    for (int priority = minPriority; priority <= maxPriority; ++priority) {
+        count += m_priorityHistogram[priority - Task::MIN_PRIORITY];
+    }
+    return count;
+}
+
+int TaskStats::getCountByType(TaskType type) const {
+    return m_typeCounts[static_cast<int>(type)];
+}
+
+int TaskStats::getCountByType(TaskTypeSet types) const {
+    // every counter times its bit - no branch per type
+    int count = 0;
+    for (int i = 0; i < NUM_TASK_TYPES; ++i) {
+        count += m_typeCounts[i] * static_cast<int>((types.bits() >> i) & 1u);
+    }
+    return count;
+}
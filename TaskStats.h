@@ -0,0 +1,113 @@
+#pragma once
+
+#include "Task.h"
+#include "TaskTypeSet.h"
+
+/**
+ * @brief Aggregate counters over a set of tasks, kept up to date incrementally.
+ *
+ * Holds a histogram with one bucket per possible priority, a counter per TaskType and the total count,
+ * so questions like "how many Testing tasks" or "how many tasks with priority 80-100" are answered
+ * without iterating any task list.
+ */
+class TaskStats {
+public:
+    /**
+     * @brief Number of buckets in the priority histogram, one per possible priority.
+     */
+    static const int NUM_PRIORITIES = Task::MAX_PRIORITY - Task::MIN_PRIORITY + 1;
+
+private:
+    int m_priorityHistogram[NUM_PRIORITIES] = {};
+    int m_typeCounts[NUM_TASK_TYPES] = {};
+    int m_totalCount = 0;
+
+public:
+    /**
+     * @brief Counts a task that was added to the tracked set, in O(1).
+     *
+     * @param task The added task.
+     */
+    void add(const Task& task);
+
+    /**
+     * @brief Un-counts a task that was removed from the tracked set, in O(1).
+     *
+     * @param task The removed task.
+     */
+    void remove(const Task& task);
+
+    /**
+     * @brief Moves tasks between priority buckets after their priority changed, in O(1).
+     *
+     * @param oldPriority The priority of the tasks before the change.
+     * @param newPriority The priority of the tasks after the change.
+     * @param count The number of tasks that changed (default is one).
+     */
+    void changePriority(int oldPriority, int newPriority, int count = 1);
+
+    /**
+     * @brief Adds an amount to the priority of every task in a per-priority count, in O(NUM_PRIORITIES).
+     *
+     * The count is the histogram of one slice of the tracked tasks (e.g. one TaskType), and moves along with
+     * this one. The new priorities are clamped to [Task::MIN_PRIORITY, Task::MAX_PRIORITY] like any priority.
+     *
+     * @param countsByPriority The number of tasks per priority of the slice, from Task::MIN_PRIORITY - updated.
+     * @param amount The amount added to the priorities (may be negative).
+     */
+    void changePriorities(int (&countsByPriority)[NUM_PRIORITIES], int amount);
+
+    /**
+     * @brief Adds all counters of another TaskStats to this one.
+     *
+     * @param other The stats to be added.
+     */
+    void add(const TaskStats& other);
+
+    /**
+     * @brief Subtracts all counters of another TaskStats from this one.
+     *
+     * @param other The stats to be subtracted.
+     */
+    void remove(const TaskStats& other);
+
+    /**
+     * @brief Gets the number of tracked tasks.
+     *
+     * @return int The total number of tasks.
+     */
+    int getTotalCount() const;
+
+    /**
+     * @brief Gets the number of tracked tasks with a specific priority.
+     *
+     * @param priority The priority, in range [Task::MIN_PRIORITY, Task::MAX_PRIORITY].
+     * @return int The number of tasks with this priority (0 for an out of range priority).
+     */
+    int getCountByPriority(int priority) const;
+
+    /**
+     * @brief Gets the number of tracked tasks in a priority band.
+     *
+     * @param minPriority The lowest priority of the band (inclusive).
+     * @param maxPriority The highest priority of the band (inclusive).
+     * @return int The number of tasks with priority in [minPriority, maxPriority].
+     */
+    int getCountInPriorityRange(int minPriority, int maxPriority) const;
+
+    /**
+     * @brief Gets the number of tracked tasks of a specific type.
+     *
+     * @param type The type of the tasks.
+     * @return int The number of tasks of this type.
+     */
+    int getCountByType(TaskType type) const;
+
+    /**
+     * @brief Gets the number of tracked tasks of any of the given types, in one pass over the type counters.
+     *
+     * @param types The types of the tasks.
+     * @return int The number of tasks of these types.
+     */
+    int getCountByType(TaskTypeSet types) const;
+};
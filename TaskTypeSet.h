@@ -0,0 +1,115 @@
+#pragma once
+
+#include <initializer_list>
+
+#include "Task.h"
+
+/**
+ * @brief A set of task types, one bit per TaskType.
+ *
+ * Lets the queries, bumps and counts of TaskManager handle several types in one pass over the tasks, e.g.
+ *
+ *      manager.bumpPriorityByType({TaskType::Development, TaskType::Testing, TaskType::Maintenance}, 10);
+ *
+ * A single TaskType converts to a set of one, so every TaskTypeSet overload also takes a plain type.
+ * contains() is a shift and a mask, with no branch on the type.
+ */
+class TaskTypeSet {
+    unsigned int m_bits = 0;
+
+    static_assert(NUM_TASK_TYPES <= 32, "one bit per task type");
+
+    constexpr explicit TaskTypeSet(unsigned int bits) : m_bits(bits) {}
+
+public:
+    /**
+     * @brief Creates an empty set.
+     */
+    constexpr TaskTypeSet() = default;
+
+    /**
+     * @brief Creates a set of one type.
+     *
+     * @param type The type in the set.
+     */
+    constexpr TaskTypeSet(TaskType type) : m_bits(1u << static_cast<int>(type)) {}
+
+    /**
+     * @brief Creates a set of the given types.
+     *
+     * @param types The types in the set.
+     */
+    constexpr TaskTypeSet(std::initializer_list<TaskType> types);
+
+    /**
+     * @brief Gets the set of every type.
+     *
+     * @return TaskTypeSet All the task types.
+     */
+    static constexpr TaskTypeSet all();
+
+    /**
+     * @brief Checks whether a type is in the set, without branching.
+     *
+     * @param type The type to be checked.
+     * @return true If the type is in the set.
+     */
+    constexpr bool contains(TaskType type) const;
+
+    /**
+     * @brief Checks whether the set has no types.
+     *
+     * @return true If the set is empty.
+     */
+    constexpr bool empty() const;
+
+    /**
+     * @brief Gets the set as a mask, bit i standing for the TaskType with value i.
+     *
+     * @return unsigned int The bits of the set.
+     */
+    constexpr unsigned int bits() const;
+
+    constexpr TaskTypeSet operator|(TaskTypeSet other) const;
+    constexpr TaskTypeSet operator&(TaskTypeSet other) const;
+    constexpr bool operator==(TaskTypeSet other) const;
+    constexpr bool operator!=(TaskTypeSet other) const;
+};
+
+constexpr TaskTypeSet::TaskTypeSet(std::initializer_list<TaskType> types) {
+    for (TaskType type : types) {
+        m_bits |= 1u << static_cast<int>(type);
+    }
+}
+
+constexpr TaskTypeSet TaskTypeSet::all() {
+    return TaskTypeSet((1u << NUM_TASK_TYPES) - 1);
+}
+
+constexpr bool TaskTypeSet::contains(TaskType type) const {
+    return (m_bits >> static_cast<int>(type)) & 1u;
+}
+
+constexpr bool TaskTypeSet::empty() const {
+    return m_bits == 0;
+}
+
+constexpr unsigned int TaskTypeSet::bits() const {
+    return m_bits;
+}
+
+constexpr TaskTypeSet TaskTypeSet::operator|(TaskTypeSet other) const {
+    return TaskTypeSet(m_bits | other.m_bits);
+}
+
+constexpr TaskTypeSet TaskTypeSet::operator&(TaskTypeSet other) const {
+    return TaskTypeSet(m_bits & other.m_bits);
+}
+
+constexpr bool TaskTypeSet::operator==(TaskTypeSet other) const {
+    return m_bits == other.m_bits;
+}
+
+constexpr bool TaskTypeSet::operator!=(TaskTypeSet other) const {
+    return m_bits != other.m_bits;
+}
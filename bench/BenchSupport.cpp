@@ -0,0 +1,128 @@
+#include "BenchSupport.h"
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <new>
+#include <stdexcept>
+
+// ------------------------- global allocation counter ------------------------- //
+
+namespace {
+    std::atomic<std::size_t> g_allocations(0);
+    std::atomic<std::size_t> g_allocatedBytes(0);
+}
+
+void* operator new(std::size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* memory = std::malloc(size == 0 ? 1 : size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+namespace bench {
+
+    AllocationCounters allocationCounters() {
+        return AllocationCounters{g_allocations.load(std::memory_order_relaxed),
+                                  g_allocatedBytes.load(std::memory_order_relaxed)};
+    }
+
+    // -------------------------------- Result -------------------------------- //
+
+    double Result::opsPerSecond() const {
+        return seconds > 0 ? operations / seconds : 0;
+    }
+
+    double Result::nanosPerOp() const {
+        return operations > 0 ? seconds * 1e9 / operations : 0;
+    }
+
+    // -------------------------------- Options -------------------------------- //
+
+    bool Options::selected(const string& name) const {
+        return filter.empty() || name.find(filter) != string::npos;
+    }
+
+    long long Options::scaled(long long size) const {
+        const long long scaledSize = static_cast<long long>(size * scale);
+        return scaledSize > 0 ? scaledSize : 1;
+    }
+
+    Options parseOptions(int argc, char** argv) {
+        Options options;
+        for (int i = 1; i < argc; ++i) {
+            const string flag = argv[i];
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("missing value for " + flag);
+            }
+            const string value = argv[++i];
+            if (flag == "--scale") {
+                options.scale = std::stod(value);
+            }
+            else if (flag == "--seed") {
+                options.seed = static_cast<unsigned int>(std::stoul(value));
+            }
+            else if (flag == "--filter") {
+                options.filter = value;
+            }
+            else if (flag == "--json") {
+                options.jsonPath = value;
+            }
+            else if (flag == "--metrics") {
+                options.metricsPath = value;
+            }
+            else {
+                throw std::invalid_argument("unknown option " + flag);
+            }
+        }
+
+        return options;
+    }
+
+    // -------------------------------- output -------------------------------- //
+
+    void printResults(const std::vector<Result>& results, std::ostream& os) {
+        os << std::left << std::setw(50) << "workload" << std::right << std::setw(12) << "ops"
+           << std::setw(14) << "ops/sec" << std::setw(12) << "ns/op" << std::setw(12) << "allocs"
+           << std::setw(14) << "alloc bytes" << std::endl;
+        for (const Result& result : results) {
+            os << std::left << std::setw(50) << result.name << std::right << std::setw(12) << result.operations
+               << std::setw(14) << std::fixed << std::setprecision(0) << result.opsPerSecond()
+               << std::setw(12) << std::setprecision(1) << result.nanosPerOp()
+               << std::setw(12) << result.allocations << std::setw(14) << result.allocatedBytes << std::endl;
+        }
+    }
+
+    void writeJson(const string& benchmarkName, const Options& options, const std::vector<Result>& results,
+                   const string& path) {
+        std::ofstream file(path);
+        if (!file) {
+            throw std::runtime_error("cannot open " + path);
+        }
+
+        file << "{\n  \"benchmark\": \"" << benchmarkName << "\",\n  \"scale\": " << options.scale
+             << ",\n  \"seed\": " << options.seed << ",\n  \"results\": [\n";
+        for (std::size_t i = 0; i < results.size(); ++i) {
+            const Result& result = results[i];
+            file << "    {\"name\": \"" << result.name << "\", \"operations\": " << result.operations
+                 << ", \"seconds\": " << std::setprecision(9) << result.seconds
+                 << ", \"ops_per_sec\": " << result.opsPerSecond() << ", \"ns_per_op\": " << result.nanosPerOp()
+                 << ", \"allocations\": " << result.allocations << ", \"allocated_bytes\": "
+                 << result.allocatedBytes << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        file << "  ]\n}\n";
+    }
+
+}
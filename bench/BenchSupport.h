@@ -0,0 +1,94 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using std::string;
+
+/**
+ * Shared plumbing of the benchmark executables: a clock, a global allocation counter and a result
+ * table that can be printed for humans or written as JSON for diffing runs.
+ */
+namespace bench {
+
+    /**
+     * @brief Number of heap allocations and allocated bytes since the program started.
+     *
+     * Counted by the replacement global operator new in BenchSupport.cpp, so it covers every container.
+     */
+    struct AllocationCounters {
+        std::size_t allocations;
+        std::size_t bytes;
+    };
+
+    AllocationCounters allocationCounters();
+
+    /**
+     * @brief One measured workload.
+     */
+    struct Result {
+        string name;
+        long long operations;
+        double seconds;
+        std::size_t allocations;
+        std::size_t allocatedBytes;
+
+        double opsPerSecond() const;
+        double nanosPerOp() const;
+    };
+
+    /**
+     * @brief Runs a workload once and measures it.
+     *
+     * @param name The name the workload is reported under.
+     * @param operations The number of operations the workload performs, for the per-op numbers.
+     * @param workload The code to measure.
+     */
+    template <typename Workload>
+    Result measure(const string& name, long long operations, Workload workload);
+
+    /**
+     * @brief Command line options every benchmark understands.
+     *
+     * --scale <x>     multiplies every workload size (default 1)
+     * --seed <n>      seed of the workload generators (default 1234, fixed so runs are reproducible)
+     * --filter <str>  only runs workloads whose name contains str
+     * --json <file>   also writes the results as JSON to file
+     * --metrics <file> also dumps the collected hot-path metrics (needs -DTASKMANAGER_METRICS=ON)
+     */
+    struct Options {
+        double scale = 1;
+        unsigned int seed = 1234;
+        string filter;
+        string jsonPath;
+        string metricsPath;
+
+        bool selected(const string& name) const;
+        long long scaled(long long size) const;
+    };
+
+    Options parseOptions(int argc, char** argv);
+
+    void printResults(const std::vector<Result>& results, std::ostream& os = std::cout);
+
+    void writeJson(const string& benchmarkName, const Options& options, const std::vector<Result>& results,
+                   const string& path);
+
+    // ------------------------------- templates ------------------------------- //
+
+    template <typename Workload>
+    Result measure(const string& name, long long operations, Workload workload) {
+        const AllocationCounters before = allocationCounters();
+        const auto start = std::chrono::steady_clock::now();
+        workload();
+        const auto stop = std::chrono::steady_clock::now();
+        const AllocationCounters after = allocationCounters();
+
+        return Result{name, operations, std::chrono::duration<double>(stop - start).count(),
+                      after.allocations - before.allocations, after.bytes - before.bytes};
+    }
+
+}
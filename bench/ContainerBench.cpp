@@ -0,0 +1,501 @@
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <queue>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "BenchSupport.h"
+#include "../SortedList.h"
+#include "../Task.h"
+
+using mtm::SortedList;
+using std::vector;
+
+/**
+ * Baselines of SortedList against the standard containers a Person could keep its tasks in.
+ *
+ * Runs the same workloads on SortedList, std::multiset, std::priority_queue and a sorted std::vector, for int
+ * and Task elements and several sizes, then prints the usual result list and a table with one column per
+ * container (ns per element). Every container keeps its elements by operator>, highest first, like
+ * SortedList - so a Task list is ordered the way a Person orders its tasks.
+ *
+ *   insert     n inserts into an empty container
+ *   pop-max    n removals of the highest element
+ *   remove     n / 10 removals of given elements, found by value
+ *   filter     a new container of the elements a predicate keeps
+ *   apply      a new container of every element changed by an order-preserving function
+ *   iterate    a pass over every element, highest first
+ *
+ * A priority_queue can neither find an element nor go over its elements in order, so it has no remove and
+ * no iterate. Every workload is checked against the others: the elements popped, removed, filtered, changed
+ * or visited must come out the same, in the same order, from every container.
+ */
+
+namespace {
+
+    template <typename T>
+    struct Greater {
+        bool operator()(const T& lhs, const T& rhs) const { return lhs > rhs; }
+    };
+
+    // from operator> alone, like SortedList
+    template <typename T>
+    struct Less {
+        bool operator()(const T& lhs, const T& rhs) const { return rhs > lhs; }
+    };
+
+    template <typename T>
+    bool equivalent(const T& lhs, const T& rhs) {
+        return !(lhs > rhs) && !(rhs > lhs);
+    }
+
+    // ------------------------------- element types ------------------------------- //
+
+    template <typename T>
+    struct Elements;
+
+    template <>
+    struct Elements<int> {
+        static constexpr const char* NAME = "int";
+
+        static vector<int> generate(std::mt19937& generator, long long size) {
+            vector<int> values;
+            for (long long i = 0; i < size; ++i) {
+                values.push_back(std::uniform_int_distribution<int>(0, 1000000)(generator));
+            }
+            return values;
+        }
+
+        static bool keep(int value) { return value % 2 == 0; }
+        static int change(int value) { return value + 1; }
+        static unsigned long long key(int value) { return static_cast<unsigned long long>(value); }
+    };
+
+    template <>
+    struct Elements<Task> {
+        static constexpr const char* NAME = "Task";
+
+        // unique ids, so no two tasks are equivalent - like the tasks of a TaskManager
+        static vector<Task> generate(std::mt19937& generator, long long size) {
+            vector<Task> tasks;
+            for (long long i = 0; i < size; ++i) {
+                std::uniform_int_distribution<int> priority(Task::MIN_PRIORITY, Task::MAX_PRIORITY);
+                std::uniform_int_distribution<int> type(0, NUM_TASK_TYPES - 1);
+                Task task(priority(generator), static_cast<TaskType>(type(generator)), "benchmark task");
+                task.setId(static_cast<int>(i));
+                tasks.push_back(task);
+            }
+            return tasks;
+        }
+
+        static bool keep(const Task& task) { return task.getPriority() % 2 == 0; }
+
+        // a new id of the same rank keeps the order
+        static Task change(const Task& task) {
+            Task changed = task;
+            changed.setId(task.getId() * 2);
+            return changed;
+        }
+
+        static unsigned long long key(const Task& task) { return static_cast<unsigned long long>(task.getId()); }
+    };
+
+    // ------------------------------- containers ------------------------------- //
+
+    template <typename T>
+    class SortedListContainer {
+        SortedList<T> m_list;
+
+    public:
+        static constexpr const char* NAME = "SortedList";
+        static constexpr bool ORDERED = true;
+
+        int size() const { return m_list.length(); }
+
+        void insert(const T& value) { m_list.insert(value); }
+
+        T popMax() {
+            const T top = *m_list.begin();
+            m_list.remove(m_list.begin());
+            return top;
+        }
+
+        bool remove(const T& value) {
+            for (auto it = m_list.begin(); it != m_list.end(); ++it) {
+                if (equivalent(*it, value)) {
+                    m_list.remove(it);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        template <typename Function>
+        SortedListContainer filter(Function function) const {
+            SortedListContainer result;
+            result.m_list = m_list.filter(function);
+            return result;
+        }
+
+        template <typename Function>
+        SortedListContainer apply(Function function) const {
+            SortedListContainer result;
+            result.m_list = m_list.apply(function);
+            return result;
+        }
+
+        template <typename Function>
+        void forEach(Function function) const {
+            for (const T& value : m_list) {
+                function(value);
+            }
+        }
+    };
+
+    template <typename T>
+    class MultisetContainer {
+        std::multiset<T, Greater<T>> m_set;
+
+    public:
+        static constexpr const char* NAME = "std::multiset";
+        static constexpr bool ORDERED = true;
+
+        int size() const { return static_cast<int>(m_set.size()); }
+
+        void insert(const T& value) { m_set.insert(value); }
+
+        T popMax() {
+            const T top = *m_set.begin();
+            m_set.erase(m_set.begin());
+            return top;
+        }
+
+        bool remove(const T& value) {
+            const auto it = m_set.find(value);
+            if (it == m_set.end()) {
+                return false;
+            }
+            m_set.erase(it);
+            return true;
+        }
+
+        // the results come in order, so every insert is hinted at the end
+        template <typename Function>
+        MultisetContainer filter(Function function) const {
+            MultisetContainer result;
+            for (const T& value : m_set) {
+                if (function(value)) {
+                    result.m_set.insert(result.m_set.end(), value);
+                }
+            }
+            return result;
+        }
+
+        template <typename Function>
+        MultisetContainer apply(Function function) const {
+            MultisetContainer result;
+            for (const T& value : m_set) {
+                result.m_set.insert(result.m_set.end(), function(value));
+            }
+            return result;
+        }
+
+        template <typename Function>
+        void forEach(Function function) const {
+            for (const T& value : m_set) {
+                function(value);
+            }
+        }
+    };
+
+    template <typename T>
+    class PriorityQueueContainer {
+        // the heap underneath, for filter and apply - a priority_queue only shows its top
+        struct Queue : std::priority_queue<T, vector<T>, Less<T>> {
+            using std::priority_queue<T, vector<T>, Less<T>>::c;
+        };
+
+        Queue m_queue;
+
+        // heapifies in O(n), like priority_queue's own range constructor
+        static PriorityQueueContainer fromHeapless(vector<T>&& values) {
+            PriorityQueueContainer result;
+            result.m_queue.c = std::move(values);
+            std::make_heap(result.m_queue.c.begin(), result.m_queue.c.end(), Less<T>());
+            return result;
+        }
+
+    public:
+        static constexpr const char* NAME = "std::priority_queue";
+        static constexpr bool ORDERED = false;
+
+        int size() const { return static_cast<int>(m_queue.size()); }
+
+        void insert(const T& value) { m_queue.push(value); }
+
+        T popMax() {
+            const T top = m_queue.top();
+            m_queue.pop();
+            return top;
+        }
+
+        template <typename Function>
+        PriorityQueueContainer filter(Function function) const {
+            vector<T> values;
+            std::copy_if(m_queue.c.begin(), m_queue.c.end(), std::back_inserter(values), function);
+            return fromHeapless(std::move(values));
+        }
+
+        template <typename Function>
+        PriorityQueueContainer apply(Function function) const {
+            vector<T> values;
+            values.reserve(m_queue.c.size());
+            std::transform(m_queue.c.begin(), m_queue.c.end(), std::back_inserter(values), function);
+            return fromHeapless(std::move(values));
+        }
+    };
+
+    // lowest first, so the highest is popped from the back in O(1)
+    template <typename T>
+    class SortedVectorContainer {
+        vector<T> m_values;
+
+    public:
+        static constexpr const char* NAME = "sorted std::vector";
+        static constexpr bool ORDERED = true;
+
+        int size() const { return static_cast<int>(m_values.size()); }
+
+        void insert(const T& value) {
+            m_values.insert(std::upper_bound(m_values.begin(), m_values.end(), value, Less<T>()), value);
+        }
+
+        T popMax() {
+            const T top = m_values.back();
+            m_values.pop_back();
+            return top;
+        }
+
+        bool remove(const T& value) {
+            const auto it = std::lower_bound(m_values.begin(), m_values.end(), value, Less<T>());
+            if (it == m_values.end() || !equivalent(*it, value)) {
+                return false;
+            }
+            m_values.erase(it);
+            return true;
+        }
+
+        template <typename Function>
+        SortedVectorContainer filter(Function function) const {
+            SortedVectorContainer result;
+            std::copy_if(m_values.begin(), m_values.end(), std::back_inserter(result.m_values), function);
+            return result;
+        }
+
+        // sorts again only if the function broke the order, like SortedList::apply
+        template <typename Function>
+        SortedVectorContainer apply(Function function) const {
+            SortedVectorContainer result;
+            result.m_values.reserve(m_values.size());
+            std::transform(m_values.begin(), m_values.end(), std::back_inserter(result.m_values), function);
+            if (!std::is_sorted(result.m_values.begin(), result.m_values.end(), Less<T>())) {
+                std::sort(result.m_values.begin(), result.m_values.end(), Less<T>());
+            }
+            return result;
+        }
+
+        template <typename Function>
+        void forEach(Function function) const {
+            std::for_each(m_values.rbegin(), m_values.rend(), function);
+        }
+    };
+
+    // ------------------------------- workloads ------------------------------- //
+
+    // what every workload produced, by workload - the containers must agree
+    class Checksums {
+        std::map<string, unsigned long long> m_expected;
+
+    public:
+        void check(const string& workload, const char* container, unsigned long long checksum) {
+            const auto inserted = m_expected.emplace(workload, checksum);
+            if (!inserted.second && inserted.first->second != checksum) {
+                throw std::logic_error(string(container) + " disagrees with the other containers on " + workload);
+            }
+        }
+    };
+
+    // order-sensitive
+    void mix(unsigned long long& checksum, unsigned long long key) {
+        checksum = checksum * 1000003 + key;
+    }
+
+    // pops every element, highest first - outside the measured regions
+    template <typename Traits, typename Container>
+    unsigned long long drain(Container& container) {
+        unsigned long long checksum = 0;
+        while (container.size() > 0) {
+            mix(checksum, Traits::key(container.popMax()));
+        }
+        return checksum;
+    }
+
+    template <template <typename> class Container, typename T>
+    void benchContainer(const bench::Options& options, const vector<T>& values, long long rounds,
+                        Checksums& checksums, vector<bench::Result>& results) {
+        using Traits = Elements<T>;
+        const long long size = static_cast<long long>(values.size());
+        const string prefix = string(Traits::NAME) + "/" + std::to_string(size) + "/";
+        const char* const container = Container<T>::NAME;
+        const auto selected = [&](const string& workload) {
+            return options.selected(prefix + workload + "/" + container);
+        };
+        const auto measure = [&](const string& workload, long long operations, auto body) {
+            results.push_back(bench::measure(prefix + workload + "/" + container, operations, body));
+        };
+
+        Container<T> filled;
+        const auto fill = [&]() {
+            for (const T& value : values) {
+                filled.insert(value);
+            }
+        };
+        if (selected("insert")) {
+            measure("insert", size, fill);
+        }
+        else {
+            fill();
+        }
+
+        if (selected("filter")) {
+            measure("filter", size * rounds, [&]() {
+                for (long long round = 0; round < rounds; ++round) {
+                    Container<T> kept = filled.filter([](const T& value) { return Traits::keep(value); });
+                }
+            });
+            Container<T> kept = filled.filter([](const T& value) { return Traits::keep(value); });
+            checksums.check(prefix + "filter", container, drain<Traits>(kept));
+        }
+
+        if (selected("apply")) {
+            measure("apply", size * rounds, [&]() {
+                for (long long round = 0; round < rounds; ++round) {
+                    Container<T> changed = filled.apply([](const T& value) { return Traits::change(value); });
+                }
+            });
+            Container<T> changed = filled.apply([](const T& value) { return Traits::change(value); });
+            checksums.check(prefix + "apply", container, drain<Traits>(changed));
+        }
+
+        // a priority_queue can neither go over its elements in order nor find one
+        if constexpr (Container<T>::ORDERED) {
+            if (selected("iterate")) {
+                unsigned long long checksum = 0;
+                measure("iterate", size * rounds, [&]() {
+                    for (long long round = 0; round < rounds; ++round) {
+                        filled.forEach([&](const T& value) { mix(checksum, Traits::key(value)); });
+                    }
+                });
+                checksums.check(prefix + "iterate", container, checksum);
+            }
+
+            if (selected("remove")) {
+                const long long numOfRemoved = size / 10;
+                Container<T> copy = filled;
+                measure("remove", numOfRemoved, [&]() {
+                    for (long long i = 0; i < numOfRemoved; ++i) {
+                        copy.remove(values[i * 10]);
+                    }
+                });
+                checksums.check(prefix + "remove", container, drain<Traits>(copy));
+            }
+        }
+
+        if (selected("pop-max")) {
+            unsigned long long checksum = 0;
+            measure("pop-max", size, [&]() {
+                for (long long i = 0; i < size; ++i) {
+                    mix(checksum, Traits::key(filled.popMax()));
+                }
+            });
+            checksums.check(prefix + "pop-max", container, checksum);
+        }
+    }
+
+    template <typename T>
+    void benchElements(const bench::Options& options, vector<bench::Result>& results) {
+        for (long long baseSize : {1000, 10000, 50000}) {
+            std::mt19937 generator(options.seed);
+            const vector<T> values = Elements<T>::generate(generator, options.scaled(baseSize));
+            // every filter, apply and iterate workload touches about 2 million elements
+            const long long rounds = std::max<long long>(1, 2000000 / std::max<long long>(1, values.size()));
+            Checksums checksums;
+            benchContainer<SortedListContainer>(options, values, rounds, checksums, results);
+            benchContainer<MultisetContainer>(options, values, rounds, checksums, results);
+            benchContainer<PriorityQueueContainer>(options, values, rounds, checksums, results);
+            benchContainer<SortedVectorContainer>(options, values, rounds, checksums, results);
+        }
+    }
+
+    // one row per workload, one ns/op column per container
+    void printTable(const vector<bench::Result>& results, std::ostream& os) {
+        const vector<string> containers = {SortedListContainer<int>::NAME, MultisetContainer<int>::NAME,
+                                           PriorityQueueContainer<int>::NAME, SortedVectorContainer<int>::NAME};
+        vector<string> workloads;
+        std::map<string, std::map<string, double>> nanos;
+        for (const bench::Result& result : results) {
+            const std::size_t split = result.name.rfind('/');
+            const string workload = result.name.substr(0, split);
+            if (nanos.find(workload) == nanos.end()) {
+                workloads.push_back(workload);
+            }
+            nanos[workload][result.name.substr(split + 1)] = result.nanosPerOp();
+        }
+
+        os << std::endl << std::left << std::setw(26) << "ns/op" << std::right;
+        for (const string& container : containers) {
+            os << std::setw(22) << container;
+        }
+        os << std::endl;
+        for (const string& workload : workloads) {
+            os << std::left << std::setw(26) << workload << std::right << std::fixed << std::setprecision(1);
+            for (const string& container : containers) {
+                const auto it = nanos[workload].find(container);
+                if (it == nanos[workload].end()) {
+                    os << std::setw(22) << "-";
+                }
+                else {
+                    os << std::setw(22) << it->second;
+                }
+            }
+            os << std::endl;
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    try {
+        const bench::Options options = bench::parseOptions(argc, argv);
+        vector<bench::Result> results;
+        benchElements<int>(options, results);
+        benchElements<Task>(options, results);
+
+        bench::printResults(results);
+        printTable(results, std::cout);
+        if (!options.jsonPath.empty()) {
+            bench::writeJson("taskmanager_container_bench", options, results, options.jsonPath);
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "taskmanager_container_bench: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
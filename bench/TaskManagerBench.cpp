@@ -0,0 +1,623 @@
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "BenchSupport.h"
+#include "../BlockSearch.h"
+#include "../Metrics.h"
+#include "../SharedTaskStore.h"
+#include "../SortedList.h"
+#include "../TaskManager.h"
+#include "../TaskPipeline.h"
+
+using mtm::SortedList;
+using std::vector;
+
+/**
+ * Microbenchmarks of SortedList and TaskManager.
+ *
+ * Every workload is generated up front from a fixed seed, so two runs with the same options measure exactly
+ * the same operations, and only the operations themselves are inside the measured region.
+ */
+
+namespace {
+
+    enum class PriorityDistribution { Uniform, Skewed };
+    enum class OperationKind { Assign, Complete, Bump };
+
+    struct Operation {
+        OperationKind kind;
+        int person;
+        int priority;
+        TaskType type;
+    };
+
+    // uniform draws every priority equally, skewed puts most tasks in a few low priorities (like real backlogs)
+    int drawPriority(std::mt19937& generator, PriorityDistribution distribution) {
+        if (distribution == PriorityDistribution::Uniform) {
+            return std::uniform_int_distribution<int>(Task::MIN_PRIORITY, Task::MAX_PRIORITY)(generator);
+        }
+        const int priority = std::geometric_distribution<int>(0.15)(generator);
+        return priority > Task::MAX_PRIORITY ? Task::MAX_PRIORITY : priority;
+    }
+
+    TaskType drawType(std::mt19937& generator) {
+        return static_cast<TaskType>(std::uniform_int_distribution<int>(0, NUM_TASK_TYPES - 1)(generator));
+    }
+
+    // percentages of the operation mix, the rest are assigns
+    vector<Operation> generateOperations(std::mt19937& generator, long long count, int persons,
+                                         PriorityDistribution distribution, int completePercent, int bumpPercent) {
+        vector<Operation> operations;
+        operations.reserve(count);
+        std::uniform_int_distribution<int> percent(0, 99);
+        std::uniform_int_distribution<int> person(0, persons - 1);
+        for (long long i = 0; i < count; ++i) {
+            const int roll = percent(generator);
+            OperationKind kind = OperationKind::Assign;
+            if (roll < completePercent) {
+                kind = OperationKind::Complete;
+            }
+            else if (roll < completePercent + bumpPercent) {
+                kind = OperationKind::Bump;
+            }
+            const int bumpAmount = std::uniform_int_distribution<int>(1, 5)(generator);
+            operations.push_back(Operation{kind, person(generator),
+                                           kind == OperationKind::Bump ? bumpAmount
+                                                                       : drawPriority(generator, distribution),
+                                           drawType(generator)});
+        }
+
+        return operations;
+    }
+
+    void runOperations(TaskManager& manager, const vector<string>& names, const vector<Operation>& operations) {
+        for (const Operation& operation : operations) {
+            switch (operation.kind) {
+            case OperationKind::Assign:
+                manager.assignTask(names[operation.person], Task(operation.priority, operation.type));
+                break;
+            case OperationKind::Complete:
+                if (manager.stats(names[operation.person]).getTotalCount() > 0) {
+                    manager.completeTask(names[operation.person]);
+                }
+                break;
+            case OperationKind::Bump:
+                manager.bumpPriorityByType(operation.type, operation.priority);
+                break;
+            }
+        }
+    }
+
+    // ---------------------------- SortedList workloads ---------------------------- //
+
+    void benchSortedList(const bench::Options& options, vector<bench::Result>& results) {
+        std::mt19937 generator(options.seed);
+        const long long size = options.scaled(20000);
+        vector<int> values;
+        values.reserve(size);
+        for (long long i = 0; i < size; ++i) {
+            values.push_back(std::uniform_int_distribution<int>(0, 1000000)(generator));
+        }
+
+        SortedList<int> list;
+        if (options.selected("SortedList<int>/insert")) {
+            results.push_back(bench::measure("SortedList<int>/insert", size, [&]() {
+                for (int value : values) {
+                    list.insert(value);
+                }
+            }));
+        }
+        else {
+            for (int value : values) {
+                list.insert(value);
+            }
+        }
+
+        const int rounds = 20;
+        if (options.selected("SortedList<int>/filter")) {
+            results.push_back(bench::measure("SortedList<int>/filter", size * rounds, [&]() {
+                for (int i = 0; i < rounds; ++i) {
+                    SortedList<int> evens = list.filter([](int x) { return x % 2 == 0; });
+                }
+            }));
+        }
+
+        if (options.selected("SortedList<int>/apply order-preserving")) {
+            results.push_back(bench::measure("SortedList<int>/apply order-preserving", size * rounds, [&]() {
+                for (int i = 0; i < rounds; ++i) {
+                    SortedList<int> shifted = list.apply([](int x) { return x + 1; });
+                }
+            }));
+        }
+
+        // scrambles the order, so every insert of the new list searches for its place
+        const long long scrambleSize = size / 4;
+        if (options.selected("SortedList<int>/apply scrambling")) {
+            SortedList<int> smallList;
+            for (long long i = 0; i < scrambleSize; ++i) {
+                smallList.insert(values[i]);
+            }
+            results.push_back(bench::measure("SortedList<int>/apply scrambling", scrambleSize, [&]() {
+                SortedList<int> scrambled = smallList.apply([](int x) { return (x * 7919) % 1000003; });
+            }));
+        }
+
+        if (options.selected("SortedList<int>/remove head")) {
+            results.push_back(bench::measure("SortedList<int>/remove head", size, [&]() {
+                while (list.length() > 0) {
+                    list.remove(list.begin());
+                }
+            }));
+        }
+    }
+
+    // ------------------------- SortedList block search ------------------------- //
+
+    // the same int, but not trivially copyable - so the list keeps the linked node-per-element layout
+    struct LinkedInt {
+        int value;
+
+        LinkedInt(int value) : value(value) {}
+        LinkedInt(const LinkedInt& other) : value(other.value) {}
+
+        bool operator>(const LinkedInt& other) const { return value > other.value; }
+    };
+
+    // inserts into lists of a few hundred keys, where the search inside a block is most of the work
+    void benchBlockSearch(const bench::Options& options, vector<bench::Result>& results) {
+        std::mt19937 generator(options.seed);
+        const long long size = options.scaled(200000);
+        const int listLength = 512;
+        vector<int> values;
+        values.reserve(size);
+        for (long long i = 0; i < size; ++i) {
+            values.push_back(std::uniform_int_distribution<int>(0, 1000000)(generator));
+        }
+
+        const mtm::blocksearch::Isa detected = mtm::blocksearch::detectIsa();
+        for (int level = 0; level <= static_cast<int>(detected); ++level) {
+            const mtm::blocksearch::Isa isa = static_cast<mtm::blocksearch::Isa>(level);
+            const string name = string("SortedList<int>/insert 512, unrolled ") + mtm::blocksearch::isaName(isa);
+            if (!options.selected(name)) {
+                continue;
+            }
+            mtm::blocksearch::setActiveIsa(isa);
+            results.push_back(bench::measure(name, size, [&]() {
+                for (long long start = 0; start < size; start += listLength) {
+                    SortedList<int> list;
+                    for (long long i = start; i < start + listLength && i < size; ++i) {
+                        list.insert(values[i]);
+                    }
+                }
+            }));
+        }
+        mtm::blocksearch::setActiveIsa(detected);
+
+        if (options.selected("SortedList<int>/insert 512, linked")) {
+            results.push_back(bench::measure("SortedList<int>/insert 512, linked", size, [&]() {
+                for (long long start = 0; start < size; start += listLength) {
+                    SortedList<LinkedInt> list;
+                    for (long long i = start; i < start + listLength && i < size; ++i) {
+                        list.insert(LinkedInt(values[i]));
+                    }
+                }
+            }));
+        }
+    }
+
+    // ---------------------------- TaskManager workloads ---------------------------- //
+
+    void benchTaskManager(const bench::Options& options, vector<bench::Result>& results) {
+        struct Mix {
+            const char* name;
+            int completePercent;
+            int bumpPercent;
+            long long operations;
+        };
+        const Mix mixes[] = {
+            {"assign-only", 0, 0, 20000},
+            {"complete-heavy", 45, 0, 40000},
+            {"bump-heavy", 5, 5, 4000},
+        };
+        const struct {
+            const char* name;
+            PriorityDistribution distribution;
+        } distributions[] = {{"uniform", PriorityDistribution::Uniform}, {"skewed", PriorityDistribution::Skewed}};
+        const struct {
+            const char* name;
+            int persons;
+        } teams[] = {{"many-persons", 10}, {"few-persons", 2}};
+        const struct {
+            const char* suffix;
+            TaskStorage storage;
+        } storages[] = {{"", TaskStorage::List}, {"/buckets", TaskStorage::Buckets}};
+
+        for (const auto& team : teams) {
+            vector<string> names;
+            for (int i = 0; i < team.persons; ++i) {
+                names.push_back("person" + std::to_string(i));
+            }
+            for (const auto& distribution : distributions) {
+                for (const Mix& mix : mixes) {
+                    for (const auto& storage : storages) {
+                        const string name = string("TaskManager/") + mix.name + "/" + distribution.name + "/" +
+                                            team.name + storage.suffix;
+                        if (!options.selected(name)) {
+                            continue;
+                        }
+
+                        std::mt19937 generator(options.seed);
+                        const long long count = options.scaled(mix.operations);
+                        const vector<Operation> operations = generateOperations(generator, count, team.persons,
+                                                                                distribution.distribution,
+                                                                                mix.completePercent, mix.bumpPercent);
+                        TaskManager manager(team.persons, storage.storage);
+                        results.push_back(bench::measure(name, count, [&]() {
+                            runOperations(manager, names, operations);
+                        }));
+                    }
+                }
+            }
+        }
+    }
+
+    // ------------------------------- bounded persons ------------------------------- //
+
+    // a long stream of assigns to persons capped at a few hundred tasks, each assign past the cap evicting the
+    // lowest task. compare with TaskManager/assign-only, whose lists grow with every assign
+    void benchCapacity(const bench::Options& options, vector<bench::Result>& results) {
+        const int capacities[] = {64, 512};
+        const int persons = 10;
+        for (int capacity : capacities) {
+            const string name = "TaskManager/assign-only/uniform/capacity " + std::to_string(capacity);
+            if (!options.selected(name)) {
+                continue;
+            }
+
+            std::mt19937 generator(options.seed);
+            const long long count = options.scaled(200000);
+            const vector<Operation> operations = generateOperations(generator, count, persons,
+                                                                    PriorityDistribution::Uniform, 0, 0);
+            vector<string> names;
+            for (int i = 0; i < persons; ++i) {
+                names.push_back("person" + std::to_string(i));
+            }
+            TaskManager manager(persons);
+            long long evictions = 0;
+            manager.setEvictionCallback([&evictions](const string&, const Task&) { evictions++; });
+            for (const string& personName : names) {
+                manager.setPersonCapacity(personName, capacity);
+            }
+            results.push_back(bench::measure(name, count, [&]() {
+                runOperations(manager, names, operations);
+            }));
+            std::cerr << name << ": " << evictions << " evictions, " << manager.memoryUsage().total()
+                      << " bytes held" << std::endl;
+        }
+    }
+
+    // ------------------------------- shared memory ------------------------------- //
+
+    // the cost of keeping a shared-memory copy next to the TaskManager, and of reading it from the outside
+    void benchSharedMemory(const bench::Options& options, vector<bench::Result>& results) {
+        const int persons = 10;
+        vector<string> names;
+        for (int i = 0; i < persons; ++i) {
+            names.push_back("person" + std::to_string(i));
+        }
+        const string segmentName = "/taskmanager_bench_" + std::to_string(getpid());
+        for (bool shared : {false, true}) {
+            const string name = string("TaskManager/complete-heavy/uniform/buckets") + (shared ? "/shared memory" : "");
+            if (!options.selected(name)) {
+                continue;
+            }
+
+            std::mt19937 generator(options.seed);
+            const long long count = options.scaled(200000);
+            const vector<Operation> operations = generateOperations(generator, count, persons,
+                                                                    PriorityDistribution::Uniform, 45, 0);
+            TaskManager manager(persons, TaskStorage::Buckets);
+            if (shared) {
+                manager.enableSharedMemory(segmentName, std::size_t(64) << 20);
+            }
+            results.push_back(bench::measure(name, count, [&]() {
+                runOperations(manager, names, operations);
+            }));
+            if (!shared) {
+                continue;
+            }
+
+            // every person's tasks, copied out by another reader of the segment
+            const string readName = name + "/read all";
+            if (options.selected(readName)) {
+                SharedTaskReader reader(segmentName);
+                const long long reads = options.scaled(200);
+                results.push_back(bench::measure(readName, reads, [&]() {
+                    for (long long i = 0; i < reads; ++i) {
+                        reader.read();
+                    }
+                }));
+            }
+        }
+    }
+
+    // ------------------------------- command pipeline ------------------------------- //
+
+    // producers on 4 threads assigning and completing - straight into the TaskManager, where they take turns on
+    // its lock, or through a TaskPipeline, whose owner thread applies their commands in batches
+    void benchPipeline(const bench::Options& options, vector<bench::Result>& results) {
+        const int numOfProducers = 4;
+        const int persons = 10;
+        for (bool pipelined : {false, true}) {
+            const string name = string("TaskManager/assign+complete/4 producers/") +
+                                (pipelined ? "pipeline" : "direct");
+            if (!options.selected(name)) {
+                continue;
+            }
+
+            const long long count = options.scaled(100000);
+            vector<vector<Operation>> operations;
+            for (int producer = 0; producer < numOfProducers; ++producer) {
+                std::mt19937 generator(options.seed + producer);
+                operations.push_back(generateOperations(generator, count / numOfProducers, persons,
+                                                        PriorityDistribution::Uniform, 20, 0));
+            }
+            vector<string> names;
+            for (int i = 0; i < persons; ++i) {
+                names.push_back("person" + std::to_string(i));
+            }
+            TaskManager manager(persons, TaskStorage::Buckets);
+            for (const string& personName : names) {
+                manager.assignTask(personName, Task(0, TaskType::General)); // and everyone is there
+            }
+
+            results.push_back(bench::measure(name, count, [&]() {
+                std::unique_ptr<TaskPipeline> pipeline;
+                if (pipelined) {
+                    pipeline = std::make_unique<TaskPipeline>(manager);
+                }
+                vector<std::thread> producers;
+                for (int producer = 0; producer < numOfProducers; ++producer) {
+                    producers.emplace_back([&, producer]() {
+                        if (!pipelined) {
+                            runOperations(manager, names, operations[producer]);
+                            return;
+                        }
+                        vector<std::future<int>> pending;
+                        pending.reserve(operations[producer].size());
+                        for (const Operation& operation : operations[producer]) {
+                            if (operation.kind == OperationKind::Assign) {
+                                pending.push_back(pipeline->assignTask(names[operation.person],
+                                                                       Task(operation.priority, operation.type)));
+                            }
+                            else {
+                                pending.push_back(pipeline->completeTask(names[operation.person]));
+                            }
+                        }
+                        for (std::future<int>& result : pending) {
+                            try {
+                                result.get();
+                            }
+                            catch (const std::runtime_error&) {
+                                // a person with no tasks left, like the stats check in runOperations
+                            }
+                        }
+                    });
+                }
+                for (std::thread& producer : producers) {
+                    producer.join();
+                }
+            }));
+        }
+    }
+
+    // ---------------------------------- rebalance ---------------------------------- //
+
+    // 10k persons, a quarter of them holding most of the tasks. --scale 10 gives the 10M task case
+    void benchRebalance(const bench::Options& options, vector<bench::Result>& results) {
+        const struct {
+            const char* name;
+            RebalanceMeasure measure;
+            bool perTaskType;
+        } policies[] = {
+            {"task count", RebalanceMeasure::TaskCount, false},
+            {"priority sum", RebalanceMeasure::PrioritySum, false},
+            {"count per type", RebalanceMeasure::TaskCount, true},
+        };
+
+        const int persons = 10000;
+        const long long count = options.scaled(1000000);
+        for (const auto& policy : policies) {
+            const string name = string("TaskManager/rebalance/") + policy.name + "/10k persons";
+            if (!options.selected(name)) {
+                continue;
+            }
+
+            std::mt19937 generator(options.seed);
+            vector<Operation> operations = generateOperations(generator, count, persons, PriorityDistribution::Uniform,
+                                                              0, 0);
+            std::uniform_real_distribution<double> unit(0, 1);
+            for (Operation& operation : operations) {
+                const double skew = unit(generator);
+                operation.person = static_cast<int>(persons * skew * skew * skew * skew);
+            }
+            // assigned from the highest priority down, every insert lands at the tail - the setup stays linear
+            std::sort(operations.begin(), operations.end(), [](const Operation& a, const Operation& b) {
+                return a.priority > b.priority;
+            });
+            vector<string> names;
+            for (int i = 0; i < persons; ++i) {
+                names.push_back("person" + std::to_string(i));
+            }
+            TaskManager manager(persons);
+            runOperations(manager, names, operations);
+            for (const string& personName : names) {
+                manager.assignTask(personName, Task(0, TaskType::General)); // and everyone is there
+            }
+
+            RebalancePolicy rebalancePolicy;
+            rebalancePolicy.measure = policy.measure;
+            rebalancePolicy.perTaskType = policy.perTaskType;
+            RebalanceReport report;
+            results.push_back(bench::measure(name, count, [&]() {
+                report = manager.rebalance(rebalancePolicy);
+            }));
+            std::cerr << name << ": moved " << report.tasksMoved << " tasks, highest load " << report.maxLoadBefore
+                      << " -> " << report.maxLoadAfter << std::endl;
+        }
+    }
+
+    // ------------------------------ description search ------------------------------ //
+
+    // 1M tasks whose descriptions draw a few words from a vocabulary where a few words are common and most
+    // are rare, like real ones. --scale changes the number of tasks
+    void benchDescriptionSearch(const bench::Options& options, vector<bench::Result>& results) {
+        const bool indexed = options.selected("TaskManager/searchDescriptions/indexed");
+        const bool scanned = options.selected("TaskManager/searchDescriptions/scan");
+        if (!indexed && !scanned) {
+            return;
+        }
+
+        std::mt19937 generator(options.seed);
+        const int vocabularySize = 20000;
+        std::geometric_distribution<int> word(0.002);
+        std::uniform_int_distribution<int> numOfWords(3, 8);
+        auto drawWord = [&]() { return "w" + std::to_string(word(generator) % vocabularySize); };
+        const long long count = options.scaled(1000000);
+        const int persons = 100;
+        vector<string> names;
+        for (int i = 0; i < persons; ++i) {
+            names.push_back("person" + std::to_string(i));
+        }
+        TaskManager manager(persons, TaskStorage::Buckets); // O(1) assigns keep the setup linear
+        for (long long i = 0; i < count; ++i) {
+            string description = drawWord();
+            for (int j = numOfWords(generator); j > 1; --j) {
+                description += " " + drawWord();
+            }
+            manager.assignTask(names[i % persons], Task(drawPriority(generator, PriorityDistribution::Uniform),
+                                                        drawType(generator), description));
+        }
+        // one and two word queries, over common and rare words alike
+        vector<string> queries;
+        for (int i = 0; i < 1000; ++i) {
+            queries.push_back(i % 2 ? drawWord() : drawWord() + " " + drawWord());
+        }
+        const int k = 10;
+
+        if (scanned) {
+            const int numOfQueries = 10; // every query reads every task
+            results.push_back(bench::measure("TaskManager/searchDescriptions/scan", numOfQueries, [&]() {
+                for (int i = 0; i < numOfQueries; ++i) {
+                    manager.searchDescriptions(queries[i], k);
+                }
+            }));
+        }
+        if (indexed) {
+            results.push_back(bench::measure("TaskManager/enableDescriptionIndex", count, [&]() {
+                manager.enableDescriptionIndex();
+            }));
+            long long numOfResults = 0;
+            results.push_back(bench::measure("TaskManager/searchDescriptions/indexed",
+                                             static_cast<long long>(queries.size()), [&]() {
+                for (const string& query : queries) {
+                    numOfResults += manager.searchDescriptions(query, k).size();
+                }
+            }));
+            std::cerr << "TaskManager/searchDescriptions/indexed: " << numOfResults << " results, index of "
+                      << manager.memoryUsage().searchIndexBytes << " bytes for " << count << " tasks" << std::endl;
+        }
+    }
+
+    // ----------------------------- change feed overhead ----------------------------- //
+
+    void benchChangeFeed(const bench::Options& options, vector<bench::Result>& results) {
+        const struct {
+            const char* name;
+            bool subscribe;
+            BackpressurePolicy policy;
+        } feeds[] = {
+            {"no-subscribers", false, BackpressurePolicy::Drop},
+            {"drop", true, BackpressurePolicy::Drop},
+            {"block", true, BackpressurePolicy::Block},
+            {"coalesce", true, BackpressurePolicy::Coalesce},
+        };
+
+        for (const auto& feed : feeds) {
+            const string name = string("ChangeFeed/assign+complete/") + feed.name;
+            if (!options.selected(name)) {
+                continue;
+            }
+
+            // short lists keep the mutations themselves cheap, so the feed's share of the cost shows
+            std::mt19937 generator(options.seed);
+            const long long count = options.scaled(200000);
+            const vector<Operation> operations = generateOperations(generator, count, 4, PriorityDistribution::Uniform,
+                                                                    50, 0);
+            const vector<string> names = {"person0", "person1", "person2", "person3"};
+            TaskManager manager;
+            std::shared_ptr<ChangeFeed::Subscription> subscription;
+            std::atomic<bool> done(false);
+            std::thread consumer;
+            if (feed.subscribe) {
+                subscription = manager.changeFeed().subscribe(1024, feed.policy);
+                consumer = std::thread([&subscription, &done]() {
+                    ChangeEvent event;
+                    while (!done.load(std::memory_order_acquire)) {
+                        if (!subscription->poll(event)) {
+                            std::this_thread::yield();
+                        }
+                    }
+                });
+            }
+
+            results.push_back(bench::measure(name, count, [&]() {
+                runOperations(manager, names, operations);
+            }));
+
+            done.store(true, std::memory_order_release);
+            if (consumer.joinable()) {
+                consumer.join();
+            }
+        }
+    }
+
+}
+
+int main(int argc, char** argv) {
+    try {
+        const bench::Options options = bench::parseOptions(argc, argv);
+        vector<bench::Result> results;
+        benchSortedList(options, results);
+        benchBlockSearch(options, results);
+        benchTaskManager(options, results);
+        benchCapacity(options, results);
+        benchPipeline(options, results);
+        benchSharedMemory(options, results);
+        benchChangeFeed(options, results);
+        benchRebalance(options, results);
+        benchDescriptionSearch(options, results);
+
+        bench::printResults(results);
+        if (!options.jsonPath.empty()) {
+            bench::writeJson("taskmanager_bench", options, results, options.jsonPath);
+        }
+        if (!options.metricsPath.empty() && !mtm::metrics::writePrometheus(options.metricsPath)) {
+            std::cerr << "taskmanager_bench: cannot write " << options.metricsPath << std::endl;
+            return 1;
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "taskmanager_bench: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -1,8 +1,29 @@
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <iterator>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <thread>
+#include <sys/wait.h>
+#include <unistd.h>
 #include "TaskManager.h"
+#include "SharedTaskStore.h"
+#include "TaskPipeline.h"
+#include "server/TaskClient.h"
+#include "server/TaskServer.h"
+#include "tools/Trace.h"
 #include "Task.h"
 
+#ifdef MTM_PARALLEL_ALGORITHMS
+#include <execution>
+#define PARALLEL_POLICY std::execution::par,
+#else
+#define PARALLEL_POLICY
+#endif
+
 using std::cout;
 using std::endl;
 
@@ -332,6 +353,1875 @@ bool testListExceptions()
     return true;
 }
 
+bool testListViews()
+{
+    SortedList<int> list;
+    for (int i = 1; i <= 10; ++i)
+    {
+        list.insert(i);
+    }
+
+    // nothing is evaluated (or copied) until the view is iterated
+    int calls = 0;
+    auto evens = list.view().filter([&calls](int x) { ++calls; return x % 2 == 0; });
+    ASSERT_TEST(calls == 0);
+
+    auto squares = evens.transform([](int x) { return x * x; }).take(3);
+    int expected[] = {100, 64, 36};
+    int index = 0;
+    for (int value : squares)
+    {
+        ASSERT_TEST(index < 3 && value == expected[index]);
+        ++index;
+    }
+    ASSERT_TEST(index == 3);
+    ASSERT_TEST(squares.count() == 3);
+
+    // materialize builds a real (sorted) list only when asked
+    SortedList<int> result = list.view().transform([](int x) { return -x; }).take(4).materialize();
+    ASSERT_TEST(result.length() == 4);
+    int expectedResult[] = {-7, -8, -9, -10};
+    index = 0;
+    for (int value : result)
+    {
+        ASSERT_TEST(value == expectedResult[index++]);
+    }
+
+    // the source list is untouched and empty chains behave
+    ASSERT_TEST(list.length() == 10);
+    ASSERT_TEST(list.view().filter([](int x) { return x > 100; }).materialize().length() == 0);
+    ASSERT_TEST(list.view().take(0).count() == 0);
+    ASSERT_TEST(SortedList<int>().view().take(5).count() == 0);
+
+    // take stops pulling from its base at the limit - the filter never sees the rest of the list
+    SortedList<int> longList;
+    for (int i = 0; i < 100000; ++i)
+    {
+        longList.insert(i);
+    }
+    calls = 0;
+    auto head = longList.view().filter([&calls](int x) { ++calls; return x >= 99997; }).take(3);
+    ASSERT_TEST(head.count() == 3 && calls == 3);
+
+    return true;
+}
+
+bool testListReverseIteration()
+{
+    SortedList<int> list;
+    ASSERT_TEST(list.rbegin() == list.rend());
+
+    list.insert(5);
+    list.insert(3);
+    list.insert(8);
+    list.insert(1);
+
+    // reverse range goes from the lowest element to the highest
+    int expected[] = {1, 3, 5, 8};
+    int index = 0;
+    for (auto it = list.rbegin(); it != list.rend(); ++it)
+    {
+        ASSERT_TEST(*it == expected[index++]);
+    }
+    ASSERT_TEST(index == 4);
+
+    // end() steps back to the tail
+    ASSERT_TEST(*std::prev(list.end()) == 1);
+    auto it = list.end();
+    it--;
+    ASSERT_TEST(*it-- == 1 && *it == 3);
+    ASSERT_TEST(*std::find_if(list.rbegin(), list.rend(), [](int x) { return x > 2; }) == 3);
+    ASSERT_TEST(std::distance(list.begin(), list.end()) == 4);
+
+    // stepping back from begin is out of range
+    try
+    {
+        auto first = list.begin();
+        --first;
+        return false;
+    }
+    catch (const std::out_of_range &e)
+    {
+    }
+
+    // trimming the tail keeps the reverse range consistent
+    list.remove(std::prev(list.end()));
+    list.remove(std::prev(list.end()));
+    ASSERT_TEST(list.length() == 2 && *list.rbegin() == 5);
+    list.remove(std::prev(list.end()));
+    list.remove(std::prev(list.end()));
+    ASSERT_TEST(list.length() == 0 && list.rbegin() == list.rend());
+
+    Person person("Alice");
+    person.assignTask(Task(7, "high"));
+    person.assignTask(Task(2, "low"));
+    ASSERT_TEST(person.getLowestPriorityTask().getPriority() == 2);
+
+    return true;
+}
+
+bool testListSegments()
+{
+    const int size = 10000;
+    SortedList<int> list;
+    for (int i = 1; i <= size; ++i)
+    {
+        list.insert(i);
+    }
+
+    // standard algorithms work directly on the list iterators
+    ASSERT_TEST(std::accumulate(list.begin(), list.end(), 0LL) == 1LL * size * (size + 1) / 2);
+    ASSERT_TEST(std::count_if(list.begin(), list.end(), [](int x) { return x % 2 == 0; }) == size / 2);
+
+    auto segments = list.segments(999);
+    ASSERT_TEST(segments.size() == 11);
+    ASSERT_TEST(segments.back().count() == size - 10 * 999);
+
+    // every segment is independent, so the aggregate can run in parallel
+    long long total = std::transform_reduce(PARALLEL_POLICY segments.begin(), segments.end(), 0LL,
+        std::plus<long long>(), [](const auto &segment) {
+            return std::accumulate(segment.begin(), segment.end(), 0LL);
+        });
+    ASSERT_TEST(total == 1LL * size * (size + 1) / 2);
+
+    ASSERT_TEST(SortedList<int>().segments(10).empty());
+    try
+    {
+        list.segments(0);
+        return false;
+    }
+    catch (const std::invalid_argument &e)
+    {
+    }
+
+    return true;
+}
+
+struct KeyedEntry
+{
+    int key;
+    int sequence;
+
+    bool operator>(const KeyedEntry &other) const { return key > other.key; }
+};
+
+bool testListUnrolled()
+{
+    // int and KeyedEntry are trivially copyable, so both lists use the block layout. a plain vector kept in the
+    // same order is the reference: every insert goes after the elements it is not greater than
+    std::mt19937 random(36);
+    SortedList<KeyedEntry> list;
+    std::vector<KeyedEntry> reference;
+    for (int i = 0; i < 5000; ++i)
+    {
+        KeyedEntry entry = {static_cast<int>(random() % 64), i};
+        list.insert(entry);
+        reference.insert(std::upper_bound(reference.begin(), reference.end(), entry, std::greater<KeyedEntry>()),
+                         entry);
+        if (i % 3 == 0)
+        {
+            const int position = static_cast<int>(random() % reference.size());
+            list.remove(std::next(list.begin(), position));
+            reference.erase(reference.begin() + position);
+        }
+    }
+
+    auto sameEntry = [](const KeyedEntry &a, const KeyedEntry &b) {
+        return a.key == b.key && a.sequence == b.sequence;
+    };
+    ASSERT_TEST(list.length() == static_cast<int>(reference.size()));
+    ASSERT_TEST(std::equal(list.begin(), list.end(), reference.begin(), reference.end(), sameEntry));
+    ASSERT_TEST(std::equal(list.rbegin(), list.rend(), reference.rbegin(), reference.rend(), sameEntry));
+
+    SortedList<KeyedEntry> copy(list);
+    ASSERT_TEST(std::equal(copy.begin(), copy.end(), reference.begin(), reference.end(), sameEntry));
+    while (copy.length() > 0)
+    {
+        copy.remove(std::prev(copy.end()));
+    }
+    ASSERT_TEST(copy.begin() == copy.end());
+
+    SortedList<int> numbers;
+    for (int i = 0; i < 1000; ++i)
+    {
+        numbers.insert((i * 7919) % 1000);
+    }
+    ASSERT_TEST(numbers.length() == 1000);
+    ASSERT_TEST(std::is_sorted(numbers.begin(), numbers.end(), std::greater<int>()));
+    ASSERT_TEST(*numbers.begin() == 999 && *numbers.rbegin() == 0);
+    ASSERT_TEST(numbers.filter([](int x) { return x < 10; }).length() == 10);
+
+    // one node per element keeps the iterators to the other elements valid across insert and remove - the
+    // block layout does not, its iterators are taken again after a change
+    SortedList<string> words;
+    for (int i = 0; i < 10; ++i)
+    {
+        words.insert(std::to_string(i));
+    }
+    auto nextWord = std::next(words.begin());
+    words.remove(words.begin());
+    words.insert("55");
+    ASSERT_TEST(*nextWord == "8" && words.length() == 10);
+    SortedList<int> digits;
+    for (int i = 0; i < 10; ++i)
+    {
+        digits.insert(i);
+    }
+    digits.remove(digits.begin());
+    ASSERT_TEST(*digits.begin() == 8 && *std::next(digits.begin()) == 7);
+
+    return true;
+}
+
+bool testBlockSearch()
+{
+    // every implementation the CPU can run must agree with the scalar one, on every block length
+    std::mt19937 random(37);
+    const mtm::blocksearch::Isa detected = mtm::blocksearch::detectIsa();
+    for (unsigned int count = 0; count <= 70; ++count)
+    {
+        std::vector<int> keys(count);
+        for (int &key : keys)
+        {
+            key = static_cast<int>(random() % 20) - 10;
+        }
+        std::sort(keys.begin(), keys.end(), std::greater<int>());
+        for (int key = -12; key <= 12; ++key)
+        {
+            const unsigned int expected = static_cast<unsigned int>(
+                std::upper_bound(keys.begin(), keys.end(), key, std::greater<int>()) - keys.begin());
+            for (int level = 0; level <= static_cast<int>(detected); ++level)
+            {
+                ASSERT_TEST(mtm::blocksearch::countNotLess(keys.data(), count, key,
+                                                           static_cast<mtm::blocksearch::Isa>(level)) == expected);
+            }
+        }
+    }
+
+    mtm::blocksearch::setActiveIsa(mtm::blocksearch::Isa::Scalar);
+    ASSERT_TEST(mtm::blocksearch::activeIsa() == mtm::blocksearch::Isa::Scalar);
+    mtm::blocksearch::setActiveIsa(mtm::blocksearch::Isa::Avx2);
+    ASSERT_TEST(mtm::blocksearch::activeIsa() == detected);
+
+    return true;
+}
+
+template <typename T>
+std::vector<int> listValues(const SortedList<T> &list)
+{
+    std::vector<int> values;
+    for (const T &element : list)
+    {
+        values.push_back(element.getValue());
+    }
+    return values;
+}
+
+struct NothrowAssignable
+{
+    int value;
+
+    NothrowAssignable(int value) : value(value) {}
+    NothrowAssignable(const NothrowAssignable &other) : value(other.value) {}
+    NothrowAssignable &operator=(const NothrowAssignable &other) noexcept = default;
+
+    bool operator>(const NothrowAssignable &other) const { return value > other.value; }
+    int getValue() const { return value; }
+};
+
+bool testListStrongGuarantee()
+{
+    ExceptionThrowingType counter;
+    counter.changeState(false);
+    SortedList<ExceptionThrowingType> source;
+    SortedList<ExceptionThrowingType> target;
+    for (int i = 0; i < 5; ++i)
+    {
+        source.insert(ExceptionThrowingType(i));
+        target.insert(ExceptionThrowingType(10 * i));
+    }
+    const std::vector<int> targetBefore = listValues(target);
+
+    // a copy that throws halfway through leaves the assigned list as it was
+    counter.zeroCounter();
+    counter.changeState(true);
+    try
+    {
+        target = source;
+        return false;
+    }
+    catch (const std::bad_alloc &)
+    {
+    }
+    ASSERT_TEST(listValues(target) == targetBefore);
+
+    // so does a bulk insert whose third copy throws
+    counter.changeState(false);
+    std::vector<ExceptionThrowingType> throwingAdded = {ExceptionThrowingType(7), ExceptionThrowingType(-1),
+                                                        ExceptionThrowingType(25), ExceptionThrowingType(3)};
+    counter.zeroCounter();
+    counter.changeState(true);
+    try
+    {
+        target.insert(throwingAdded.begin(), throwingAdded.end());
+        return false;
+    }
+    catch (const std::bad_alloc &)
+    {
+    }
+    ASSERT_TEST(listValues(target) == targetBefore);
+    counter.changeState(false);
+    counter.zeroCounter();
+
+    // bulk insert puts new elements after the equal ones already there, in their given order
+    SortedList<NothrowAssignable> numbers;
+    numbers.insert(NothrowAssignable(5));
+    numbers.insert(NothrowAssignable(1));
+    std::vector<NothrowAssignable> added = {3, 5, 9, 0, 3};
+    numbers.insert(added.begin(), added.end());
+    ASSERT_TEST(listValues(numbers) == std::vector<int>({9, 5, 5, 3, 3, 1, 0}));
+
+    // assignment reuses the nodes it has and frees or adds the rest
+    SortedList<NothrowAssignable> shorter;
+    shorter.insert(NothrowAssignable(42));
+    shorter = numbers;
+    ASSERT_TEST(listValues(shorter) == listValues(numbers));
+    numbers = SortedList<NothrowAssignable>().apply([](const NothrowAssignable &x) { return x; });
+    ASSERT_TEST(numbers.length() == 0 && numbers.begin() == numbers.end());
+    numbers = shorter.filter([](const NothrowAssignable &x) { return x.value > 3; });
+    ASSERT_TEST(listValues(numbers) == std::vector<int>({9, 5, 5}));
+
+    // the same for the unrolled layout, across many blocks
+    SortedList<int> large;
+    SortedList<int> small;
+    std::vector<int> values;
+    for (int i = 0; i < 1000; ++i)
+    {
+        values.push_back((i * 7919) % 1000);
+    }
+    large.insert(values.begin(), values.end());
+    large.insert(values.begin(), values.begin() + 10);
+    ASSERT_TEST(large.length() == 1010 && std::is_sorted(large.begin(), large.end(), std::greater<int>()));
+    small.insert(3);
+    small = large;
+    ASSERT_TEST(std::equal(small.begin(), small.end(), large.begin(), large.end()));
+    large = small.filter([](int x) { return x % 100 == 0; });
+    ASSERT_TEST(large.length() == 11 && *large.begin() == 900 && *large.rbegin() == 0);
+    small = large;
+    ASSERT_TEST(small.length() == 11 && *std::prev(small.end()) == 0);
+
+    // apply sorts its results once, equal results keep the order of their sources
+    SortedList<NothrowAssignable> scrambled = shorter.apply([](const NothrowAssignable &x) {
+        return NothrowAssignable((x.value * 7) % 10);
+    });
+    ASSERT_TEST(listValues(scrambled) == std::vector<int>({7, 5, 5, 3, 1, 1, 0}));
+
+    return true;
+}
+
+bool testListSpliceMergeSplit()
+{
+    // the linked layout: nodes move between lists, no element is copied
+    ExceptionThrowingType counter;
+    counter.changeState(false);
+    SortedList<ExceptionThrowingType> high;
+    SortedList<ExceptionThrowingType> low;
+    SortedList<ExceptionThrowingType> middle;
+    for (int i = 0; i < 5; ++i)
+    {
+        high.insert(ExceptionThrowingType(20 + i));
+        low.insert(ExceptionThrowingType(i));
+        middle.insert(ExceptionThrowingType(2 * i + 1));
+    }
+    counter.zeroCounter();
+    counter.changeState(true);
+
+    high.splice(std::move(low));
+    ASSERT_TEST(high.length() == 10 && low.length() == 0 && low.begin() == low.end());
+    try
+    {
+        SortedList<ExceptionThrowingType> overlapping = high.split([](const ExceptionThrowingType &x) {
+            return x.getValue() == 3;
+        });
+        high.splice(std::move(overlapping));
+        return false;
+    }
+    catch (const std::invalid_argument &)
+    {
+    }
+    ASSERT_TEST(high.length() == 9);
+
+    high.merge(std::move(middle));
+    ASSERT_TEST(listValues(high) == std::vector<int>({24, 23, 22, 21, 20, 9, 7, 5, 4, 3, 2, 1, 1, 0}));
+    ASSERT_TEST(middle.length() == 0);
+
+    SortedList<ExceptionThrowingType> tail = high.split(std::next(high.begin(), 5));
+    ASSERT_TEST(listValues(high) == std::vector<int>({24, 23, 22, 21, 20}));
+    ASSERT_TEST(listValues(tail) == std::vector<int>({9, 7, 5, 4, 3, 2, 1, 1, 0}));
+    ASSERT_TEST(tail.rbegin()->getValue() == 0);
+    SortedList<ExceptionThrowingType> odd = tail.split([](const ExceptionThrowingType &x) {
+        return x.getValue() % 2 == 1;
+    });
+    ASSERT_TEST(listValues(odd) == std::vector<int>({9, 7, 5, 3, 1, 1}));
+    ASSERT_TEST(listValues(tail) == std::vector<int>({4, 2, 0}));
+    ASSERT_TEST(high.split(high.end()).length() == 0);
+    counter.changeState(false);
+
+    // the unrolled layout, with cuts inside blocks
+    SortedList<int> numbers;
+    SortedList<int> others;
+    for (int i = 0; i < 1000; ++i)
+    {
+        numbers.insert(2 * i);
+        others.insert(2 * i + 1);
+    }
+    numbers.merge(std::move(others));
+    ASSERT_TEST(numbers.length() == 2000 && others.length() == 0);
+    ASSERT_TEST(std::is_sorted(numbers.begin(), numbers.end(), std::greater<int>()));
+    SortedList<int> lower = numbers.split(std::next(numbers.begin(), 1234));
+    ASSERT_TEST(numbers.length() == 1234 && lower.length() == 766);
+    ASSERT_TEST(*numbers.rbegin() == 766 && *lower.begin() == 765);
+    numbers.splice(std::move(lower));
+    ASSERT_TEST(numbers.length() == 2000 && std::is_sorted(numbers.begin(), numbers.end(), std::greater<int>()));
+    SortedList<int> multiples = numbers.split([](int x) { return x % 10 == 0; });
+    ASSERT_TEST(multiples.length() == 200 && numbers.length() == 1800);
+    ASSERT_TEST(*multiples.begin() == 1990 && *multiples.rbegin() == 0);
+
+    return true;
+}
+
+bool testTaskManagerStats()
+{
+    TaskManager manager;
+    manager.assignTask("Alice", Task(10, TaskType::Testing, "a"));
+    manager.assignTask("Alice", Task(95, TaskType::Development, "b"));
+    manager.assignTask("Bob", Task(200, TaskType::Testing, "c"));
+    manager.assignTask("Bob", Task(40, TaskType::Meeting, "d"));
+    manager.assignTask("Bob", Task(-5, TaskType::Testing, "e"));
+
+    TaskStats stats = manager.stats();
+    ASSERT_TEST(stats.getTotalCount() == 5);
+    ASSERT_TEST(stats.getCountByType(TaskType::Testing) == 3);
+    ASSERT_TEST(stats.getCountByType(TaskType::Research) == 0);
+    ASSERT_TEST(stats.getCountByPriority(100) == 1 && stats.getCountByPriority(0) == 1);
+    ASSERT_TEST(stats.getCountInPriorityRange(80, 100) == 2);
+    ASSERT_TEST(stats.getCountInPriorityRange(-100, 1000) == 5);
+    ASSERT_TEST(manager.stats("Bob").getTotalCount() == 3);
+    ASSERT_TEST(manager.stats("Nobody").getTotalCount() == 0);
+
+    // bumps move tasks between histogram buckets, completion removes them
+    manager.bumpPriorityByType(TaskType::Testing, 50);
+    stats = manager.stats();
+    ASSERT_TEST(stats.getCountByPriority(60) == 1 && stats.getCountByPriority(50) == 1);
+    ASSERT_TEST(stats.getCountByPriority(10) == 0 && stats.getCountByPriority(0) == 0);
+    ASSERT_TEST(stats.getCountByPriority(100) == 1);
+    ASSERT_TEST(manager.stats("Alice").getCountInPriorityRange(60, 100) == 2);
+
+    manager.completeTask("Bob");
+    stats = manager.stats();
+    ASSERT_TEST(stats.getTotalCount() == 4 && stats.getCountByPriority(100) == 0);
+    ASSERT_TEST(stats.getCountByType(TaskType::Testing) == 2);
+    ASSERT_TEST(manager.stats("Bob").getTotalCount() == 2);
+
+    return true;
+}
+
+bool testTaskManagerMemoryUsage()
+{
+    mtm::AllocationTracker tracker;
+    mtm::setNodeAllocationTracker(&tracker);
+    bool result = true;
+    {
+        TaskManager manager;
+        const string longDescription(100, 'x');
+        manager.assignTask("Alice", Task(1, TaskType::Testing, "short"));
+        manager.assignTask("Alice", Task(2, TaskType::Testing, longDescription));
+        manager.assignTask("Bob", Task(3, TaskType::Research, longDescription));
+        manager.assignTask("A person with a name too long for the inline buffer", Task(4, "short"));
+
+        MemoryUsage usage = manager.memoryUsage();
+        result = result && usage.taskPayloadBytes == 4 * sizeof(Task);
+        // the tracker saw exactly the nodes the report accounts for
+        result = result && tracker.getLiveBlocks() == 4;
+        result = result && tracker.getLiveBytes() == usage.listNodeBytes + usage.taskPayloadBytes;
+        result = result && usage.descriptionHeapBytes >= 2 * (longDescription.size() + 1);
+        result = result && usage.descriptionHeapBytes < 4 * (longDescription.size() + 1);
+        result = result && usage.personTableBytes > sizeof(Person) * 10;
+        result = result && usage.total() == usage.listNodeBytes + usage.taskPayloadBytes +
+                                            usage.descriptionHeapBytes + usage.personTableBytes;
+
+        manager.completeTask("Bob");
+        MemoryUsage afterComplete = manager.memoryUsage();
+        result = result && tracker.getLiveBlocks() == 3;
+        result = result && tracker.getLiveBytes() == afterComplete.listNodeBytes + afterComplete.taskPayloadBytes;
+        result = result && afterComplete.descriptionHeapBytes < usage.descriptionHeapBytes;
+    }
+    result = result && tracker.getLiveBytes() == 0 && tracker.getPeakBytes() > 0;
+    mtm::setNodeAllocationTracker(nullptr);
+
+    return result;
+}
+
+bool testTaskManagerChangeFeed()
+{
+    TaskManager manager;
+    auto everything = manager.changeFeed().subscribe(16, BackpressurePolicy::Drop);
+    auto coalesced = manager.changeFeed().subscribe(4, BackpressurePolicy::Coalesce);
+
+    manager.assignTask("Alice", Task(10, TaskType::Testing, "a"));
+    manager.assignTask("Alice", Task(20, TaskType::Research, "b"));
+    manager.bumpPriorityByType(TaskType::Testing, 5);
+    manager.completeTask("Alice");
+
+    ChangeType expectedTypes[] = {ChangeType::PersonAdded, ChangeType::TaskAssigned, ChangeType::TaskAssigned,
+                                  ChangeType::PriorityBumped, ChangeType::TaskCompleted};
+    int index = 0;
+    ChangeEvent event;
+    while (everything->poll(event))
+    {
+        ASSERT_TEST(index < 5 && event.type == expectedTypes[index]);
+        ASSERT_TEST(event.sequence == static_cast<unsigned long long>(index));
+        ++index;
+    }
+    ASSERT_TEST(index == 5);
+    ASSERT_TEST(everything->getDroppedCount() == 0);
+
+    // the completed task is the bumped-over Research task (id 1, priority 20)
+    ASSERT_TEST(event.personName == "Alice" && event.taskId == 1 && event.priority == 20);
+
+    // the small coalescing subscriber kept 4 events and folded the last one into a marker on the next publish
+    ASSERT_TEST(coalesced->drain([](const ChangeEvent &) {}) == 4);
+    manager.assignTask("Alice", Task(30, TaskType::General, "c"));
+    ASSERT_TEST(coalesced->poll(event) && event.type == ChangeType::EventsCoalesced && event.count == 1);
+    ASSERT_TEST(coalesced->poll(event) && event.type == ChangeType::TaskAssigned && event.sequence == 5);
+    ASSERT_TEST(!coalesced->poll(event));
+    manager.changeFeed().unsubscribe(coalesced);
+
+    // a blocking subscriber consumed on another thread sees every event, in order - and may read the manager
+    // and subscribe on that thread while the publisher waits for it
+    manager.changeFeed().unsubscribe(everything);
+    auto blocking = manager.changeFeed().subscribe(8, BackpressurePolicy::Block);
+    const int numOfTasks = 1000;
+    bool inOrder = true;
+    bool readsDone = true;
+    std::thread consumer([&manager, &blocking, &inOrder, &readsDone]() {
+        unsigned long long expectedSequence = 6;
+        int received = 0;
+        ChangeEvent consumed;
+        while (received < numOfTasks)
+        {
+            if (blocking->poll(consumed))
+            {
+                inOrder = inOrder && consumed.sequence == expectedSequence++;
+                ++received;
+            }
+            if (received % 100 == 50)
+            {
+                readsDone = readsDone && manager.snapshot().getVersion() > 0 &&
+                            manager.stats("Alice").getTotalCount() > 0 &&
+                            manager.searchDescriptions("load", 1).size() <= 1;
+                auto extra = manager.changeFeed().subscribe(4, BackpressurePolicy::Drop);
+                manager.changeFeed().unsubscribe(extra);
+            }
+        }
+    });
+    for (int i = 0; i < numOfTasks; ++i)
+    {
+        manager.assignTask("Alice", Task(i % 100, "load"));
+    }
+    consumer.join();
+    ASSERT_TEST(inOrder && readsDone && blocking->getDroppedCount() == 0);
+
+    return true;
+}
+
+bool isSortedSnapshot(const SortedList<Task> &tasks)
+{
+    int counted = 0;
+    const Task *previous = nullptr;
+    for (const Task &task : tasks)
+    {
+        if (previous != nullptr && task > *previous)
+        {
+            return false;
+        }
+        previous = &task;
+        ++counted;
+    }
+    return counted == tasks.length();
+}
+
+bool testPersonSnapshot()
+{
+    TaskManager manager;
+    manager.assignTask("Alice", Task(5, "first"));
+    manager.assignTask("Alice", Task(9, "second"));
+
+    auto snapshot = manager.snapshotTasks("Alice");
+    ASSERT_TEST(snapshot->length() == 2);
+    // taking another snapshot without changes in between shares the same list
+    ASSERT_TEST(manager.snapshotTasks("Alice") == snapshot);
+
+    manager.completeTask("Alice");
+    manager.assignTask("Alice", Task(1, "third"));
+    manager.bumpPriorityByType(TaskType::General, 50);
+    ASSERT_TEST(snapshot->length() == 2 && (*snapshot->begin()).getPriority() == 9);
+    ASSERT_TEST(manager.snapshotTasks("Alice")->length() == 2);
+    ASSERT_TEST(manager.snapshotTasks("Nobody")->length() == 0);
+
+    // copies of a person share the tasks until one of them changes
+    Person original("Bob");
+    original.assignTask(Task(3, "x"));
+    Person copy(original);
+    ASSERT_TEST(copy.snapshot() == original.snapshot());
+    copy.assignTask(Task(4, "y"));
+    ASSERT_TEST(original.getTasks().length() == 1 && copy.getTasks().length() == 2);
+
+    // readers keep snapshotting and iterating while the writer keeps changing the list
+    const int numOfOperations = 3000;
+    std::atomic<bool> writerDone(false);
+    std::atomic<bool> consistent(true);
+    std::thread reader([&manager, &writerDone, &consistent]() {
+        while (!writerDone.load())
+        {
+            if (!isSortedSnapshot(*manager.snapshotTasks("Alice")))
+            {
+                consistent = false;
+            }
+        }
+    });
+    for (int i = 0; i < numOfOperations; ++i)
+    {
+        manager.assignTask("Alice", Task((i * 37) % 101, "load"));
+        if (i % 3 == 0)
+        {
+            manager.completeTask("Alice");
+        }
+    }
+    writerDone = true;
+    reader.join();
+    ASSERT_TEST(consistent.load());
+    ASSERT_TEST(manager.snapshotTasks("Alice")->length() == 2 + numOfOperations - numOfOperations / 3);
+
+    return true;
+}
+
+bool testTaskManagerSnapshotConsistency()
+{
+    // every 10th mutation bumps all persons at once, the others assign to persons in turn
+    const string names[] = {"Alice", "Bob", "Charlie"};
+    const int numOfMutations = 3000;
+    TaskManager manager;
+
+    std::atomic<bool> writerDone(false);
+    std::thread writer([&]() {
+        for (int i = 0; i < numOfMutations; ++i)
+        {
+            if (i % 10 == 9)
+            {
+                manager.bumpPriorityByType(TaskType::General, 1);
+            }
+            else
+            {
+                manager.assignTask(names[i % 3], Task(i % 50, "task " + std::to_string(i)));
+            }
+        }
+        writerDone = true;
+    });
+
+    int numOfSnapshots = 0;
+    bool consistent = true;
+    while (!writerDone.load() || numOfSnapshots == 0)
+    {
+        const TaskManagerSnapshot snapshot = manager.snapshot();
+        const unsigned long long version = snapshot.getVersion();
+        ++numOfSnapshots;
+
+        // exactly the tasks of the first "version" mutations, no matter how the snapshot raced the writer
+        int expectedCounts[3] = {0, 0, 0};
+        int numOfBumps = 0;
+        for (unsigned long long i = 0; i < version; ++i)
+        {
+            if (i % 10 == 9)
+            {
+                ++numOfBumps;
+            }
+            else
+            {
+                ++expectedCounts[i % 3];
+            }
+        }
+        int total = 0;
+        for (int p = 0; p < snapshot.getNumOfPersons(); ++p)
+        {
+            const SortedList<Task> &tasks = snapshot.getTasks(p);
+            consistent = consistent && tasks.length() == expectedCounts[p] && isSortedSnapshot(tasks);
+            total += tasks.length();
+            // a task assigned as mutation i went through every bump after it
+            for (const Task &task : tasks)
+            {
+                const int assignedAt = task.getId() + task.getId() / 9;
+                const int bumpsSince = numOfBumps - (assignedAt + 1) / 10;
+                const int expectedPriority = std::min(assignedAt % 50 + bumpsSince, Task::MAX_PRIORITY);
+                consistent = consistent && task.getPriority() == expectedPriority;
+            }
+        }
+        consistent = consistent && total == snapshot.stats().getTotalCount();
+    }
+    writer.join();
+    ASSERT_TEST(consistent);
+    ASSERT_TEST(manager.snapshot().getVersion() == numOfMutations);
+
+    // reports of a snapshot do not change with the TaskManager
+    TaskManagerSnapshot frozen = manager.snapshot();
+    std::ostringstream before, after;
+    frozen.printTasksByType(TaskType::General, before);
+    manager.completeTask("Alice");
+    manager.bumpPriorityByType(TaskType::General, 7);
+    frozen.printTasksByType(TaskType::General, after);
+    ASSERT_TEST(before.str() == after.str() && !before.str().empty());
+
+    return true;
+}
+
+bool testTaskManagerReassign()
+{
+    TaskManager manager;
+    auto events = manager.changeFeed().subscribe(32, BackpressurePolicy::Drop);
+    manager.assignTask("Alice", Task(10, TaskType::Testing, "a"));
+    manager.assignTask("Alice", Task(30, TaskType::Research, "b"));
+    manager.assignTask("Bob", Task(20, TaskType::Testing, "c"));
+    manager.assignTask("Carol", Task(5, TaskType::General, "d"));
+    auto aliceBefore = manager.snapshotTasks("Alice");
+
+    manager.reassignAllTasks("Alice", "Bob");
+    ASSERT_TEST(manager.stats("Alice").getTotalCount() == 0);
+    ASSERT_TEST(manager.stats("Bob").getTotalCount() == 3);
+    ASSERT_TEST(manager.stats("Bob").getCountByType(TaskType::Research) == 1);
+    ASSERT_TEST(manager.stats().getTotalCount() == 4);
+    auto bob = manager.snapshotTasks("Bob");
+    ASSERT_TEST(bob->begin()->getId() == 1 && std::prev(bob->end())->getId() == 0);
+    ASSERT_TEST(aliceBefore->length() == 2); // an earlier snapshot still sees the tasks where they were
+
+    // a missing source changes nothing, a missing target is added
+    manager.reassignAllTasks("Nobody", "Bob");
+    manager.reassignAllTasks("Bob", "Dave");
+    ASSERT_TEST(manager.stats("Dave").getTotalCount() == 3 && manager.stats("Bob").getTotalCount() == 0);
+
+    // merging removes a person and frees its place
+    manager.mergePersons("Carol", "Dave");
+    ASSERT_TEST(manager.stats("Carol").getTotalCount() == 4 && manager.stats("Dave").getTotalCount() == 0);
+    TaskManagerSnapshot snapshot = manager.snapshot();
+    ASSERT_TEST(snapshot.getNumOfPersons() == 3);
+    ASSERT_TEST(snapshot.getPersonName(0) == "Alice" && snapshot.getPersonName(1) == "Bob");
+    ASSERT_TEST(snapshot.getPersonName(2) == "Carol");
+    ASSERT_TEST(isSortedSnapshot(snapshot.getTasks(2)));
+    for (int i = 0; i < 7; ++i)
+    {
+        manager.assignTask("Extra" + std::to_string(i), Task(i, "x"));
+    }
+    ASSERT_TEST(manager.snapshot().getNumOfPersons() == 10);
+    manager.assignTask("Carol", Task(50, TaskType::Research, "e"));
+    ASSERT_TEST(manager.stats("Carol").getTotalCount() == 5 && manager.stats().getTotalCount() == 12);
+
+    ChangeEvent event;
+    int moves = 0;
+    while (events->poll(event))
+    {
+        if (event.type == ChangeType::TasksReassigned || event.type == ChangeType::PersonsMerged)
+        {
+            ++moves;
+            if (event.type == ChangeType::PersonsMerged)
+            {
+                ASSERT_TEST(event.personName == "Carol" && event.otherPersonName == "Dave" && event.count == 3);
+            }
+        }
+    }
+    ASSERT_TEST(moves == 3);
+
+    // a full table merges into a new name - the merged person's place is taken by it
+    TaskManager full(2);
+    full.assignTask("Alice", Task(10, TaskType::Testing, "a"));
+    full.assignTask("Bob", Task(20, TaskType::Testing, "b"));
+    full.assignTask("Bob", Task(30, TaskType::Research, "c"));
+    full.mergePersons("Zoe", "Bob");
+    TaskManagerSnapshot fullSnapshot = full.snapshot();
+    ASSERT_TEST(fullSnapshot.getNumOfPersons() == 2);
+    ASSERT_TEST(fullSnapshot.getPersonName(0) == "Alice" && fullSnapshot.getPersonName(1) == "Zoe");
+    ASSERT_TEST(full.stats("Zoe").getTotalCount() == 2 && full.stats("Bob").getTotalCount() == 0);
+    ASSERT_TEST(full.stats("Zoe").getCountByType(TaskType::Research) == 1 && full.stats().getTotalCount() == 3);
+    ASSERT_TEST(isSortedSnapshot(fullSnapshot.getTasks(1)) && fullSnapshot.getTasks(1).begin()->getId() == 2);
+
+    return true;
+}
+
+bool testTaskManagerRebalance()
+{
+    // more persons than the default table holds
+    TaskManager manager(20);
+    auto events = manager.changeFeed().subscribe(64, BackpressurePolicy::Drop);
+    for (int i = 0; i < 12; ++i)
+    {
+        manager.assignTask("Alice", Task(5 * i, i % 2 ? TaskType::Testing : TaskType::Research, "a"));
+    }
+    manager.assignTask("Bob", Task(50, TaskType::Testing, "b"));
+    for (int i = 0; i < 13; ++i)
+    {
+        manager.assignTask("Person" + std::to_string(i), Task(1, TaskType::General, "p"));
+    }
+    ASSERT_TEST(manager.snapshot().getNumOfPersons() == 15);
+
+    // 26 tasks for 15 persons: Alice keeps 2 and her lowest tasks go to Bob, and to the others
+    RebalanceReport report = manager.rebalance();
+    ASSERT_TEST(report.maxLoadBefore == 12 && report.maxLoadAfter == 2 && report.tasksMoved == 10);
+    ASSERT_TEST(manager.stats().getTotalCount() == 26);
+    TaskManagerSnapshot snapshot = manager.snapshot();
+    int totalTasks = 0;
+    for (int i = 0; i < snapshot.getNumOfPersons(); ++i)
+    {
+        const int numOfTasks = snapshot.getTasks(i).length();
+        ASSERT_TEST(numOfTasks == 1 || numOfTasks == 2);
+        ASSERT_TEST(isSortedSnapshot(snapshot.getTasks(i)));
+        ASSERT_TEST(manager.stats(snapshot.getPersonName(i)).getTotalCount() == numOfTasks);
+        totalTasks += numOfTasks;
+    }
+    ASSERT_TEST(totalTasks == 26);
+    ASSERT_TEST(snapshot.getTasks(0).begin()->getPriority() == 55);
+
+    // a balanced manager stays as it is
+    ASSERT_TEST(manager.rebalance().tasksMoved == 0);
+
+    // summed priorities, two persons
+    TaskManager pair;
+    for (int i = 1; i <= 10; ++i)
+    {
+        pair.assignTask("Heavy", Task(i * 10, TaskType::Testing, "h"));
+    }
+    pair.assignTask("Light", Task(5, TaskType::Research, "l"));
+    RebalancePolicy byPriority;
+    byPriority.measure = RebalanceMeasure::PrioritySum;
+    report = pair.rebalance(byPriority);
+    ASSERT_TEST(report.maxLoadBefore == 550 && report.maxLoadAfter < 550 && report.maxLoadAfter >= 280);
+    auto priorityOf = [&pair](const string &name) {
+        long long sum = 0;
+        for (const Task &task : *pair.snapshotTasks(name))
+        {
+            sum += task.getPriority();
+        }
+        return sum;
+    };
+    ASSERT_TEST(priorityOf("Heavy") + priorityOf("Light") == 555);
+    ASSERT_TEST(std::max(priorityOf("Heavy"), priorityOf("Light")) == report.maxLoadAfter);
+
+    // per type: only the Testing tasks are evened out, the Research task stays with Light
+    RebalancePolicy perType;
+    perType.perTaskType = true;
+    TaskManager typed;
+    for (int i = 0; i < 6; ++i)
+    {
+        typed.assignTask("Tester", Task(i, TaskType::Testing, "t"));
+    }
+    typed.assignTask("Researcher", Task(3, TaskType::Research, "r"));
+    report = typed.rebalance(perType);
+    ASSERT_TEST(report.tasksMoved == 3);
+    ASSERT_TEST(typed.stats("Tester").getCountByType(TaskType::Testing) == 3);
+    ASSERT_TEST(typed.stats("Researcher").getCountByType(TaskType::Testing) == 3);
+    ASSERT_TEST(typed.stats("Researcher").getCountByType(TaskType::Research) == 1);
+    ASSERT_TEST(typed.snapshotTasks("Researcher")->begin()->getPriority() == 3);
+
+    ChangeEvent event;
+    int rebalances = 0;
+    while (events->poll(event))
+    {
+        rebalances += event.type == ChangeType::TasksRebalanced && event.count == 10;
+    }
+    ASSERT_TEST(rebalances == 1);
+
+    try
+    {
+        TaskManager empty(0);
+        return false;
+    }
+    catch (const std::invalid_argument &)
+    {
+    }
+
+    return true;
+}
+
+bool sameTasks(const SortedList<Task> &lhs, const SortedList<Task> &rhs)
+{
+    if (lhs.length() != rhs.length())
+    {
+        return false;
+    }
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), [](const Task &a, const Task &b) {
+        return a.getId() == b.getId() && a.getPriority() == b.getPriority() && a.getType() == b.getType();
+    });
+}
+
+bool testTaskManagerBuckets()
+{
+    TaskBucketQueue queue;
+    ASSERT_TEST(queue.begin() == queue.end());
+    for (int i = 0; i < 6; ++i)
+    {
+        Task task(i % 2 ? 90 : 10, i % 3 ? TaskType::Testing : TaskType::Research);
+        task.setId(i);
+        queue.insert(task);
+    }
+    Task late(90, TaskType::Research);
+    late.setId(-1);
+    queue.insert(late);
+    ASSERT_TEST(queue.length() == 7 && queue.highest().getId() == -1 && queue.lowest().getId() == 4);
+
+    // the bumped Testing tasks land between the tasks already there, by id - and 90 + 80 is clamped to 100
+    const auto movedFrom = queue.bumpPriorityByType(TaskType::Testing, 80);
+    ASSERT_TEST(movedFrom[10] == 2 && movedFrom[90] == 2);
+    const int expectedIds[] = {1, 5, -1, 2, 3, 4, 0};
+    const int expectedPriorities[] = {100, 100, 90, 90, 90, 90, 10};
+    int index = 0;
+    for (const Task &task : queue)
+    {
+        ASSERT_TEST(task.getId() == expectedIds[index] && task.getPriority() == expectedPriorities[index]);
+        ++index;
+    }
+    ASSERT_TEST(index == 7);
+    ASSERT_TEST(queue.popHighest().getId() == 1 && queue.popLowest().getId() == 0 && queue.length() == 5);
+
+    // a snapshot shares the buckets and lists them itself - the person's next change copies them instead
+    Person carol("Carol", TaskStorage::Buckets);
+    for (int i = 0; i < 3; ++i)
+    {
+        Task task(30 * i, TaskType::Meeting);
+        task.setId(i);
+        carol.assignTask(task);
+    }
+    const Person::FrozenTasks frozen = carol.freezeTasks();
+    ASSERT_TEST(frozen.tasks == nullptr && frozen.buckets != nullptr);
+    ASSERT_TEST(carol.completeTask() == 2);
+    Task newer(45, TaskType::Meeting);
+    newer.setId(3);
+    carol.assignTask(newer);
+    const std::shared_ptr<const SortedList<Task>> frozenList = frozen.toList();
+    ASSERT_TEST(frozenList->length() == 3 && frozenList->begin()->getId() == 2);
+    ASSERT_TEST(carol.snapshot()->length() == 3 && carol.snapshot()->begin()->getId() == 3);
+
+    // walking or printing the tasks reads the buckets in place - no list copy is built and kept
+    std::vector<int> lowestFirst;
+    carol.forEachTask([&lowestFirst](const Task &task) {
+        lowestFirst.push_back(task.getId());
+        return lowestFirst.size() < 2;
+    }, true);
+    ASSERT_TEST((lowestFirst == std::vector<int>{0, 1}));
+    std::ostringstream printed;
+    printed << carol;
+    ASSERT_TEST(printed.str().find("Person: Carol") == 0 && carol.freezeTasks().tasks == nullptr);
+
+    // the same random workload on both storages - every person's tasks must come out the same
+    TaskManager lists(8);
+    TaskManager buckets(8, TaskStorage::Buckets);
+    std::mt19937 generator(41);
+    for (int step = 0; step < 3000; ++step)
+    {
+        const string name = "P" + std::to_string(generator() % 8);
+        const int operation = generator() % 100;
+        if (operation < 60)
+        {
+            const Task task(generator() % 101, static_cast<TaskType>(generator() % NUM_TASK_TYPES));
+            lists.assignTask(name, task);
+            buckets.assignTask(name, task);
+        }
+        else if (operation < 85)
+        {
+            if (lists.stats(name).getTotalCount() > 0)
+            {
+                lists.completeTask(name);
+                buckets.completeTask(name);
+            }
+        }
+        else if (operation < 95)
+        {
+            const TaskType type = static_cast<TaskType>(generator() % NUM_TASK_TYPES);
+            const int priority = generator() % 30;
+            lists.bumpPriorityByType(type, priority);
+            buckets.bumpPriorityByType(type, priority);
+        }
+        else if (operation < 98)
+        {
+            const string otherName = "P" + std::to_string(generator() % 8);
+            lists.reassignAllTasks(name, otherName);
+            buckets.reassignAllTasks(name, otherName);
+        }
+        else
+        {
+            RebalancePolicy policy;
+            policy.perTaskType = generator() % 2;
+            ASSERT_TEST(lists.rebalance(policy).tasksMoved == buckets.rebalance(policy).tasksMoved);
+        }
+    }
+
+    const TaskManagerSnapshot listsSnapshot = lists.snapshot();
+    const TaskManagerSnapshot bucketsSnapshot = buckets.snapshot();
+    ASSERT_TEST(listsSnapshot.getNumOfPersons() == bucketsSnapshot.getNumOfPersons());
+    for (int i = 0; i < listsSnapshot.getNumOfPersons(); ++i)
+    {
+        ASSERT_TEST(listsSnapshot.getPersonName(i) == bucketsSnapshot.getPersonName(i));
+        ASSERT_TEST(sameTasks(listsSnapshot.getTasks(i), bucketsSnapshot.getTasks(i)));
+    }
+    ASSERT_TEST(lists.stats().getTotalCount() == buckets.stats().getTotalCount());
+    ASSERT_TEST(lists.stats().getCountInPriorityRange(90, 100) == buckets.stats().getCountInPriorityRange(90, 100));
+
+    return true;
+}
+
+bool testTaskManagerLazyBumps()
+{
+    // a person records the bumps and applies them on the next read - it must end up as if bumped right away
+    Person alice("Alice");
+    for (int i = 0; i < 4; ++i)
+    {
+        Task task(90 + i, i % 2 ? TaskType::Testing : TaskType::Research);
+        task.setId(i);
+        alice.assignTask(task);
+    }
+    alice.bumpPriorityByType(TaskType::Research, 5);
+    Task late(94, TaskType::Research);
+    late.setId(4);
+    alice.assignTask(late);
+    alice.bumpPriorityByType(TaskType::Research, 3);
+    alice.bumpPriorityByType(TaskType::Testing, 7);
+    ASSERT_TEST(alice.stats().getCountByPriority(100) == 2 && alice.stats().getCountByPriority(97) == 1);
+    const int expectedIds[] = {2, 3, 0, 1, 4};
+    int index = 0;
+    for (const Task &task : alice.getTasks())
+    {
+        ASSERT_TEST(task.getId() == expectedIds[index++]);
+    }
+
+    // the stats and the snapshots read the pending bumps without applying them to the person's tasks
+    Person bob("Bob");
+    for (int i = 0; i < 3; ++i)
+    {
+        Task task(10 * i, TaskType::Testing);
+        task.setId(i);
+        bob.assignTask(task);
+    }
+    const std::shared_ptr<const SortedList<Task>> unbumped = bob.freezeTasks().tasks;
+    bob.bumpPriorityByType(TaskType::Testing, 90);
+    ASSERT_TEST(bob.stats().getCountByPriority(100) == 2 && bob.stats().getCountByPriority(90) == 1);
+    const std::shared_ptr<const SortedList<Task>> bumped = bob.snapshot();
+    ASSERT_TEST(bumped->begin()->getPriority() == 100 && bumped->rbegin()->getPriority() == 90);
+    ASSERT_TEST(bob.freezeTasks().tasks == unbumped && unbumped->begin()->getPriority() == 20);
+
+    // every storage against a model that applies every bump to every task on the spot
+    for (TaskStorage storage : {TaskStorage::List, TaskStorage::Buckets})
+    {
+        TaskManager manager(6, storage);
+        std::vector<string> names;
+        std::vector<std::vector<Task>> model;
+        auto personIndex = [&names, &model](const string &name) {
+            const auto found = std::find(names.begin(), names.end(), name);
+            if (found != names.end())
+            {
+                return static_cast<int>(found - names.begin());
+            }
+            names.push_back(name);
+            model.emplace_back();
+            return static_cast<int>(names.size()) - 1;
+        };
+        auto sameAsModel = [&manager, &model, &names](int index) {
+            std::vector<Task> expected = model[index];
+            std::stable_sort(expected.begin(), expected.end(), [](const Task &a, const Task &b) { return a > b; });
+            SortedList<Task> expectedList;
+            expectedList.insert(expected.begin(), expected.end());
+            return sameTasks(*manager.snapshotTasks(names[index]), expectedList);
+        };
+
+        std::mt19937 generator(42);
+        int nextId = 0;
+        for (int step = 0; step < 4000; ++step)
+        {
+            const string name = "P" + std::to_string(generator() % 6);
+            const int operation = generator() % 100;
+            if (operation < 55)
+            {
+                Task task(generator() % 101, static_cast<TaskType>(generator() % NUM_TASK_TYPES));
+                manager.assignTask(name, task);
+                task.setId(nextId++);
+                model[personIndex(name)].push_back(task);
+            }
+            else if (operation < 70)
+            {
+                const auto found = std::find(names.begin(), names.end(), name);
+                if (found != names.end() && !model[found - names.begin()].empty())
+                {
+                    std::vector<Task> &tasks = model[found - names.begin()];
+                    tasks.erase(std::min_element(tasks.begin(), tasks.end(), [](const Task &a, const Task &b) {
+                        return a > b;
+                    }));
+                    manager.completeTask(name);
+                }
+            }
+            else if (operation < 95)
+            {
+                const TaskType type = static_cast<TaskType>(generator() % NUM_TASK_TYPES);
+                const int priority = 1 + generator() % 30;
+                manager.bumpPriorityByType(type, priority);
+                for (std::vector<Task> &tasks : model)
+                {
+                    for (Task &task : tasks)
+                    {
+                        if (task.getType() == type)
+                        {
+                            task.setPriority(task.getPriority() + priority);
+                        }
+                    }
+                }
+            }
+            else if (operation < 97)
+            {
+                const string otherName = "P" + std::to_string(generator() % 6);
+                const auto found = std::find(names.begin(), names.end(), name);
+                if (found != names.end() && otherName != name)
+                {
+                    const int from = static_cast<int>(found - names.begin());
+                    const int to = personIndex(otherName);
+                    model[to].insert(model[to].end(), model[from].begin(), model[from].end());
+                    model[from].clear();
+                }
+                manager.reassignAllTasks(name, otherName);
+            }
+            else
+            {
+                const auto found = std::find(names.begin(), names.end(), name);
+                ASSERT_TEST(found == names.end() || sameAsModel(static_cast<int>(found - names.begin())));
+            }
+        }
+
+        TaskStats expectedStats;
+        for (int i = 0; i < static_cast<int>(names.size()); ++i)
+        {
+            ASSERT_TEST(sameAsModel(i));
+            TaskStats expectedPersonStats;
+            for (const Task &task : model[i])
+            {
+                expectedStats.add(task);
+                expectedPersonStats.add(task);
+            }
+            for (int priority = Task::MIN_PRIORITY; priority <= Task::MAX_PRIORITY; ++priority)
+            {
+                ASSERT_TEST(manager.stats(names[i]).getCountByPriority(priority) ==
+                            expectedPersonStats.getCountByPriority(priority));
+            }
+        }
+        for (int priority = Task::MIN_PRIORITY; priority <= Task::MAX_PRIORITY; ++priority)
+        {
+            ASSERT_TEST(manager.stats().getCountByPriority(priority) == expectedStats.getCountByPriority(priority));
+        }
+    }
+
+    return true;
+}
+
+bool testTaskTypeSet()
+{
+    const TaskTypeSet engineering = {TaskType::Development, TaskType::Testing, TaskType::Maintenance};
+    ASSERT_TEST(engineering.contains(TaskType::Testing) && !engineering.contains(TaskType::Meeting));
+    ASSERT_TEST((engineering & TaskTypeSet(TaskType::Testing)) == TaskTypeSet(TaskType::Testing));
+    ASSERT_TEST((engineering | TaskType::Meeting).contains(TaskType::Meeting) && TaskTypeSet().empty());
+    ASSERT_TEST(TaskTypeSet::all().contains(TaskType::General));
+    ASSERT_TEST(TaskTypeSet::all().bits() == (1u << NUM_TASK_TYPES) - 1);
+
+    // one bump of a set is the same as a bump of every type in it
+    TaskManager together;
+    TaskManager separately;
+    for (int i = 0; i < 40; ++i)
+    {
+        const Task task(i * 7 % 101, static_cast<TaskType>(i % NUM_TASK_TYPES), "t" + std::to_string(i));
+        together.assignTask(i % 3 ? "Alice" : "Bob", task);
+        separately.assignTask(i % 3 ? "Alice" : "Bob", task);
+    }
+    auto events = together.changeFeed().subscribe(16, BackpressurePolicy::Drop);
+    together.bumpPriorityByType(engineering, 20);
+    separately.bumpPriorityByType(TaskType::Development, 20);
+    separately.bumpPriorityByType(TaskType::Testing, 20);
+    separately.bumpPriorityByType(TaskType::Maintenance, 20);
+    ASSERT_TEST(sameTasks(*together.snapshotTasks("Alice"), *separately.snapshotTasks("Alice")));
+    ASSERT_TEST(sameTasks(*together.snapshotTasks("Bob"), *separately.snapshotTasks("Bob")));
+    ChangeEvent event;
+    int bumps = 0;
+    while (events->poll(event))
+    {
+        bumps += event.type == ChangeType::PriorityBumped && engineering.contains(event.taskType);
+    }
+    ASSERT_TEST(bumps == 3);
+
+    // counts and reports of a set cover exactly the tasks of its types
+    const TaskStats stats = together.stats();
+    ASSERT_TEST(stats.getCountByType(engineering) == 12);
+    ASSERT_TEST(stats.getCountByType(TaskTypeSet::all()) == stats.getTotalCount());
+    std::ostringstream setReport;
+    together.snapshot().printTasksByType(engineering, setReport);
+    std::ostringstream allReport;
+    together.snapshot().printAllTasks(allReport);
+    std::istringstream allLines(allReport.str());
+    std::string expectedReport;
+    for (std::string line; std::getline(allLines, line);)
+    {
+        if (line.find("Type: Development") != std::string::npos || line.find("Type: Testing") != std::string::npos ||
+            line.find("Type: Maintenance") != std::string::npos)
+        {
+            expectedReport += line + "\n";
+        }
+    }
+    ASSERT_TEST(setReport.str() == expectedReport);
+
+    return true;
+}
+
+bool testTaskManagerDescriptionSearch()
+{
+    ASSERT_TEST(DescriptionIndex::tokenize("Fix the LOGIN bug, fix-it 2day!") ==
+                std::vector<std::string>({"fix", "the", "login", "bug", "it", "2day"}));
+
+    TaskManager manager;
+    manager.enableDescriptionIndex();
+    manager.assignTask("Alice", Task(10, "Fix login bug"));
+    manager.assignTask("Alice", Task(50, "login page"));
+    manager.assignTask("Bob", Task(50, "Bug in LOGIN"));
+    std::vector<Task> found = manager.searchDescriptions("login bug", 5);
+    ASSERT_TEST(found.size() == 2 && found[0].getId() == 2 && found[1].getId() == 0);
+    found = manager.searchDescriptions("login", 2);
+    ASSERT_TEST(found.size() == 2 && found[0].getId() == 1 && found[1].getId() == 2);
+    manager.bumpPriorityByType(TaskType::General, 60);
+    manager.assignTask("Bob", Task(100, "login"));
+    found = manager.searchDescriptions("login", 2);
+    ASSERT_TEST(found.size() == 2 && found[0].getId() == 1 && found[0].getPriority() == 100);
+    ASSERT_TEST(found[0].getDescription() == "login page" && found[1].getId() == 2);
+    ASSERT_TEST(manager.searchDescriptions("login fix", 5)[0].getPriority() == 70);
+    ASSERT_TEST(manager.searchDescriptions("logout", 5).empty() && manager.searchDescriptions("login", 0).empty());
+    ASSERT_TEST(manager.memoryUsage().searchIndexBytes > 0 && TaskManager().memoryUsage().searchIndexBytes == 0);
+
+    // the index gives what scanning every task gives, through bumps, moves and enough completions to compact it
+    TaskManager indexed;
+    TaskManager scanned;
+    const std::string words[] = {"login", "bug", "release", "docs", "review", "deploy"};
+    const std::string names[] = {"Alice", "Bob", "Carol"};
+    const std::string queries[] = {"login", "LOGIN bug", "review 2", "deploy docs 3", "nothing", "", "1"};
+    auto sameResults = [&]() {
+        for (const std::string &query : queries)
+        {
+            for (int k : {1, 5, 100})
+            {
+                const std::vector<Task> fromIndex = indexed.searchDescriptions(query, k);
+                const std::vector<Task> fromScan = scanned.searchDescriptions(query, k);
+                const bool same = std::equal(fromIndex.begin(), fromIndex.end(), fromScan.begin(), fromScan.end(),
+                                             [](const Task &a, const Task &b) {
+                                                 return a.getId() == b.getId() &&
+                                                        a.getPriority() == b.getPriority() &&
+                                                        a.getDescription() == b.getDescription();
+                                             });
+                if (!same)
+                {
+                    return false;
+                }
+            }
+        }
+        return true;
+    };
+    for (int i = 0; i < 60; ++i)
+    {
+        if (i == 30)
+        {
+            indexed.enableDescriptionIndex();
+            ASSERT_TEST(sameResults());
+        }
+        const Task task(i * 37 % 101, static_cast<TaskType>(i % NUM_TASK_TYPES),
+                        words[i % 6] + ", " + words[i / 6 % 6] + " #" + std::to_string(i % 4));
+        indexed.assignTask(names[i % 3], task);
+        scanned.assignTask(names[i % 3], task);
+    }
+    ASSERT_TEST(sameResults());
+    for (TaskManager *cur : {&indexed, &scanned})
+    {
+        cur->bumpPriorityByType(TaskType::Development, 15);
+        cur->completeTask("Alice");
+        cur->bumpPriorityByType({TaskType::Meeting, TaskType::Testing}, 30);
+        cur->reassignAllTasks("Bob", "Carol");
+    }
+    ASSERT_TEST(sameResults());
+    for (int i = 0; i < 35; ++i)
+    {
+        indexed.completeTask(i % 2 ? "Alice" : "Carol");
+        scanned.completeTask(i % 2 ? "Alice" : "Carol");
+        indexed.bumpPriorityByType(TaskTypeSet::all(), 1);
+        scanned.bumpPriorityByType(TaskTypeSet::all(), 1);
+    }
+    ASSERT_TEST(sameResults());
+    ASSERT_TEST(!indexed.searchDescriptions("login", 100).empty());
+
+    // the index follows the live tasks - churning through many more tasks than are ever live does not grow it
+    TaskManager churned;
+    churned.enableDescriptionIndex();
+    for (int i = 0; i < 10; ++i)
+    {
+        churned.assignTask("Alice", Task(i, words[i % 6] + " " + words[(i + 1) % 6]));
+    }
+    const std::size_t liveBytes = churned.memoryUsage().searchIndexBytes;
+    for (int i = 0; i < 20000; ++i)
+    {
+        churned.assignTask("Alice", Task(i % 101, words[i % 6] + " " + words[(i + 1) % 6]));
+        churned.completeTask("Alice");
+    }
+    ASSERT_TEST(churned.memoryUsage().searchIndexBytes <= 2 * liveBytes);
+    ASSERT_TEST(churned.searchDescriptions(words[0], 100).size() <= 10);
+
+    return true;
+}
+
+bool testTaskManagerCapacity()
+{
+    for (TaskStorage storage : {TaskStorage::List, TaskStorage::Buckets})
+    {
+        Person person("Alice", storage);
+        std::vector<int> evictedIds;
+        auto onEvicted = [&evictedIds](const Task &task) { evictedIds.push_back(task.getId()); };
+        person.setCapacity(2);
+        const int priorities[] = {10, 50, 30, 5, 40};
+        for (int i = 0; i < 5; ++i)
+        {
+            Task task(priorities[i], TaskType::General);
+            task.setId(i);
+            person.assignTask(task, onEvicted);
+        }
+        // the lowest task goes - the new one itself when it is the lowest
+        ASSERT_TEST(evictedIds == std::vector<int>({0, 3, 2}));
+        ASSERT_TEST(person.stats().getTotalCount() == 2 && person.getLowestPriorityTask().getId() == 4);
+        person.setCapacity(1, onEvicted);
+        ASSERT_TEST(evictedIds.back() == 4 && person.getHighestPriorityTask().getId() == 1);
+        person.setCapacity(0);
+        for (int i = 0; i < 3; ++i)
+        {
+            Task task(i, TaskType::General);
+            task.setId(5 + i);
+            person.assignTask(task);
+        }
+        ASSERT_TEST(person.stats().getTotalCount() == 4 && evictedIds.size() == 4);
+    }
+
+    TaskManager manager;
+    std::vector<std::pair<std::string, int>> evicted;
+    manager.setEvictionCallback([&manager, &evicted](const std::string &personName, const Task &task) {
+        evicted.push_back({personName, task.getId()});
+        if (personName == "Alice")
+        {
+            manager.assignTask("Overflow", task); // the manager is unlocked by now
+        }
+    });
+    auto events = manager.changeFeed().subscribe(64, BackpressurePolicy::Drop);
+    manager.setPersonCapacity("Alice", 2);
+    manager.assignTask("Alice", Task(10, TaskType::General, "first"));
+    manager.assignTask("Alice", Task(20, TaskType::Testing, "second"));
+    // a pending bump makes the first task the higher one - the eviction sees it
+    manager.bumpPriorityByType(TaskType::General, 50);
+    manager.assignTask("Alice", Task(30, TaskType::General, "third"));
+    ASSERT_TEST(evicted.size() == 1 && evicted[0] == std::make_pair(std::string("Alice"), 1));
+    ASSERT_TEST(manager.stats("Alice").getTotalCount() == 2 && manager.stats("Overflow").getTotalCount() == 1);
+    ASSERT_TEST(manager.stats().getTotalCount() == 3 && manager.stats().getCountByPriority(20) == 1);
+    ASSERT_TEST(manager.snapshotTasks("Overflow")->begin()->getDescription() == "second");
+    int evictions = 0;
+    ChangeEvent event;
+    while (events->poll(event))
+    {
+        evictions += event.type == ChangeType::TaskEvicted && event.personName == "Alice" && event.taskId == 1;
+    }
+    ASSERT_TEST(evictions == 1);
+
+    // moves trim the receiver, and the evicted tasks leave the description index
+    manager.enableDescriptionIndex();
+    for (int i = 0; i < 4; ++i)
+    {
+        manager.assignTask("Bob", Task(60 + i, "bob task"));
+    }
+    manager.reassignAllTasks("Bob", "Alice");
+    ASSERT_TEST(manager.stats("Alice").getTotalCount() == 2 && evicted.size() == 5);
+    ASSERT_TEST(manager.stats("Overflow").getTotalCount() == 5 && manager.stats().getTotalCount() == 7);
+    ASSERT_TEST(manager.searchDescriptions("bob", 10).size() == 4); // two with Alice, two more with Overflow
+    manager.setPersonCapacity("Overflow", 1);
+    ASSERT_TEST(manager.stats("Overflow").getTotalCount() == 1 && evicted.size() == 9);
+    ASSERT_TEST(manager.stats().getTotalCount() == manager.stats("Alice").getTotalCount() + 1);
+    ASSERT_TEST(manager.searchDescriptions("task", 10).size() == 3);
+
+    bool thrown = false;
+    try
+    {
+        manager.setPersonCapacity("Alice", -1);
+    }
+    catch (const std::invalid_argument &)
+    {
+        thrown = true;
+    }
+    ASSERT_TEST(thrown);
+
+    return true;
+}
+
+bool testTaskPipeline()
+{
+    TaskManager manager;
+    {
+        TaskPipeline pipeline(manager, 8);
+        // the commands of one producer are applied in its order
+        std::future<int> first = pipeline.assignTask("Alice", Task(30, "first"));
+        std::future<int> second = pipeline.assignTask("Alice", Task(50, "second"));
+        std::future<int> completed = pipeline.completeTask("Alice");
+        ASSERT_TEST(first.get() == 0 && second.get() == 1 && completed.get() == 1);
+        ASSERT_TEST(pipeline.completeTask("Nobody").get() == -1 && pipeline.completeTask("Alice").get() == 0);
+        std::future<int> failed = pipeline.completeTask("Alice");
+        bool thrown = false;
+        try
+        {
+            failed.get();
+        }
+        catch (const std::runtime_error &)
+        {
+            thrown = true;
+        }
+        ASSERT_TEST(thrown);
+        pipeline.assignTask("Alice", Task(10, TaskType::Testing));
+        pipeline.bumpPriorityByType(TaskType::Testing, 15).get();
+        ASSERT_TEST(manager.stats().getCountByPriority(25) == 1);
+    }
+
+    // producers on several threads - every assign gets its own id, and a producer completes its own tasks
+    const int numOfProducers = 4;
+    const int numOfCommands = 2000;
+    std::vector<std::vector<int>> assignedIds(numOfProducers);
+    std::vector<std::vector<int>> completedIds(numOfProducers);
+    {
+        TaskPipeline pipeline(manager, 64);
+        // a reader on its own thread, while the owner thread applies the batches - every read is of whole batches
+        std::atomic<bool> producing{true};
+        bool readsConsistent = true;
+        std::thread reader([&manager, &producing, &readsConsistent]() {
+            while (producing.load())
+            {
+                const TaskStats stats = manager.stats();
+                int total = 0;
+                for (int priority = Task::MIN_PRIORITY; priority <= Task::MAX_PRIORITY; ++priority)
+                {
+                    total += stats.getCountByPriority(priority);
+                }
+                readsConsistent = readsConsistent && total == stats.getTotalCount();
+                readsConsistent = readsConsistent && manager.memoryUsage().taskPayloadBytes % sizeof(Task) == 0;
+            }
+        });
+        std::vector<std::thread> producers;
+        for (int producer = 0; producer < numOfProducers; ++producer)
+        {
+            producers.emplace_back([&pipeline, &assignedIds, &completedIds, producer]() {
+                const std::string personName = "Producer" + std::to_string(producer);
+                std::vector<std::future<int>> assigned;
+                std::vector<std::future<int>> completed;
+                for (int i = 0; i < numOfCommands; ++i)
+                {
+                    if (i % 5 == 4)
+                    {
+                        completed.push_back(pipeline.completeTask(personName));
+                    }
+                    else
+                    {
+                        assigned.push_back(pipeline.assignTask(personName, Task(i % 101, "t")));
+                        pipeline.assignTask("Shared", Task(i % 101, "s")); // never waited for
+                    }
+                }
+                for (std::future<int> &id : assigned)
+                {
+                    assignedIds[producer].push_back(id.get());
+                }
+                for (std::future<int> &id : completed)
+                {
+                    completedIds[producer].push_back(id.get());
+                }
+            });
+        }
+        for (std::thread &producer : producers)
+        {
+            producer.join();
+        }
+        producing.store(false);
+        reader.join();
+        ASSERT_TEST(readsConsistent);
+    }
+
+    std::vector<int> allIds;
+    for (int producer = 0; producer < numOfProducers; ++producer)
+    {
+        const std::vector<int> &own = assignedIds[producer];
+        for (int id : completedIds[producer])
+        {
+            ASSERT_TEST(std::find(own.begin(), own.end(), id) != own.end());
+        }
+        ASSERT_TEST(manager.stats("Producer" + std::to_string(producer)).getTotalCount() ==
+                    numOfCommands * 3 / 5);
+        allIds.insert(allIds.end(), own.begin(), own.end());
+    }
+    std::sort(allIds.begin(), allIds.end());
+    ASSERT_TEST(std::adjacent_find(allIds.begin(), allIds.end()) == allIds.end());
+    // the destructor applied the assigns nobody waited for
+    ASSERT_TEST(manager.stats("Shared").getTotalCount() == numOfProducers * numOfCommands * 4 / 5);
+
+    return true;
+}
+
+bool testTaskServer()
+{
+    // the wire format on its own - a frame is only taken once it fully arrived
+    protocol::Request search;
+    search.id = 7;
+    search.opcode = protocol::Opcode::Search;
+    search.query = "login bug";
+    search.k = 3;
+    std::vector<std::uint8_t> frame;
+    protocol::encodeRequest(search, frame);
+    ASSERT_TEST(protocol::frameSize(frame.data(), frame.size() - 1) == 0);
+    ASSERT_TEST(protocol::frameSize(frame.data(), frame.size()) == frame.size());
+    const protocol::Request decoded = protocol::decodeRequest(frame.data() + protocol::FRAME_HEADER_SIZE,
+                                                              frame.size() - protocol::FRAME_HEADER_SIZE);
+    ASSERT_TEST(decoded.id == 7 && decoded.opcode == protocol::Opcode::Search && decoded.query == "login bug" &&
+                decoded.k == 3);
+
+    TaskManager manager(10, TaskStorage::Buckets);
+    manager.enableDescriptionIndex();
+    const std::string socketPath = "/tmp/matam_hw3_test_" + std::to_string(getpid()) + ".sock";
+    TaskServer server(manager, socketPath);
+    std::thread owner([&server]() { server.run(); });
+    bool passed = true;
+    {
+        // pipelined - everything is sent before the first response is read, and answered in order
+        TaskClient client(socketPath);
+        const int priorities[] = {30, 50, 10};
+        const char *descriptions[] = {"write docs", "fix login bug", "triage bug reports"};
+        for (std::uint32_t i = 0; i < 3; ++i)
+        {
+            protocol::Request assign;
+            assign.id = i;
+            assign.personName = "Alice";
+            assign.task = Task(priorities[i], TaskType::Testing, descriptions[i]);
+            client.send(assign);
+        }
+        protocol::Request complete;
+        complete.id = 3;
+        complete.opcode = protocol::Opcode::Complete;
+        complete.personName = "Alice";
+        client.send(complete);
+        protocol::Request bump;
+        bump.id = 4;
+        bump.opcode = protocol::Opcode::Bump;
+        bump.types = TaskType::Testing;
+        bump.amount = 5;
+        client.send(bump);
+        protocol::Request stats;
+        stats.id = 5;
+        stats.opcode = protocol::Opcode::Stats;
+        client.send(stats);
+        search.id = 6;
+        search.query = "bug";
+        client.send(search);
+
+        for (std::uint32_t i = 0; i < 3; ++i)
+        {
+            const protocol::Response assigned = client.receive();
+            passed = passed && assigned.id == i && assigned.status == protocol::Status::Ok &&
+                     assigned.taskId == static_cast<int>(i);
+        }
+        passed = passed && client.receive().taskId == 1 && client.receive().id == 4;
+        const protocol::Response counts = client.receive();
+        passed = passed && counts.total == 2 && counts.countsByType[static_cast<int>(TaskType::Testing)] == 2;
+        const protocol::Response found = client.receive();
+        passed = passed && found.tasks.size() == 1 && found.tasks[0].getId() == 2 &&
+                 found.tasks[0].getPriority() == 15 && found.tasks[0].getDescription() == "triage bug reports";
+
+        // a failed request is answered with its error, and the connection goes on
+        complete.personName = "Nobody";
+        passed = passed && client.call(complete).taskId == -1;
+        complete.personName = "Alice";
+        passed = passed && client.call(complete).taskId == 0 && client.call(complete).taskId == 2;
+        const protocol::Response failed = client.call(complete);
+        passed = passed && failed.status == protocol::Status::Error && !failed.error.empty();
+    }
+    {
+        // a malformed frame closes its connection, and only its own
+        TaskClient broken(socketPath);
+        protocol::Request unknown;
+        unknown.opcode = static_cast<protocol::Opcode>(99);
+        bool closed = false;
+        try
+        {
+            broken.call(unknown);
+        }
+        catch (const protocol::ProtocolError &)
+        {
+            closed = true;
+        }
+        TaskClient client(socketPath);
+        protocol::Request assign;
+        assign.personName = "Bob";
+        passed = passed && closed && client.call(assign).taskId == 3;
+    }
+    server.stop();
+    owner.join();
+    ASSERT_TEST(passed);
+    ASSERT_TEST(manager.stats().getTotalCount() == 1 && manager.stats("Bob").getTotalCount() == 1);
+
+    return true;
+}
+
+// whether a shared-memory reader sees exactly what the TaskManager has
+bool sharedContentsMatch(const TaskManager &manager, const SharedTaskReader &reader)
+{
+    const TaskManagerSnapshot snapshot = manager.snapshot();
+    const SharedTaskReader::Contents contents = reader.read();
+    if (contents.version != snapshot.getVersion() ||
+        static_cast<int>(contents.persons.size()) != snapshot.getNumOfPersons())
+    {
+        return false;
+    }
+    for (int i = 0; i < snapshot.getNumOfPersons(); ++i)
+    {
+        const std::vector<Task> &shared = contents.persons[i].second;
+        const SortedList<Task> &tasks = snapshot.getTasks(i);
+        if (contents.persons[i].first != snapshot.getPersonName(i) ||
+            static_cast<int>(shared.size()) != tasks.length())
+        {
+            return false;
+        }
+        auto sharedTask = shared.begin();
+        for (const Task &task : tasks)
+        {
+            if (sharedTask->getId() != task.getId() || sharedTask->getPriority() != task.getPriority() ||
+                sharedTask->getType() != task.getType() || sharedTask->getDescription() != task.getDescription())
+            {
+                return false;
+            }
+            ++sharedTask;
+        }
+    }
+    return true;
+}
+
+bool testTaskManagerSharedMemory()
+{
+    const std::string segmentName = "/matam_hw3_test_" + std::to_string(getpid());
+    TaskManager manager(4, TaskStorage::Buckets);
+    manager.assignTask("Alice", Task(40, TaskType::Testing, "assigned before the segment"));
+    manager.enableSharedMemory(segmentName, 1 << 20);
+    SharedTaskReader reader(segmentName);
+    ASSERT_TEST(sharedContentsMatch(manager, reader));
+
+    // every kind of mutation shows in the segment
+    manager.assignTask("Alice", Task(70, TaskType::Documentation, "write the docs"));
+    manager.assignTasks("Bob", {Task(20, TaskType::Testing, "t1"), Task(90, TaskType::General, "")});
+    ASSERT_TEST(sharedContentsMatch(manager, reader));
+    manager.bumpPriorityByType(TaskType::Testing, 75);
+    ASSERT_TEST(sharedContentsMatch(manager, reader) && reader.readTasks("Bob")[0].getId() == 2);
+    ASSERT_TEST(manager.completeTask("Alice") == 0 && sharedContentsMatch(manager, reader));
+    manager.reassignAllTasks("Alice", "Carol");
+    ASSERT_TEST(sharedContentsMatch(manager, reader) && reader.readTasks("Alice").empty());
+    manager.setPersonCapacity("Carol", 2);
+    manager.assignTasks("Carol", {Task(10, "evicted"), Task(95, "kept")});
+    ASSERT_TEST(sharedContentsMatch(manager, reader));
+    manager.mergePersons("Carol", "Bob");
+    ASSERT_TEST(sharedContentsMatch(manager, reader) && reader.read().persons.size() == 2);
+    manager.assignTask("Dave", Task(5, "idle"));
+    manager.rebalance();
+    ASSERT_TEST(sharedContentsMatch(manager, reader));
+    manager.mergePersons("Erin", "Carol");
+    ASSERT_TEST(sharedContentsMatch(manager, reader) && reader.readTasks("Carol").empty());
+    ASSERT_TEST(reader.readTasks("Nobody").empty());
+
+    // another process reads while this one writes - every read is a whole mutation: tasks move between two
+    // persons as a whole, and are assigned two at a time
+    const int numOfRounds = 2000;
+    TaskManager pingPong;
+    pingPong.enableSharedMemory(segmentName + "_pp", 4 << 20);
+    const pid_t child = fork();
+    if (child == 0)
+    {
+        int exitCode = 0;
+        try
+        {
+            SharedTaskReader childReader(segmentName + "_pp");
+            std::size_t numOfTasks = 0;
+            while (numOfTasks < 2 * numOfRounds && exitCode == 0)
+            {
+                const SharedTaskReader::Contents contents = childReader.read();
+                numOfTasks = 0;
+                int numOfHolders = 0;
+                for (const auto &person : contents.persons)
+                {
+                    numOfTasks += person.second.size();
+                    numOfHolders += !person.second.empty();
+                    for (std::size_t i = 1; i < person.second.size(); ++i)
+                    {
+                        exitCode |= (person.second[i] > person.second[i - 1]) ? 1 : 0;
+                    }
+                }
+                exitCode |= (numOfTasks % 2 != 0 || numOfHolders > 1) ? 2 : 0;
+            }
+        }
+        catch (...)
+        {
+            exitCode = 4;
+        }
+        _exit(exitCode);
+    }
+    for (int round = 0; round < numOfRounds; ++round)
+    {
+        const char *holder = (round % 2 == 0) ? "Ping" : "Pong";
+        pingPong.assignTasks(holder, {Task(round % 101, TaskType::Testing, "a"), Task(50, TaskType::General, "b")});
+        if (round % 7 == 0)
+        {
+            pingPong.bumpPriorityByType(TaskType::Testing, 1);
+        }
+        pingPong.reassignAllTasks(holder, (round % 2 == 0) ? "Pong" : "Ping");
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    ASSERT_TEST(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+    return true;
+}
+
+bool testTraceReplay()
+{
+    trace::GeneratorOptions options;
+    options.numOfOperations = 3000;
+    options.numOfPersons = 8;
+    options.personSkew = 1;
+    options.types = {TaskType::Meeting, TaskType::Testing};
+    options.priorities = trace::PriorityDistribution::Bimodal;
+    options.completePart = 45;
+    options.reassignPart = 5;
+    options.seed = 7;
+    const std::vector<trace::Operation> operations = trace::generate(options);
+    ASSERT_TEST(operations.size() == 3000 && operations == trace::generate(options));
+    long long expectedNumOfTasks = 0;
+    for (const trace::Operation &operation : operations)
+    {
+        expectedNumOfTasks += (operation.kind == trace::OperationKind::Assign) ? 1 : 0;
+        expectedNumOfTasks -= (operation.kind == trace::OperationKind::Complete) ? 1 : 0;
+        ASSERT_TEST((operation.types & TaskTypeSet{TaskType::Meeting, TaskType::Testing}) == operation.types);
+    }
+
+    // a written trace reads back the same
+    std::stringstream file;
+    trace::write(file, operations, "generated by\ntestTraceReplay");
+    ASSERT_TEST(file.str().rfind("# generated by\n# testTraceReplay\n", 0) == 0);
+    ASSERT_TEST(trace::read(file) == operations);
+
+    std::istringstream handWritten("# comments and empty lines are skipped\n\n"
+                                   "assign Alice 30 Research read  two spaces kept\n"
+                                   "bump Research,CustomerSupport 5\n"
+                                   "reassign Alice Bob\n"
+                                   "complete Bob\n"
+                                   "complete Nobody\n");
+    const std::vector<trace::Operation> handOperations = trace::read(handWritten);
+    ASSERT_TEST(handOperations.size() == 5 && handOperations[0].description == "read  two spaces kept");
+    ASSERT_TEST(handOperations[1].types == (TaskTypeSet{TaskType::Research, TaskType::CustomerSupport}));
+    ASSERT_TEST(handOperations[2].otherPersonName == "Bob");
+    for (const char *malformed : {"complete Alice\nassign Alice high General\n", "complete Alice\nfinish Alice\n",
+                                  "complete Alice\nbump Meeting,Nothing 1\n", "complete Alice\ncomplete Alice Bob\n"})
+    {
+        std::istringstream input(malformed);
+        bool thrown = false;
+        try
+        {
+            trace::read(input);
+        }
+        catch (const trace::TraceError &e)
+        {
+            thrown = std::string(e.what()).rfind("line 2: ", 0) == 0;
+        }
+        ASSERT_TEST(thrown);
+    }
+
+    // a generated trace replays with no failures, the same on both storages
+    for (TaskStorage storage : {TaskStorage::List, TaskStorage::Buckets})
+    {
+        TaskManager manager(options.numOfPersons, storage);
+        const trace::ReplayResult result = trace::replay(manager, operations);
+        std::size_t numOfLatencies = 0;
+        for (const std::vector<double> &latencies : result.latencies)
+        {
+            numOfLatencies += latencies.size();
+        }
+        ASSERT_TEST(numOfLatencies == operations.size() && result.numOfFailures == 0);
+        ASSERT_TEST(manager.stats().getTotalCount() == expectedNumOfTasks);
+        ASSERT_TEST(result.peakNumOfTasks >= expectedNumOfTasks && result.memoryAtPeak.total() > 0);
+    }
+    TaskManager handManager(3);
+    const trace::ReplayResult handResult = trace::replay(handManager, handOperations);
+    ASSERT_TEST(handResult.numOfFailures == 1 && handManager.stats().getTotalCount() == 0);
+
+    return true;
+}
+
+bool testMetricsHistogram()
+{
+    // bucket 0 holds 0, bucket 1 holds 1, and bucket i > 1 holds (2^(i-2), 2^(i-1)]
+    mtm::metrics::Log2Histogram histogram;
+    for (std::uint64_t value : {0, 1, 2, 3, 4, 5, 1024})
+    {
+        histogram.record(value);
+    }
+    const std::uint64_t expectedBuckets[] = {1, 1, 1, 2, 1, 0, 0, 0, 0, 0, 0, 1, 0};
+    for (int i = 0; i < 13; ++i)
+    {
+        ASSERT_TEST(histogram.getBucket(i) == expectedBuckets[i]);
+    }
+    ASSERT_TEST(mtm::metrics::Log2Histogram::bucketUpperBound(3) == 4);
+    ASSERT_TEST(histogram.getCount() == 7 && histogram.getSum() == 1039);
+
+#ifdef MTM_METRICS
+    // the same values through the registry - the lines are compared before and after, other tests may have
+    // recorded into it already
+    auto sample = [](const string &text, const string &series) {
+        const std::size_t position = text.find("\n" + series + " ");
+        return position == string::npos ? ~std::uint64_t(0) : std::stoull(text.substr(position + series.size() + 2));
+    };
+    std::ostringstream before;
+    mtm::metrics::writePrometheus(before);
+    for (std::uint64_t value : {0, 1, 2, 3, 4, 5, 1024})
+    {
+        mtm::metrics::registry().insertComparisons.record(value);
+    }
+    std::ostringstream after;
+    mtm::metrics::writePrometheus(after);
+
+    const std::vector<std::pair<string, std::uint64_t>> expectedLines = {
+        {"sortedlist_insert_comparisons_bucket{le=\"0\"}", 1},
+        {"sortedlist_insert_comparisons_bucket{le=\"1\"}", 2},
+        {"sortedlist_insert_comparisons_bucket{le=\"2\"}", 3},
+        {"sortedlist_insert_comparisons_bucket{le=\"4\"}", 5},
+        {"sortedlist_insert_comparisons_bucket{le=\"8\"}", 6},
+        {"sortedlist_insert_comparisons_bucket{le=\"512\"}", 6},
+        {"sortedlist_insert_comparisons_bucket{le=\"1024\"}", 7},
+        {"sortedlist_insert_comparisons_bucket{le=\"+Inf\"}", 7},
+        {"sortedlist_insert_comparisons_count", 7},
+        {"sortedlist_insert_comparisons_sum", 1039}
+    };
+    for (const auto &[series, expected] : expectedLines)
+    {
+        ASSERT_TEST(sample(before.str(), series) != ~std::uint64_t(0));
+        ASSERT_TEST(sample(after.str(), series) - sample(before.str(), series) == expected);
+    }
+#endif
+
+    return true;
+}
+
 bool testCopyConstructorExceptionSafety()
 {
     try
@@ -472,7 +2362,31 @@ bool testTaskManagerAssignTask()
     X(testTaskManager)                       \
     X(testCopyConstructorExceptionSafety)    \
     X(testTaskManagerAssignTask)             \
-    X(testTaskManagerPrintTasksByType)
+    X(testTaskManagerPrintTasksByType)       \
+    X(testListViews)                         \
+    X(testListReverseIteration)              \
+    X(testListSegments)                      \
+    X(testTaskManagerStats)                  \
+    X(testTaskManagerMemoryUsage)            \
+    X(testTaskManagerChangeFeed)             \
+    X(testPersonSnapshot)                    \
+    X(testTaskManagerSnapshotConsistency)    \
+    X(testListUnrolled)                      \
+    X(testBlockSearch)                       \
+    X(testListStrongGuarantee)               \
+    X(testListSpliceMergeSplit)              \
+    X(testTaskManagerReassign)               \
+    X(testTaskManagerRebalance)              \
+    X(testTaskManagerBuckets)                \
+    X(testTaskManagerLazyBumps)              \
+    X(testTaskTypeSet)                       \
+    X(testTaskManagerDescriptionSearch)      \
+    X(testTaskManagerCapacity)               \
+    X(testTaskPipeline)                      \
+    X(testTaskServer)                        \
+    X(testTaskManagerSharedMemory)           \
+    X(testTraceReplay)                       \
+    X(testMetricsHistogram)
 
 
 testFunc tests[] = {
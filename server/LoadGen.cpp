@@ -0,0 +1,204 @@
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "TaskClient.h"
+
+/**
+ * taskmanager_loadgen - drives a taskmanager_server and reports its throughput and latency percentiles.
+ *
+ *   taskmanager_loadgen --socket <path> [--connections <n>] [--depth <n>] [--requests <n>] [--persons <n>]
+ *                       [--seed <n>]
+ *
+ * --connections   client connections, one thread each (default 4)
+ * --depth         requests every connection keeps in flight - 1 is a plain request/response loop (default 32)
+ * --requests      requests sent by every connection (default 100000)
+ * --persons       persons the requests are spread over, per connection (default 10)
+ * --seed          seed of the request generator (default 1234, fixed so runs are reproducible)
+ *
+ * Every connection sends 50% assigns, 44% completes, 5% stats and 1% bumps. A request's latency is from
+ * the moment it is queued on its connection to the moment its response is read.
+ */
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    struct LoadOptions {
+        string socketPath;
+        int connections = 4;
+        int depth = 32;
+        int requests = 100000;
+        int persons = 10;
+        unsigned int seed = 1234;
+    };
+
+    LoadOptions parseOptions(int argc, char** argv) {
+        LoadOptions options;
+        for (int i = 1; i < argc; ++i) {
+            const string flag = argv[i];
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("missing value for " + flag);
+            }
+            const string value = argv[++i];
+            if (flag == "--socket") {
+                options.socketPath = value;
+            }
+            else if (flag == "--connections") {
+                options.connections = std::stoi(value);
+            }
+            else if (flag == "--depth") {
+                options.depth = std::stoi(value);
+            }
+            else if (flag == "--requests") {
+                options.requests = std::stoi(value);
+            }
+            else if (flag == "--persons") {
+                options.persons = std::stoi(value);
+            }
+            else if (flag == "--seed") {
+                options.seed = static_cast<unsigned int>(std::stoul(value));
+            }
+            else {
+                throw std::invalid_argument("unknown option " + flag);
+            }
+        }
+        if (options.socketPath.empty()) {
+            throw std::invalid_argument("--socket is required");
+        }
+        if (options.connections <= 0 || options.depth <= 0 || options.requests <= 0 || options.persons <= 0) {
+            throw std::invalid_argument("--connections, --depth, --requests and --persons must be positive");
+        }
+        return options;
+    }
+
+    // generated up front, so only sending and receiving are measured
+    std::vector<protocol::Request> generateRequests(const LoadOptions& options, int connection) {
+        std::mt19937 generator(options.seed + connection);
+        std::uniform_int_distribution<int> percent(0, 99);
+        std::uniform_int_distribution<int> person(0, options.persons - 1);
+        std::uniform_int_distribution<int> priority(Task::MIN_PRIORITY, Task::MAX_PRIORITY);
+        std::uniform_int_distribution<int> type(0, NUM_TASK_TYPES - 1);
+
+        std::vector<protocol::Request> requests(options.requests);
+        for (int i = 0; i < options.requests; ++i) {
+            protocol::Request& request = requests[i];
+            request.id = static_cast<std::uint32_t>(i);
+            request.personName = "c" + std::to_string(connection) + "p" + std::to_string(person(generator));
+            const int draw = percent(generator);
+            if (draw < 50) {
+                request.opcode = protocol::Opcode::Assign;
+                request.task = Task(priority(generator), static_cast<TaskType>(type(generator)), "load");
+            }
+            else if (draw < 94) {
+                request.opcode = protocol::Opcode::Complete;
+            }
+            else if (draw < 99) {
+                request.opcode = protocol::Opcode::Stats;
+            }
+            else {
+                request.opcode = protocol::Opcode::Bump;
+                request.types = TaskTypeSet(static_cast<TaskType>(type(generator)));
+                request.amount = 1;
+            }
+        }
+        return requests;
+    }
+
+    struct ConnectionResult {
+        std::vector<double> latencies; // microseconds, by request
+        int errors = 0;
+    };
+
+    void runConnection(const LoadOptions& options, const std::vector<protocol::Request>& requests,
+                       ConnectionResult& result) {
+        TaskClient client(options.socketPath);
+        std::vector<Clock::time_point> sentAt(requests.size());
+        result.latencies.resize(requests.size());
+        std::size_t numOfSent = 0;
+        for (; numOfSent < requests.size() && numOfSent < static_cast<std::size_t>(options.depth); ++numOfSent) {
+            sentAt[numOfSent] = Clock::now();
+            client.send(requests[numOfSent]);
+        }
+        for (std::size_t numOfReceived = 0; numOfReceived < requests.size(); ++numOfReceived) {
+            const protocol::Response response = client.receive();
+            const Clock::time_point now = Clock::now();
+            const std::chrono::duration<double, std::micro> latency = now - sentAt[response.id];
+            result.latencies[response.id] = latency.count();
+            if (response.status == protocol::Status::Error) {
+                result.errors++;
+            }
+            if (numOfSent < requests.size()) {
+                sentAt[numOfSent] = now;
+                client.send(requests[numOfSent++]);
+            }
+        }
+    }
+
+    double percentile(std::vector<double>& sorted, double fraction) {
+        const std::size_t index = static_cast<std::size_t>(fraction * (sorted.size() - 1));
+        return sorted[index];
+    }
+}
+
+int main(int argc, char** argv) {
+    try {
+        const LoadOptions options = parseOptions(argc, argv);
+        std::vector<std::vector<protocol::Request>> requests;
+        for (int connection = 0; connection < options.connections; ++connection) {
+            requests.push_back(generateRequests(options, connection));
+        }
+
+        std::vector<ConnectionResult> results(options.connections);
+        std::vector<std::thread> threads;
+        std::vector<string> failures(options.connections);
+        const Clock::time_point start = Clock::now();
+        for (int connection = 0; connection < options.connections; ++connection) {
+            threads.emplace_back([&, connection]() {
+                try {
+                    runConnection(options, requests[connection], results[connection]);
+                }
+                catch (const std::exception& e) {
+                    failures[connection] = e.what();
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        for (const string& failure : failures) {
+            if (!failure.empty()) {
+                throw std::runtime_error(failure);
+            }
+        }
+
+        std::vector<double> latencies;
+        int errors = 0;
+        for (const ConnectionResult& result : results) {
+            latencies.insert(latencies.end(), result.latencies.begin(), result.latencies.end());
+            errors += result.errors;
+        }
+        std::sort(latencies.begin(), latencies.end());
+        std::cout << std::fixed << std::setprecision(1)
+                  << "connections " << options.connections << ", depth " << options.depth << ", "
+                  << latencies.size() << " requests in " << std::setprecision(3) << seconds << " s" << std::endl
+                  << std::setprecision(0) << "throughput  " << latencies.size() / seconds << " requests/sec"
+                  << std::endl
+                  << std::setprecision(1) << "latency us  p50 " << percentile(latencies, 0.50)
+                  << "  p99 " << percentile(latencies, 0.99) << "  p99.9 " << percentile(latencies, 0.999)
+                  << "  max " << latencies.back() << std::endl
+                  << "errors      " << errors << " (completes of persons with no tasks left)" << std::endl;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "taskmanager_loadgen: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,295 @@
+#include "Protocol.h"
+
+namespace protocol {
+
+    namespace {
+        // ------------------------------- writing ------------------------------- //
+
+        class Writer {
+            std::vector<std::uint8_t>& m_out;
+            std::size_t m_frameStart;
+
+        public:
+            // starts a frame - its length is filled in by finish()
+            explicit Writer(std::vector<std::uint8_t>& out) : m_out(out), m_frameStart(out.size()) {
+                m_out.resize(m_out.size() + FRAME_HEADER_SIZE);
+            }
+
+            void u8(std::uint8_t value) {
+                m_out.push_back(value);
+            }
+
+            void u16(std::uint16_t value) {
+                m_out.push_back(static_cast<std::uint8_t>(value));
+                m_out.push_back(static_cast<std::uint8_t>(value >> 8));
+            }
+
+            void u32(std::uint32_t value) {
+                for (int shift = 0; shift < 32; shift += 8) {
+                    m_out.push_back(static_cast<std::uint8_t>(value >> shift));
+                }
+            }
+
+            void i32(int value) {
+                u32(static_cast<std::uint32_t>(value));
+            }
+
+            void str(const string& value) {
+                if (value.size() > 0xffff) {
+                    throw ProtocolError("A string in a frame must be shorter than 64 KiB");
+                }
+                u16(static_cast<std::uint16_t>(value.size()));
+                m_out.insert(m_out.end(), value.begin(), value.end());
+            }
+
+            void finish() {
+                const std::size_t length = m_out.size() - m_frameStart - FRAME_HEADER_SIZE;
+                for (std::size_t i = 0; i < FRAME_HEADER_SIZE; ++i) {
+                    m_out[m_frameStart + i] = static_cast<std::uint8_t>(length >> (8 * i));
+                }
+            }
+        };
+
+        // ------------------------------- reading ------------------------------- //
+
+        class Reader {
+            const std::uint8_t* m_position;
+            const std::uint8_t* m_end;
+
+            void need(std::size_t bytes) const {
+                if (static_cast<std::size_t>(m_end - m_position) < bytes) {
+                    throw ProtocolError("Truncated frame");
+                }
+            }
+
+        public:
+            Reader(const std::uint8_t* data, std::size_t size) : m_position(data), m_end(data + size) {}
+
+            std::uint8_t u8() {
+                need(1);
+                return *m_position++;
+            }
+
+            std::uint16_t u16() {
+                need(2);
+                const std::uint16_t value = static_cast<std::uint16_t>(m_position[0] | (m_position[1] << 8));
+                m_position += 2;
+                return value;
+            }
+
+            std::uint32_t u32() {
+                need(4);
+                std::uint32_t value = 0;
+                for (int i = 0; i < 4; ++i) {
+                    value |= static_cast<std::uint32_t>(m_position[i]) << (8 * i);
+                }
+                m_position += 4;
+                return value;
+            }
+
+            int i32() {
+                return static_cast<int>(u32());
+            }
+
+            string str() {
+                const std::size_t length = u16();
+                need(length);
+                string value(reinterpret_cast<const char*>(m_position), length);
+                m_position += length;
+                return value;
+            }
+
+            Opcode opcode() {
+                const std::uint8_t value = u8();
+                if (value < static_cast<std::uint8_t>(Opcode::Assign) ||
+                    value > static_cast<std::uint8_t>(Opcode::Search)) {
+                    throw ProtocolError("Unknown opcode");
+                }
+                return static_cast<Opcode>(value);
+            }
+
+            TaskType taskType() {
+                const std::uint8_t value = u8();
+                if (value >= NUM_TASK_TYPES) {
+                    throw ProtocolError("Unknown task type");
+                }
+                return static_cast<TaskType>(value);
+            }
+
+            void finish() const {
+                if (m_position != m_end) {
+                    throw ProtocolError("Trailing bytes in frame");
+                }
+            }
+        };
+
+        TaskTypeSet typesOf(std::uint32_t bits) {
+            TaskTypeSet types;
+            for (int type = 0; type < NUM_TASK_TYPES; ++type) {
+                if ((bits >> type) & 1u) {
+                    types = types | TaskTypeSet(static_cast<TaskType>(type));
+                }
+            }
+            return types;
+        }
+    }
+
+    // ------------------------------- requests ------------------------------- //
+
+    void encodeRequest(const Request& request, std::vector<std::uint8_t>& out) {
+        Writer writer(out);
+        writer.u32(request.id);
+        writer.u8(static_cast<std::uint8_t>(request.opcode));
+        switch (request.opcode) {
+            case Opcode::Assign:
+                writer.str(request.personName);
+                writer.i32(request.task.getPriority());
+                writer.u8(static_cast<std::uint8_t>(request.task.getType()));
+                writer.str(request.task.getDescription());
+                break;
+            case Opcode::Complete:
+            case Opcode::Stats:
+                writer.str(request.personName);
+                break;
+            case Opcode::Bump:
+                writer.u32(request.types.bits());
+                writer.i32(request.amount);
+                break;
+            case Opcode::Search:
+                writer.str(request.query);
+                writer.i32(request.k);
+                break;
+        }
+        writer.finish();
+    }
+
+    Request decodeRequest(const std::uint8_t* payload, std::size_t size) {
+        Reader reader(payload, size);
+        Request request;
+        request.id = reader.u32();
+        request.opcode = reader.opcode();
+        switch (request.opcode) {
+            case Opcode::Assign: {
+                request.personName = reader.str();
+                const int priority = reader.i32();
+                const TaskType type = reader.taskType();
+                // Task clamps the priority into range itself
+                request.task = Task(priority, type, reader.str());
+                break;
+            }
+            case Opcode::Complete:
+            case Opcode::Stats:
+                request.personName = reader.str();
+                break;
+            case Opcode::Bump:
+                request.types = typesOf(reader.u32());
+                request.amount = reader.i32();
+                break;
+            case Opcode::Search:
+                request.query = reader.str();
+                request.k = reader.i32();
+                break;
+        }
+        reader.finish();
+        return request;
+    }
+
+    // ------------------------------- responses ------------------------------ //
+
+    void encodeResponse(const Response& response, std::vector<std::uint8_t>& out) {
+        Writer writer(out);
+        writer.u32(response.id);
+        writer.u8(static_cast<std::uint8_t>(response.opcode));
+        writer.u8(static_cast<std::uint8_t>(response.status));
+        if (response.status == Status::Error) {
+            writer.str(response.error);
+            writer.finish();
+            return;
+        }
+        switch (response.opcode) {
+            case Opcode::Assign:
+            case Opcode::Complete:
+                writer.i32(response.taskId);
+                break;
+            case Opcode::Bump:
+                break;
+            case Opcode::Stats:
+                writer.i32(response.total);
+                for (int type = 0; type < NUM_TASK_TYPES; ++type) {
+                    writer.i32(type < static_cast<int>(response.countsByType.size()) ? response.countsByType[type] : 0);
+                }
+                break;
+            case Opcode::Search:
+                writer.u32(static_cast<std::uint32_t>(response.tasks.size()));
+                for (const Task& task : response.tasks) {
+                    writer.i32(task.getId());
+                    writer.i32(task.getPriority());
+                    writer.u8(static_cast<std::uint8_t>(task.getType()));
+                    writer.str(task.getDescription());
+                }
+                break;
+        }
+        writer.finish();
+    }
+
+    Response decodeResponse(const std::uint8_t* payload, std::size_t size) {
+        Reader reader(payload, size);
+        Response response;
+        response.id = reader.u32();
+        response.opcode = reader.opcode();
+        const std::uint8_t status = reader.u8();
+        if (status > static_cast<std::uint8_t>(Status::Error)) {
+            throw ProtocolError("Unknown status");
+        }
+        response.status = static_cast<Status>(status);
+        if (response.status == Status::Error) {
+            response.error = reader.str();
+            reader.finish();
+            return response;
+        }
+        switch (response.opcode) {
+            case Opcode::Assign:
+            case Opcode::Complete:
+                response.taskId = reader.i32();
+                break;
+            case Opcode::Bump:
+                break;
+            case Opcode::Stats:
+                response.total = reader.i32();
+                for (int type = 0; type < NUM_TASK_TYPES; ++type) {
+                    response.countsByType.push_back(reader.i32());
+                }
+                break;
+            case Opcode::Search: {
+                const std::uint32_t numOfTasks = reader.u32();
+                for (std::uint32_t i = 0; i < numOfTasks; ++i) {
+                    const int id = reader.i32();
+                    const int priority = reader.i32();
+                    const TaskType type = reader.taskType();
+                    Task task(priority, type, reader.str());
+                    task.setId(id);
+                    response.tasks.push_back(task);
+                }
+                break;
+            }
+        }
+        reader.finish();
+        return response;
+    }
+
+    // --------------------------------- frames -------------------------------- //
+
+    std::size_t frameSize(const std::uint8_t* data, std::size_t size) {
+        if (size < FRAME_HEADER_SIZE) {
+            return 0;
+        }
+        std::uint32_t length = 0;
+        for (std::size_t i = 0; i < FRAME_HEADER_SIZE; ++i) {
+            length |= static_cast<std::uint32_t>(data[i]) << (8 * i);
+        }
+        if (length > MAX_FRAME_SIZE) {
+            throw ProtocolError("Frame larger than MAX_FRAME_SIZE");
+        }
+        return size - FRAME_HEADER_SIZE >= length ? FRAME_HEADER_SIZE + length : 0;
+    }
+}
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../Task.h"
+#include "../TaskTypeSet.h"
+
+using std::string;
+
+/**
+ * The wire format of the task server (see TaskServer).
+ *
+ * Every message is a frame - a 4 byte payload length, then the payload. All integers are little-endian, a
+ * string is a 2 byte length and its bytes.
+ *
+ *   request:  u32 requestId | u8 opcode | arguments
+ *   response: u32 requestId | u8 opcode | u8 status | result, or the error message if status is Error
+ *
+ *   opcode     arguments                                              result
+ *   Assign     name, i32 priority, u8 type, description               i32 task id
+ *   Complete   name                                                   i32 task id (-1 if there is no such person)
+ *   Bump       u32 types (bit i is TaskType i), i32 amount            -
+ *   Stats      name (empty for all persons)                           i32 total, i32 count of every type
+ *   Search     query, i32 k                                           u32 n, n x (i32 id, i32 priority, u8 type,
+ *                                                                     description)
+ *
+ * A client may send any number of requests without waiting (pipelining). The responses of a connection come
+ * in the order of its requests; the request id is only echoed, for the client's bookkeeping.
+ */
+namespace protocol {
+
+    enum class Opcode : std::uint8_t { Assign = 1, Complete, Bump, Stats, Search };
+
+    enum class Status : std::uint8_t { Ok, Error };
+
+    // larger frames are taken as a broken or hostile peer, and its connection is closed
+    constexpr std::uint32_t MAX_FRAME_SIZE = 1 << 20;
+    constexpr std::size_t FRAME_HEADER_SIZE = 4;
+
+    /**
+     * @brief A malformed frame - the connection it came on cannot be trusted any further.
+     */
+    class ProtocolError : public std::runtime_error {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    struct Request {
+        std::uint32_t id = 0;
+        Opcode opcode = Opcode::Assign;
+        string personName;                                // Assign, Complete, Stats
+        Task task{Task::MIN_PRIORITY, TaskType::General}; // Assign
+        TaskTypeSet types;                                // Bump
+        int amount = 0;                                   // Bump
+        string query;                                     // Search
+        int k = 0;                                        // Search
+    };
+
+    struct Response {
+        std::uint32_t id = 0;
+        Opcode opcode = Opcode::Assign;
+        Status status = Status::Ok;
+        string error;
+        int taskId = -1;                // Assign, Complete
+        int total = 0;                  // Stats
+        std::vector<int> countsByType;  // Stats, NUM_TASK_TYPES of them
+        std::vector<Task> tasks;        // Search
+    };
+
+    /**
+     * @brief Appends a request, as a frame, to a buffer.
+     *
+     * @param request The request to be encoded.
+     * @param out The buffer the frame is appended to.
+     * @throws ProtocolError If a string is longer than 65535 bytes.
+     */
+    void encodeRequest(const Request& request, std::vector<std::uint8_t>& out);
+
+    /**
+     * @brief Appends a response, as a frame, to a buffer.
+     *
+     * @param response The response to be encoded.
+     * @param out The buffer the frame is appended to.
+     * @throws ProtocolError If a string is longer than 65535 bytes.
+     */
+    void encodeResponse(const Response& response, std::vector<std::uint8_t>& out);
+
+    /**
+     * @brief Checks whether a buffer starts with a whole frame.
+     *
+     * @param data The buffered bytes.
+     * @param size The number of buffered bytes.
+     * @return std::size_t The size of the first frame, header included, or 0 if it has not fully arrived.
+     * @throws ProtocolError If the frame is larger than MAX_FRAME_SIZE.
+     */
+    std::size_t frameSize(const std::uint8_t* data, std::size_t size);
+
+    /**
+     * @brief Decodes the payload of a request frame.
+     *
+     * @param payload The payload - the frame without its header.
+     * @param size The size of the payload.
+     * @return Request The decoded request.
+     * @throws ProtocolError If the payload is truncated, too long or has an unknown opcode or task type.
+     */
+    Request decodeRequest(const std::uint8_t* payload, std::size_t size);
+
+    /**
+     * @brief Decodes the payload of a response frame.
+     *
+     * @param payload The payload - the frame without its header.
+     * @param size The size of the payload.
+     * @return Response The decoded response.
+     * @throws ProtocolError If the payload is truncated, too long or has an unknown opcode or task type.
+     */
+    Response decodeResponse(const std::uint8_t* payload, std::size_t size);
+}
@@ -0,0 +1,89 @@
+#include <csignal>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "TaskServer.h"
+#include "../TaskManager.h"
+
+/**
+ * taskmanager_server - serves one TaskManager over a Unix domain socket until SIGINT or SIGTERM.
+ *
+ *   taskmanager_server --socket <path> [--max-persons <n>] [--storage list|buckets] [--index on|off]
+ *
+ * --max-persons   the most persons the TaskManager holds (default 1000)
+ * --storage       how every person stores its tasks (default buckets - O(1) assign and complete)
+ * --index         whether descriptions are indexed for Search requests (default on)
+ */
+
+namespace {
+    TaskServer* g_server = nullptr;
+
+    void stopServer(int) {
+        if (g_server != nullptr) {
+            g_server->stop();
+        }
+    }
+
+    struct ServerOptions {
+        string socketPath;
+        int maxPersons = 1000;
+        TaskStorage storage = TaskStorage::Buckets;
+        bool indexDescriptions = true;
+    };
+
+    ServerOptions parseOptions(int argc, char** argv) {
+        ServerOptions options;
+        for (int i = 1; i < argc; ++i) {
+            const string flag = argv[i];
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("missing value for " + flag);
+            }
+            const string value = argv[++i];
+            if (flag == "--socket") {
+                options.socketPath = value;
+            }
+            else if (flag == "--max-persons") {
+                options.maxPersons = std::stoi(value);
+            }
+            else if (flag == "--storage" && (value == "list" || value == "buckets")) {
+                options.storage = (value == "list") ? TaskStorage::List : TaskStorage::Buckets;
+            }
+            else if (flag == "--index" && (value == "on" || value == "off")) {
+                options.indexDescriptions = (value == "on");
+            }
+            else {
+                throw std::invalid_argument("unknown option " + flag + " " + value);
+            }
+        }
+        if (options.socketPath.empty()) {
+            throw std::invalid_argument("--socket is required");
+        }
+        return options;
+    }
+}
+
+int main(int argc, char** argv) {
+    try {
+        const ServerOptions options = parseOptions(argc, argv);
+        TaskManager manager(options.maxPersons, options.storage);
+        if (options.indexDescriptions) {
+            manager.enableDescriptionIndex();
+        }
+        TaskServer server(manager, options.socketPath);
+
+        g_server = &server;
+        std::signal(SIGINT, stopServer);
+        std::signal(SIGTERM, stopServer);
+        std::cout << "taskmanager_server: listening on " << server.getSocketPath() << std::endl;
+        server.run();
+        g_server = nullptr;
+        std::cout << "taskmanager_server: stopped with " << manager.stats().getTotalCount() << " tasks" << std::endl;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "taskmanager_server: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,96 @@
+#include "TaskClient.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+TaskClient::TaskClient(const string& socketPath) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("The socket path must be 1 to " + std::to_string(sizeof(address.sun_path) - 1) +
+                                    " characters long");
+    }
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    m_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (m_fd < 0) {
+        throw std::system_error(errno, std::generic_category(), "socket");
+    }
+    if (connect(m_fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0) {
+        const int error = errno;
+        close(m_fd);
+        throw std::system_error(error, std::generic_category(), "connect");
+    }
+}
+
+TaskClient::~TaskClient() {
+    close(m_fd);
+}
+
+void TaskClient::send(const protocol::Request& request) {
+    protocol::encodeRequest(request, m_output);
+}
+
+void TaskClient::flush() {
+    std::size_t numOfSent = 0;
+    while (numOfSent < m_output.size()) {
+        const ssize_t count = ::send(m_fd, m_output.data() + numOfSent, m_output.size() - numOfSent, MSG_NOSIGNAL);
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count < 0) {
+            throw std::system_error(errno, std::generic_category(), "send");
+        }
+        numOfSent += count;
+    }
+    m_output.clear();
+}
+
+protocol::Response TaskClient::receive() {
+    while (true) {
+        const std::size_t size =
+            protocol::frameSize(m_input.data() + m_numOfReceived, m_input.size() - m_numOfReceived);
+        if (size != 0) {
+            protocol::Response response =
+                protocol::decodeResponse(m_input.data() + m_numOfReceived + protocol::FRAME_HEADER_SIZE,
+                                         size - protocol::FRAME_HEADER_SIZE);
+            m_numOfReceived += size;
+            if (m_numOfReceived == m_input.size()) {
+                m_input.clear();
+                m_numOfReceived = 0;
+            }
+            return response;
+        }
+
+        // nothing more can arrive before the server has the buffered requests
+        flush();
+        // move the partial frame to the front, then read more after it
+        m_input.erase(m_input.begin(), m_input.begin() + m_numOfReceived);
+        m_numOfReceived = 0;
+        const std::size_t oldSize = m_input.size();
+        const std::size_t READ_CHUNK_SIZE = 64 << 10;
+        m_input.resize(oldSize + READ_CHUNK_SIZE);
+        const ssize_t count = read(m_fd, m_input.data() + oldSize, READ_CHUNK_SIZE);
+        m_input.resize(oldSize + (count > 0 ? count : 0));
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count < 0) {
+            throw std::system_error(errno, std::generic_category(), "read");
+        }
+        if (count == 0) {
+            throw protocol::ProtocolError("The server closed the connection");
+        }
+    }
+}
+
+protocol::Response TaskClient::call(const protocol::Request& request) {
+    send(request);
+    return receive();
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "Protocol.h"
+
+using std::string;
+
+/**
+ * @brief A blocking client of a TaskServer, over one connection.
+ *
+ * send() only buffers a request, and the buffered requests are written at once - by flush(), or by receive()
+ * when it has to wait. So a caller pipelines by sending several requests before it receives their responses,
+ * which come back in the same order, and a caller that sends one request per response it takes gets its
+ * requests batched into one write whenever several responses arrived together.
+ */
+class TaskClient {
+    int m_fd = -1;
+    std::vector<std::uint8_t> m_output;
+    std::vector<std::uint8_t> m_input;
+    std::size_t m_numOfReceived = 0; // the prefix of m_input already decoded
+
+public:
+    /**
+     * @brief Connects to a server.
+     *
+     * @param socketPath The path of the server's Unix domain socket.
+     * @throws std::invalid_argument If the path is too long for a Unix domain socket.
+     * @throws std::system_error If the connection fails.
+     */
+    explicit TaskClient(const string& socketPath);
+
+    ~TaskClient();
+
+    TaskClient(const TaskClient& other) = delete;
+    TaskClient& operator=(const TaskClient& other) = delete;
+
+    /**
+     * @brief Buffers a request - it is written by the next flush() or receive().
+     *
+     * @param request The request to be sent.
+     */
+    void send(const protocol::Request& request);
+
+    /**
+     * @brief Writes every buffered request.
+     *
+     * @throws std::system_error If the connection breaks.
+     */
+    void flush();
+
+    /**
+     * @brief Gets the next response - if it has not arrived yet, flushes the buffered requests and waits for it.
+     *
+     * @return protocol::Response The response to the oldest request not answered yet.
+     * @throws std::system_error If the connection breaks.
+     * @throws protocol::ProtocolError If the server closed the connection or sent a malformed frame.
+     */
+    protocol::Response receive();
+
+    /**
+     * @brief Sends a request and waits for its response - one round trip.
+     *
+     * @param request The request to be sent.
+     * @return protocol::Response Its response.
+     */
+    protocol::Response call(const protocol::Request& request);
+};
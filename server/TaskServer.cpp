@@ -0,0 +1,348 @@
+#include "TaskServer.h"
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+    std::system_error lastError(const char* what) {
+        return std::system_error(errno, std::generic_category(), what);
+    }
+}
+
+TaskServer::TaskServer(TaskManager& manager, const string& socketPath) :
+    m_manager(manager), m_socketPath(socketPath) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+        throw std::invalid_argument("The socket path must be 1 to " + std::to_string(sizeof(address.sun_path) - 1) +
+                                    " characters long");
+    }
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    try {
+        m_listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (m_listenFd < 0) {
+            throw lastError("socket");
+        }
+        unlink(socketPath.c_str());
+        if (bind(m_listenFd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0) {
+            throw lastError("bind");
+        }
+        if (listen(m_listenFd, SOMAXCONN) < 0) {
+            throw lastError("listen");
+        }
+        m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+        if (m_epollFd < 0) {
+            throw lastError("epoll_create1");
+        }
+        m_stopFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (m_stopFd < 0) {
+            throw lastError("eventfd");
+        }
+        for (int fd : {m_listenFd, m_stopFd}) {
+            epoll_event event = {};
+            event.events = EPOLLIN;
+            event.data.fd = fd;
+            if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+                throw lastError("epoll_ctl");
+            }
+        }
+    }
+    catch (...) {
+        closeAll();
+        throw;
+    }
+}
+
+TaskServer::~TaskServer() {
+    closeAll();
+}
+
+const string& TaskServer::getSocketPath() const {
+    return m_socketPath;
+}
+
+// -------------------------------- helpers -------------------------------- //
+
+void TaskServer::closeAll() {
+    for (auto& connection : m_connections) {
+        close(connection.first);
+    }
+    m_connections.clear();
+    if (m_listenFd >= 0) {
+        close(m_listenFd);
+        unlink(m_socketPath.c_str());
+        m_listenFd = -1;
+    }
+    for (int* fd : {&m_epollFd, &m_stopFd}) {
+        if (*fd >= 0) {
+            close(*fd);
+            *fd = -1;
+        }
+    }
+}
+
+void TaskServer::acceptConnections() {
+    while (true) {
+        const int fd = accept4(m_listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            // EAGAIN once the backlog is empty - and a failed accept must not take the whole server down
+            return;
+        }
+        std::unique_ptr<Connection> connection(new Connection());
+        connection->fd = fd;
+        connection->events = EPOLLIN;
+        epoll_event event = {};
+        event.events = connection->events;
+        event.data.fd = fd;
+        if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+            close(fd);
+            continue;
+        }
+        m_connections[fd] = std::move(connection);
+    }
+}
+
+void TaskServer::closeConnection(Connection& connection) {
+    const int fd = connection.fd;
+    epoll_ctl(m_epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    close(fd);
+    m_connections.erase(fd); // connection is gone from here on
+}
+
+void TaskServer::updateEvents(Connection& connection) {
+    const std::size_t pending = connection.output.size() - connection.numOfSent;
+    std::uint32_t events = 0;
+    if (pending <= MAX_PENDING_OUTPUT && !connection.peerClosed) {
+        events |= EPOLLIN;
+    }
+    if (pending > 0) {
+        events |= EPOLLOUT;
+    }
+    if (events == connection.events) {
+        return;
+    }
+    epoll_event event = {};
+    event.events = events;
+    event.data.fd = connection.fd;
+    if (epoll_ctl(m_epollFd, EPOLL_CTL_MOD, connection.fd, &event) == 0) {
+        connection.events = events;
+    }
+}
+
+bool TaskServer::readRequests(Connection& connection) {
+    // bounded per wakeup, so one busy connection cannot starve the others
+    for (std::size_t numOfRead = 0; numOfRead < MAX_PENDING_OUTPUT;) {
+        const std::size_t oldSize = connection.input.size();
+        connection.input.resize(oldSize + READ_CHUNK_SIZE);
+        const ssize_t count = read(connection.fd, connection.input.data() + oldSize, READ_CHUNK_SIZE);
+        connection.input.resize(oldSize + (count > 0 ? count : 0));
+        if (count > 0) {
+            numOfRead += count;
+            continue;
+        }
+        if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return true;
+        }
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count == 0) {
+            // the peer is done sending - it still gets the responses to what it sent
+            connection.peerClosed = true;
+            updateEvents(connection);
+            return true;
+        }
+        closeConnection(connection);
+        return false;
+    }
+    return true;
+}
+
+bool TaskServer::writeResponses(Connection& connection) {
+    while (connection.numOfSent < connection.output.size()) {
+        const ssize_t count = send(connection.fd, connection.output.data() + connection.numOfSent,
+                                   connection.output.size() - connection.numOfSent, MSG_NOSIGNAL);
+        if (count > 0) {
+            connection.numOfSent += count;
+            continue;
+        }
+        if (count < 0 && errno == EINTR) {
+            continue;
+        }
+        if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        closeConnection(connection);
+        return false;
+    }
+    if (connection.numOfSent == connection.output.size()) {
+        connection.output.clear();
+        connection.numOfSent = 0;
+    }
+    else if (connection.numOfSent > connection.output.size() / 2) {
+        connection.output.erase(connection.output.begin(), connection.output.begin() + connection.numOfSent);
+        connection.numOfSent = 0;
+    }
+    updateEvents(connection);
+    return true;
+}
+
+void TaskServer::applyRequests(Connection& connection) {
+    std::vector<std::uint8_t>& input = connection.input;
+    std::size_t position = 0;
+    m_requests.clear();
+    while (connection.output.size() - connection.numOfSent <= MAX_PENDING_OUTPUT) {
+        const std::size_t size = protocol::frameSize(input.data() + position, input.size() - position);
+        if (size == 0) {
+            break;
+        }
+        m_requests.push_back(protocol::decodeRequest(input.data() + position + protocol::FRAME_HEADER_SIZE,
+                                                     size - protocol::FRAME_HEADER_SIZE));
+        position += size;
+        // responses are about as large as requests - a rough bound so a huge batch still stops at the limit
+        if (position > MAX_PENDING_OUTPUT) {
+            break;
+        }
+    }
+    input.erase(input.begin(), input.begin() + position);
+
+    protocol::Response response;
+    for (std::size_t i = 0; i < m_requests.size();) {
+        const protocol::Request& request = m_requests[i];
+        if (request.opcode != protocol::Opcode::Assign) {
+            response = protocol::Response();
+            response.id = request.id;
+            response.opcode = request.opcode;
+            applyRequest(request, response);
+            protocol::encodeResponse(response, connection.output);
+            ++i;
+            continue;
+        }
+
+        // a run of assigns to one person - one assignTasks() call
+        const std::size_t runStart = i;
+        m_tasks.clear();
+        while (i < m_requests.size() && m_requests[i].opcode == protocol::Opcode::Assign &&
+               m_requests[i].personName == request.personName) {
+            m_tasks.push_back(m_requests[i].task);
+            ++i;
+        }
+        response = protocol::Response();
+        response.opcode = protocol::Opcode::Assign;
+        try {
+            const int firstId = m_manager.assignTasks(request.personName, m_tasks);
+            for (std::size_t j = runStart; j < i; ++j) {
+                response.id = m_requests[j].id;
+                response.taskId = firstId + static_cast<int>(j - runStart);
+                protocol::encodeResponse(response, connection.output);
+            }
+        }
+        catch (const std::exception& error) {
+            response.status = protocol::Status::Error;
+            response.error = error.what();
+            for (std::size_t j = runStart; j < i; ++j) {
+                response.id = m_requests[j].id;
+                protocol::encodeResponse(response, connection.output);
+            }
+        }
+    }
+}
+
+void TaskServer::applyRequest(const protocol::Request& request, protocol::Response& response) {
+    try {
+        switch (request.opcode) {
+            case protocol::Opcode::Assign:
+                m_manager.assignTask(request.personName, request.task);
+                break;
+            case protocol::Opcode::Complete:
+                response.taskId = m_manager.completeTask(request.personName);
+                break;
+            case protocol::Opcode::Bump:
+                m_manager.bumpPriorityByType(request.types, request.amount);
+                break;
+            case protocol::Opcode::Stats: {
+                const TaskStats stats = request.personName.empty() ? m_manager.stats()
+                                                                   : m_manager.stats(request.personName);
+                response.total = stats.getTotalCount();
+                for (int type = 0; type < NUM_TASK_TYPES; ++type) {
+                    response.countsByType.push_back(stats.getCountByType(static_cast<TaskType>(type)));
+                }
+                break;
+            }
+            case protocol::Opcode::Search:
+                response.tasks = m_manager.searchDescriptions(request.query, request.k);
+                break;
+        }
+    }
+    catch (const std::exception& error) {
+        response.status = protocol::Status::Error;
+        response.error = error.what();
+    }
+}
+
+// --------------------------------- server -------------------------------- //
+
+void TaskServer::run() {
+    const int MAX_EVENTS = 64;
+    epoll_event events[MAX_EVENTS];
+    while (true) {
+        const int numOfEvents = epoll_wait(m_epollFd, events, MAX_EVENTS, -1);
+        if (numOfEvents < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw lastError("epoll_wait");
+        }
+        for (int i = 0; i < numOfEvents; ++i) {
+            const int fd = events[i].data.fd;
+            if (fd == m_stopFd) {
+                std::uint64_t count;
+                while (read(m_stopFd, &count, sizeof(count)) > 0) {
+                }
+                return;
+            }
+            if (fd == m_listenFd) {
+                acceptConnections();
+                continue;
+            }
+            auto found = m_connections.find(fd);
+            if (found == m_connections.end()) {
+                continue; // closed earlier in this round
+            }
+            Connection& connection = *found->second;
+            if ((events[i].events & EPOLLOUT) && !writeResponses(connection)) {
+                continue;
+            }
+            if ((events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) && !readRequests(connection)) {
+                continue;
+            }
+            try {
+                applyRequests(connection);
+            }
+            catch (const protocol::ProtocolError&) {
+                closeConnection(connection);
+                continue;
+            }
+            if (writeResponses(connection) && connection.peerClosed && connection.output.empty()) {
+                closeConnection(connection);
+            }
+        }
+    }
+}
+
+void TaskServer::stop() {
+    const std::uint64_t one = 1;
+    // write() is async-signal-safe - and if the counter is somehow full, a stop is pending anyway
+    ssize_t ignored = write(m_stopFd, &one, sizeof(one));
+    (void)ignored;
+}
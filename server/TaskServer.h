@@ -0,0 +1,102 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Protocol.h"
+#include "../TaskManager.h"
+
+using std::string;
+
+/**
+ * @brief Serves one TaskManager to the processes of a host, over a Unix domain socket (see Protocol.h).
+ *
+ * A single thread runs an epoll loop over the listening socket and every connection, all of them
+ * non-blocking, so the TaskManager is only ever touched by that thread. Every time a connection is readable,
+ * everything it sent is read, and all the whole requests in it are applied as one batch: a run of assigns to
+ * one person becomes a single TaskManager::assignTasks call, and all the responses go out in one write.
+ * A client that pipelines its requests therefore gets them batched, and one that does not pays one round
+ * trip per request.
+ *
+ * A connection whose responses pile up (it sends, but does not read) is not read any further until they
+ * drain, so a slow client cannot grow the server's memory. A malformed frame closes its connection.
+ */
+class TaskServer {
+    struct Connection {
+        int fd = -1;
+        std::vector<std::uint8_t> input;  // received, not applied yet
+        std::vector<std::uint8_t> output; // encoded responses, not sent yet
+        std::size_t numOfSent = 0;        // the prefix of output already sent
+        std::uint32_t events = 0;         // what epoll waits for on the socket
+        bool peerClosed = false;          // nothing more will come - closed once its responses are out
+    };
+
+    // above this many unsent bytes, a connection's requests wait for its responses to drain
+    static constexpr std::size_t MAX_PENDING_OUTPUT = 4 << 20;
+    static constexpr std::size_t READ_CHUNK_SIZE = 64 << 10;
+
+    TaskManager& m_manager;
+    string m_socketPath;
+    int m_listenFd = -1;
+    int m_epollFd = -1;
+    int m_stopFd = -1; // an eventfd, written by stop()
+    std::unordered_map<int, std::unique_ptr<Connection>> m_connections;
+
+    // kept between batches so applying one allocates as little as possible
+    std::vector<protocol::Request> m_requests;
+    std::vector<Task> m_tasks;
+
+    void closeAll();
+    void acceptConnections();
+    void closeConnection(Connection& connection);
+    // these two return false if the connection was closed
+    bool readRequests(Connection& connection);
+    bool writeResponses(Connection& connection);
+    void applyRequests(Connection& connection);
+    void applyRequest(const protocol::Request& request, protocol::Response& response);
+    // reads while the responses are not piling up, writes while there are any
+    void updateEvents(Connection& connection);
+
+public:
+    /**
+     * @brief Binds the socket and starts listening - requests are served once run() is called.
+     *
+     * @param manager The TaskManager served - must outlive the server, and only be changed through it.
+     * @param socketPath The path of the Unix domain socket. A stale socket file there is replaced.
+     * @throws std::invalid_argument If the path is too long for a Unix domain socket.
+     * @throws std::system_error If the socket cannot be created, bound or listened on.
+     */
+    TaskServer(TaskManager& manager, const string& socketPath);
+
+    /**
+     * @brief Closes every connection and removes the socket file.
+     */
+    ~TaskServer();
+
+    TaskServer(const TaskServer& other) = delete;
+    TaskServer& operator=(const TaskServer& other) = delete;
+
+    /**
+     * @brief Serves requests until stop() is called.
+     *
+     * @throws std::system_error If epoll fails.
+     */
+    void run();
+
+    /**
+     * @brief Makes run() return after the batch it is applying. Safe to call from any thread, and from a
+     * signal handler.
+     */
+    void stop();
+
+    /**
+     * @brief Gets the path of the socket the server listens on.
+     *
+     * @return const string& The socket path.
+     */
+    const string& getSocketPath() const;
+};
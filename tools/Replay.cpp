@@ -0,0 +1,144 @@
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <stdexcept>
+#include <string>
+
+#include <sys/resource.h>
+
+#include "Trace.h"
+
+/**
+ * taskmanager_replay - drives a TaskManager from a trace and reports its throughput, latency percentiles and
+ * memory, for capacity planning.
+ *
+ *   taskmanager_replay --trace <file> [--storage list|buckets] [--index on|off] [--max-persons <n>]
+ *
+ * --trace         the trace, like one taskmanager_tracegen wrote (- for standard input)
+ * --storage       how every person stores its tasks (default list)
+ * --index         whether descriptions are indexed as they are assigned (default off)
+ * --max-persons   the most persons the TaskManager holds (default the persons in the trace)
+ *
+ * The trace is loaded in full before the replay starts, so only the TaskManager is measured. Peak RSS is the
+ * whole process's high-water mark - the loaded trace included, which is reported on its own.
+ */
+
+namespace {
+    struct ReplayOptions {
+        string tracePath;
+        TaskStorage storage = TaskStorage::List;
+        bool indexDescriptions = false;
+        int maxPersons = 0; // 0 for the persons in the trace
+    };
+
+    ReplayOptions parseOptions(int argc, char** argv) {
+        ReplayOptions options;
+        for (int i = 1; i < argc; ++i) {
+            const string flag = argv[i];
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("missing value for " + flag);
+            }
+            const string value = argv[++i];
+            if (flag == "--trace") {
+                options.tracePath = value;
+            }
+            else if (flag == "--storage" && (value == "list" || value == "buckets")) {
+                options.storage = (value == "list") ? TaskStorage::List : TaskStorage::Buckets;
+            }
+            else if (flag == "--index" && (value == "on" || value == "off")) {
+                options.indexDescriptions = (value == "on");
+            }
+            else if (flag == "--max-persons") {
+                options.maxPersons = std::stoi(value);
+            }
+            else {
+                throw std::invalid_argument("unknown option " + flag + " " + value);
+            }
+        }
+        if (options.tracePath.empty()) {
+            throw std::invalid_argument("--trace is required");
+        }
+        return options;
+    }
+
+    std::vector<trace::Operation> loadTrace(const string& path) {
+        if (path == "-") {
+            return trace::read(std::cin);
+        }
+        std::ifstream input(path);
+        if (!input) {
+            throw std::runtime_error("cannot open " + path);
+        }
+        return trace::read(input);
+    }
+
+    int countPersons(const std::vector<trace::Operation>& operations) {
+        std::set<string> names;
+        for (const trace::Operation& operation : operations) {
+            if (!operation.personName.empty()) {
+                names.insert(operation.personName);
+            }
+            if (!operation.otherPersonName.empty()) {
+                names.insert(operation.otherPersonName);
+            }
+        }
+        return static_cast<int>(names.size());
+    }
+
+    // the process's peak resident set so far
+    double peakRssMiB() {
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        return usage.ru_maxrss / 1024.0; // kilobytes on Linux
+    }
+}
+
+int main(int argc, char** argv) {
+    try {
+        const ReplayOptions options = parseOptions(argc, argv);
+        const std::vector<trace::Operation> operations = loadTrace(options.tracePath);
+        const int numOfPersons = countPersons(operations);
+        const double rssBeforeReplay = peakRssMiB();
+
+        TaskManager manager(options.maxPersons > 0 ? options.maxPersons : std::max(numOfPersons, 1),
+                            options.storage);
+        if (options.indexDescriptions) {
+            manager.enableDescriptionIndex();
+        }
+        trace::ReplayResult result = trace::replay(manager, operations);
+
+        std::cout << std::fixed << std::setprecision(3)
+                  << "trace       " << operations.size() << " operations, " << numOfPersons << " persons" << std::endl
+                  << "replay      " << result.seconds << " s, " << std::setprecision(0)
+                  << operations.size() / result.seconds << " operations/sec" << std::endl
+                  << "latency ns  " << std::setw(10) << "count" << std::setw(10) << "p50" << std::setw(10) << "p99"
+                  << std::setw(10) << "p99.9" << std::setw(12) << "max" << std::endl;
+        for (int kind = 0; kind < trace::NUM_OPERATION_KINDS; ++kind) {
+            std::vector<double>& latencies = result.latencies[kind];
+            if (latencies.empty()) {
+                continue;
+            }
+            std::sort(latencies.begin(), latencies.end());
+            std::cout << "  " << std::left << std::setw(10)
+                      << trace::operationKindName(static_cast<trace::OperationKind>(kind)) << std::right
+                      << std::setw(10) << latencies.size() << std::setw(10) << trace::percentile(latencies, 0.50)
+                      << std::setw(10) << trace::percentile(latencies, 0.99)
+                      << std::setw(10) << trace::percentile(latencies, 0.999)
+                      << std::setw(12) << latencies.back() << std::endl;
+        }
+        std::cout << "failures    " << result.numOfFailures << std::endl
+                  << "final tasks " << manager.stats().getTotalCount() << std::endl
+                  << "peak tasks  " << result.peakNumOfTasks << ", TaskManager memory near the peak:" << std::endl
+                  << result.memoryAtPeak << std::endl
+                  << std::setprecision(1) << "peak RSS    " << peakRssMiB() << " MiB (" << rssBeforeReplay
+                  << " MiB with the trace loaded, before the replay)" << std::endl;
+    }
+    catch (const std::exception& e) {
+        std::cerr << "taskmanager_replay: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
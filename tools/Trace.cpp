@@ -0,0 +1,467 @@
+#include "Trace.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <sstream>
+
+namespace trace {
+
+    namespace {
+        const char* const VOCABULARY[] = {
+            "fix", "review", "deploy", "update", "write", "test", "plan", "migrate",
+            "client", "server", "report", "budget", "release", "backlog", "database", "cache",
+            "login", "invoice", "schema", "dashboard", "meeting", "slides", "onboarding", "audit",
+            "latency", "outage", "roadmap", "contract", "pipeline", "metrics", "security", "search"
+        };
+        const int VOCABULARY_SIZE = sizeof(VOCABULARY) / sizeof(VOCABULARY[0]);
+
+        bool isWord(const string& text) {
+            return !text.empty() && std::none_of(text.begin(), text.end(), [](char c) {
+                return std::isspace(static_cast<unsigned char>(c));
+            });
+        }
+
+        // taskTypeToString() without its spaces, so every type is one word
+        string typeName(TaskType type) {
+            string name = taskTypeToString(type);
+            name.erase(std::remove(name.begin(), name.end(), ' '), name.end());
+            return name;
+        }
+
+        std::vector<TaskType> typesIn(TaskTypeSet types) {
+            std::vector<TaskType> result;
+            for (int type = 0; type < NUM_TASK_TYPES; ++type) {
+                if (types.contains(static_cast<TaskType>(type))) {
+                    result.push_back(static_cast<TaskType>(type));
+                }
+            }
+            return result;
+        }
+
+        // ------------------------------- generating ------------------------------- //
+
+        class Generator {
+            const GeneratorOptions& m_options;
+            std::mt19937 m_random;
+            std::discrete_distribution<int> m_person;
+            std::discrete_distribution<int> m_kind;
+            std::vector<TaskType> m_types;
+            std::vector<long long> m_numOfTasks; // by person, as the TaskManager will have them
+
+            int drawPriority() {
+                std::geometric_distribution<int> low(0.15);
+                switch (m_options.priorities) {
+                    case PriorityDistribution::Uniform:
+                        return std::uniform_int_distribution<int>(Task::MIN_PRIORITY, Task::MAX_PRIORITY)(m_random);
+                    case PriorityDistribution::Skewed:
+                        return std::min(Task::MIN_PRIORITY + low(m_random), Task::MAX_PRIORITY);
+                    case PriorityDistribution::Bimodal:
+                        if (std::uniform_int_distribution<int>(0, 4)(m_random) == 0) {
+                            return std::uniform_int_distribution<int>(Task::MAX_PRIORITY - 10,
+                                                                      Task::MAX_PRIORITY)(m_random);
+                        }
+                        return std::min(Task::MIN_PRIORITY + low(m_random), Task::MAX_PRIORITY);
+                }
+                return Task::MIN_PRIORITY;
+            }
+
+            TaskType drawType() {
+                return m_types[std::uniform_int_distribution<std::size_t>(0, m_types.size() - 1)(m_random)];
+            }
+
+            string drawDescription() {
+                string description;
+                std::uniform_int_distribution<int> word(0, VOCABULARY_SIZE - 1);
+                for (int i = 0; i < m_options.descriptionWords; ++i) {
+                    if (i > 0) {
+                        description += ' ';
+                    }
+                    description += VOCABULARY[word(m_random)];
+                }
+                return description;
+            }
+
+            static string personName(int person) {
+                return "p" + std::to_string(person);
+            }
+
+            Operation assign(int person) {
+                Operation operation;
+                operation.kind = OperationKind::Assign;
+                operation.personName = personName(person);
+                operation.priority = drawPriority();
+                operation.types = drawType();
+                operation.description = drawDescription();
+                m_numOfTasks[person]++;
+                return operation;
+            }
+
+        public:
+            explicit Generator(const GeneratorOptions& options)
+                : m_options(options), m_random(options.seed), m_types(typesIn(options.types)),
+                  m_numOfTasks(options.numOfPersons, 0) {
+                std::vector<double> weights;
+                for (int person = 0; person < options.numOfPersons; ++person) {
+                    weights.push_back(std::pow(person + 1.0, -options.personSkew));
+                }
+                m_person = std::discrete_distribution<int>(weights.begin(), weights.end());
+                m_kind = std::discrete_distribution<int>({double(options.assignPart), double(options.completePart),
+                                                          double(options.bumpPart), double(options.reassignPart)});
+            }
+
+            Operation next() {
+                const OperationKind kind = static_cast<OperationKind>(m_kind(m_random));
+                const int person = m_person(m_random);
+                switch (kind) {
+                    case OperationKind::Assign:
+                        return assign(person);
+                    case OperationKind::Complete: {
+                        if (m_numOfTasks[person] == 0) {
+                            return assign(person);
+                        }
+                        Operation operation;
+                        operation.kind = kind;
+                        operation.personName = personName(person);
+                        m_numOfTasks[person]--;
+                        return operation;
+                    }
+                    case OperationKind::Bump: {
+                        Operation operation;
+                        operation.kind = kind;
+                        operation.types = drawType();
+                        operation.priority = std::uniform_int_distribution<int>(1, 5)(m_random);
+                        return operation;
+                    }
+                    case OperationKind::Reassign: {
+                        if (m_numOfTasks[person] == 0 || m_options.numOfPersons == 1) {
+                            return assign(person);
+                        }
+                        // any other person, evenly - the skew picks who loses the tasks
+                        int other = std::uniform_int_distribution<int>(0, m_options.numOfPersons - 2)(m_random);
+                        if (other >= person) {
+                            other++;
+                        }
+                        Operation operation;
+                        operation.kind = kind;
+                        operation.personName = personName(person);
+                        operation.otherPersonName = personName(other);
+                        m_numOfTasks[other] += m_numOfTasks[person];
+                        m_numOfTasks[person] = 0;
+                        return operation;
+                    }
+                }
+                return assign(person);
+            }
+        };
+
+        // ------------------------------- reading ------------------------------- //
+
+        TaskType parseType(const string& name) {
+            for (int type = 0; type < NUM_TASK_TYPES; ++type) {
+                if (typeName(static_cast<TaskType>(type)) == name) {
+                    return static_cast<TaskType>(type);
+                }
+            }
+            throw TraceError("unknown task type " + name);
+        }
+
+        class LineReader {
+            std::istringstream m_line;
+            int m_lineNumber;
+
+        public:
+            LineReader(const string& line, int lineNumber) : m_line(line), m_lineNumber(lineNumber) {}
+
+            [[noreturn]] void fail(const string& message) const {
+                throw TraceError("line " + std::to_string(m_lineNumber) + ": " + message);
+            }
+
+            string word(const char* what) {
+                string value;
+                if (!(m_line >> value)) {
+                    fail(string("missing ") + what);
+                }
+                return value;
+            }
+
+            int integer(const char* what) {
+                const string value = word(what);
+                std::size_t length = 0;
+                int result = 0;
+                try {
+                    result = std::stoi(value, &length);
+                }
+                catch (const std::exception&) {
+                    length = 0;
+                }
+                if (length != value.size()) {
+                    fail(string("bad ") + what + " " + value);
+                }
+                return result;
+            }
+
+            TaskTypeSet types() {
+                const string list = word("task type");
+                try {
+                    return parseTypes(list);
+                }
+                catch (const TraceError& e) {
+                    fail(e.what());
+                }
+            }
+
+            // the rest of the line, without the one space that separates it
+            string rest() {
+                string value;
+                std::getline(m_line, value);
+                if (!value.empty() && value[0] == ' ') {
+                    value.erase(0, 1);
+                }
+                return value;
+            }
+
+            void finish() {
+                string extra;
+                if (m_line >> extra) {
+                    fail("unexpected " + extra);
+                }
+            }
+        };
+
+        Operation parseLine(const string& line, int lineNumber) {
+            LineReader reader(line, lineNumber);
+            const string kind = reader.word("operation");
+            Operation operation;
+            if (kind == operationKindName(OperationKind::Assign)) {
+                operation.kind = OperationKind::Assign;
+                operation.personName = reader.word("person");
+                operation.priority = reader.integer("priority");
+                operation.types = reader.types();
+                if (typesIn(operation.types).size() != 1) {
+                    reader.fail("an assign takes one task type");
+                }
+                operation.description = reader.rest();
+                return operation;
+            }
+            if (kind == operationKindName(OperationKind::Complete)) {
+                operation.kind = OperationKind::Complete;
+                operation.personName = reader.word("person");
+            }
+            else if (kind == operationKindName(OperationKind::Bump)) {
+                operation.kind = OperationKind::Bump;
+                operation.types = reader.types();
+                operation.priority = reader.integer("amount");
+            }
+            else if (kind == operationKindName(OperationKind::Reassign)) {
+                operation.kind = OperationKind::Reassign;
+                operation.personName = reader.word("person");
+                operation.otherPersonName = reader.word("person");
+            }
+            else {
+                reader.fail("unknown operation " + kind);
+            }
+            reader.finish();
+            return operation;
+        }
+
+        // ------------------------------- replaying ------------------------------- //
+
+        using Clock = std::chrono::steady_clock;
+
+        // false when the TaskManager turned the operation down
+        bool run(TaskManager& manager, const Operation& operation, const Task& task) {
+            switch (operation.kind) {
+                case OperationKind::Assign:
+                    manager.assignTask(operation.personName, task);
+                    return true;
+                case OperationKind::Complete:
+                    return manager.completeTask(operation.personName) != -1;
+                case OperationKind::Bump:
+                    manager.bumpPriorityByType(operation.types, operation.priority);
+                    return true;
+                case OperationKind::Reassign:
+                    manager.reassignAllTasks(operation.personName, operation.otherPersonName);
+                    return true;
+            }
+            return false;
+        }
+    }
+
+    const char* operationKindName(OperationKind kind) {
+        switch (kind) {
+            case OperationKind::Assign:
+                return "assign";
+            case OperationKind::Complete:
+                return "complete";
+            case OperationKind::Bump:
+                return "bump";
+            case OperationKind::Reassign:
+                return "reassign";
+        }
+        return "unknown";
+    }
+
+    bool Operation::operator==(const Operation& other) const {
+        return kind == other.kind && personName == other.personName && otherPersonName == other.otherPersonName &&
+               priority == other.priority && types == other.types && description == other.description;
+    }
+
+    bool Operation::operator!=(const Operation& other) const {
+        return !(*this == other);
+    }
+
+    std::vector<Operation> generate(const GeneratorOptions& options) {
+        if (options.numOfOperations < 0 || options.numOfPersons <= 0 || options.types.empty()) {
+            throw std::invalid_argument("A trace needs a non-negative length, persons and task types");
+        }
+        if (options.assignPart < 0 || options.completePart < 0 || options.bumpPart < 0 || options.reassignPart < 0 ||
+            options.assignPart + options.completePart + options.bumpPart + options.reassignPart == 0) {
+            throw std::invalid_argument("The parts of the operation mix must be non-negative, and not all zero");
+        }
+        if (options.personSkew < 0 || options.descriptionWords < 0) {
+            throw std::invalid_argument("The person skew and the description words must be non-negative");
+        }
+
+        Generator generator(options);
+        std::vector<Operation> operations;
+        operations.reserve(options.numOfOperations);
+        for (long long i = 0; i < options.numOfOperations; ++i) {
+            operations.push_back(generator.next());
+        }
+        return operations;
+    }
+
+    void write(ostream& os, const std::vector<Operation>& operations, const string& comment) {
+        std::istringstream commentLines(comment);
+        for (string line; std::getline(commentLines, line);) {
+            os << "# " << line << '\n';
+        }
+        for (const Operation& operation : operations) {
+            os << operationKindName(operation.kind);
+            switch (operation.kind) {
+                case OperationKind::Assign: {
+                    const std::vector<TaskType> types = typesIn(operation.types);
+                    if (!isWord(operation.personName) || types.size() != 1 ||
+                        operation.description.find('\n') != string::npos) {
+                        throw TraceError("An assign needs a one-word person name, one type and a one-line "
+                                         "description");
+                    }
+                    os << ' ' << operation.personName << ' ' << operation.priority << ' '
+                       << typeName(types[0]);
+                    if (!operation.description.empty()) {
+                        os << ' ' << operation.description;
+                    }
+                    break;
+                }
+                case OperationKind::Complete:
+                    if (!isWord(operation.personName)) {
+                        throw TraceError("A complete needs a one-word person name");
+                    }
+                    os << ' ' << operation.personName;
+                    break;
+                case OperationKind::Bump: {
+                    const std::vector<TaskType> types = typesIn(operation.types);
+                    if (types.empty()) {
+                        throw TraceError("A bump needs at least one type");
+                    }
+                    for (std::size_t i = 0; i < types.size(); ++i) {
+                        os << (i == 0 ? ' ' : ',') << typeName(types[i]);
+                    }
+                    os << ' ' << operation.priority;
+                    break;
+                }
+                case OperationKind::Reassign:
+                    if (!isWord(operation.personName) || !isWord(operation.otherPersonName)) {
+                        throw TraceError("A reassign needs two one-word person names");
+                    }
+                    os << ' ' << operation.personName << ' ' << operation.otherPersonName;
+                    break;
+            }
+            os << '\n';
+        }
+    }
+
+    std::vector<Operation> read(std::istream& is) {
+        std::vector<Operation> operations;
+        int lineNumber = 0;
+        for (string line; std::getline(is, line);) {
+            lineNumber++;
+            const std::size_t start = line.find_first_not_of(" \t\r");
+            if (start == string::npos || line[start] == '#') {
+                continue;
+            }
+            if (line.back() == '\r') {
+                line.pop_back();
+            }
+            operations.push_back(parseLine(line, lineNumber));
+        }
+        return operations;
+    }
+
+    TaskTypeSet parseTypes(const string& list) {
+        TaskTypeSet types;
+        std::size_t start = 0;
+        while (start <= list.size()) {
+            const std::size_t end = std::min(list.find(',', start), list.size());
+            types = types | parseType(list.substr(start, end - start));
+            start = end + 1;
+        }
+        return types;
+    }
+
+    ReplayResult replay(TaskManager& manager, const std::vector<Operation>& operations) {
+        ReplayResult result;
+        for (std::vector<double>& latencies : result.latencies) {
+            latencies.reserve(operations.size() / NUM_OPERATION_KINDS);
+        }
+        int sampledNumOfTasks = 0;
+        Clock::duration reporting{0};
+
+        const Clock::time_point start = Clock::now();
+        for (const Operation& operation : operations) {
+            // the task is built outside the timed region, like a caller that already has it
+            const Task task = operation.kind == OperationKind::Assign
+                              ? Task(operation.priority, typesIn(operation.types).front(), operation.description)
+                              : Task(Task::MIN_PRIORITY, TaskType::General);
+            bool succeeded = false;
+            const Clock::time_point before = Clock::now();
+            try {
+                succeeded = run(manager, operation, task);
+            }
+            catch (const std::exception&) {
+                succeeded = false;
+            }
+            const Clock::time_point after = Clock::now();
+            result.latencies[static_cast<int>(operation.kind)].push_back(
+                    std::chrono::duration<double, std::nano>(after - before).count());
+            if (!succeeded) {
+                result.numOfFailures++;
+            }
+
+            const int numOfTasks = manager.stats().getTotalCount();
+            if (numOfTasks > result.peakNumOfTasks) {
+                result.peakNumOfTasks = numOfTasks;
+                if (numOfTasks >= sampledNumOfTasks + sampledNumOfTasks / 8 + 1) {
+                    result.memoryAtPeak = manager.memoryUsage();
+                    sampledNumOfTasks = numOfTasks;
+                    reporting += Clock::now() - after;
+                }
+            }
+        }
+        result.seconds = std::chrono::duration<double>(Clock::now() - start - reporting).count();
+        if (result.peakNumOfTasks > sampledNumOfTasks && manager.stats().getTotalCount() == result.peakNumOfTasks) {
+            result.memoryAtPeak = manager.memoryUsage();
+        }
+        return result;
+    }
+
+    double percentile(const std::vector<double>& sorted, double fraction) {
+        if (sorted.empty()) {
+            return 0;
+        }
+        return sorted[static_cast<std::size_t>(fraction * (sorted.size() - 1))];
+    }
+}
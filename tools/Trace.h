@@ -0,0 +1,174 @@
+#pragma once
+
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "../Task.h"
+#include "../TaskManager.h"
+#include "../TaskTypeSet.h"
+
+using std::string;
+
+/**
+ * Operation traces of a TaskManager - generated, saved, loaded and replayed (see taskmanager_tracegen and
+ * taskmanager_replay).
+ *
+ * A trace is a text file with one operation per line. Lines that start with '#' are comments, and so are
+ * empty lines. Person names are single words, types are the names taskTypeToString() gives without their
+ * spaces (like CustomerSupport), and a description is the rest of its line:
+ *
+ *   assign    <person> <priority> <type> [description]
+ *   complete  <person>
+ *   bump      <type>[,<type>...] <amount>
+ *   reassign  <from person> <to person>
+ *
+ * The file is the reproducible artifact: a generator seed gives the same trace on one build, but the standard
+ * library's distributions differ between implementations, so traces are kept and shared as files.
+ */
+namespace trace {
+
+    enum class OperationKind { Assign, Complete, Bump, Reassign };
+
+    constexpr int NUM_OPERATION_KINDS = static_cast<int>(OperationKind::Reassign) + 1;
+
+    /**
+     * @brief Gets the word a trace uses for a kind of operation.
+     *
+     * @param kind The kind of operation.
+     * @return const char* Its word, like "assign".
+     */
+    const char* operationKindName(OperationKind kind);
+
+    /**
+     * @brief A malformed trace line, or an operation that cannot be written as one.
+     */
+    class TraceError : public std::runtime_error {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    struct Operation {
+        OperationKind kind = OperationKind::Assign;
+        string personName;      // Assign, Complete, Reassign (the person the tasks move from)
+        string otherPersonName; // Reassign (the person the tasks move to)
+        int priority = 0;       // Assign, Bump (the amount)
+        TaskTypeSet types;      // Assign (exactly one type), Bump
+        string description;     // Assign
+
+        bool operator==(const Operation& other) const;
+        bool operator!=(const Operation& other) const;
+    };
+
+    // ------------------------------- generating ------------------------------- //
+
+    enum class PriorityDistribution {
+        Uniform, // every priority equally likely
+        Skewed,  // most tasks in a few low priorities, like real backlogs
+        Bimodal  // mostly low priorities, with a cluster of urgent ones near the top
+    };
+
+    /**
+     * @brief What a generated trace looks like.
+     */
+    struct GeneratorOptions {
+        long long numOfOperations = 1000000;
+        int numOfPersons = 100;
+        // how unevenly the operations fall on the persons - 0 is even, 1 is Zipf (person k gets 1 / (k + 1)
+        // of the weight), larger is more lopsided
+        double personSkew = 0;
+        TaskTypeSet types = TaskTypeSet::all();
+        PriorityDistribution priorities = PriorityDistribution::Uniform;
+        // the mix, in parts - assignPart : completePart : bumpPart : reassignPart
+        int assignPart = 55;
+        int completePart = 40;
+        int bumpPart = 4;
+        int reassignPart = 1;
+        int descriptionWords = 3; // drawn from a small fixed vocabulary
+        unsigned int seed = 1234;
+    };
+
+    /**
+     * @brief Generates a trace.
+     *
+     * The generator follows how many tasks every person has, so a complete or a reassign always picks a
+     * person with tasks - when the person drawn has none, the operation becomes an assign to it instead. A
+     * trace that starts from an empty TaskManager therefore replays with no failures, and its mix leans to
+     * assigns while the persons are still empty.
+     *
+     * @param options What the trace looks like.
+     * @return std::vector<Operation> The operations, in order.
+     * @throws std::invalid_argument If an option is out of range - no persons or types, a negative part or all
+     *                               parts zero, a negative skew or word count.
+     */
+    std::vector<Operation> generate(const GeneratorOptions& options);
+
+    // ------------------------------- reading and writing ------------------------------- //
+
+    /**
+     * @brief Writes a trace.
+     *
+     * @param os The stream the trace is written to.
+     * @param operations The operations to be written.
+     * @param comment Written first, as comment lines - like the options that generated the trace.
+     * @throws TraceError If a person name is empty or has whitespace, a description has a line break, or an
+     *                    assign has other than one type.
+     */
+    void write(ostream& os, const std::vector<Operation>& operations, const string& comment = "");
+
+    /**
+     * @brief Reads a trace.
+     *
+     * @param is The stream the trace is read from, to its end.
+     * @return std::vector<Operation> The operations, in order.
+     * @throws TraceError If a line is malformed - the message has its line number.
+     */
+    std::vector<Operation> read(std::istream& is);
+
+    /**
+     * @brief Parses task type names, like the list of a bump.
+     *
+     * @param list Type names, as in a trace, separated by commas - like "Meeting,CustomerSupport".
+     * @return TaskTypeSet The types.
+     * @throws TraceError If a name is not of a task type.
+     */
+    TaskTypeSet parseTypes(const string& list);
+
+    // ------------------------------- replaying ------------------------------- //
+
+    /**
+     * @brief What a replay measured.
+     */
+    struct ReplayResult {
+        // by OperationKind, the latency of every operation of the kind, in nanoseconds, in trace order
+        std::vector<double> latencies[NUM_OPERATION_KINDS];
+        double seconds = 0; // wall time of the replay, the latency clock reads included
+        long long numOfFailures = 0; // operations the TaskManager threw on or turned down
+        int peakNumOfTasks = 0;
+        MemoryUsage memoryAtPeak; // the TaskManager's memoryUsage() near peakNumOfTasks (see replay())
+    };
+
+    /**
+     * @brief Runs a trace against a TaskManager, timing every operation.
+     *
+     * The memory report is taken each time the task count passes the last one's by an eighth, and at the end
+     * if the trace ends at its peak, so there are O(log peak) reports - memoryAtPeak is of a task count within
+     * an eighth of the peak. The reports are left out of the latencies and of the wall time.
+     *
+     * @param manager The TaskManager to run the trace against - it must have room for every person in it.
+     * @param operations The trace.
+     * @return ReplayResult What the replay measured.
+     */
+    ReplayResult replay(TaskManager& manager, const std::vector<Operation>& operations);
+
+    /**
+     * @brief Gets a percentile of sorted latencies.
+     *
+     * @param sorted The latencies, in ascending order.
+     * @param fraction The percentile, like 0.99.
+     * @return double The latency below which the fraction of them lies, or 0 if there are none.
+     */
+    double percentile(const std::vector<double>& sorted, double fraction);
+}
@@ -0,0 +1,129 @@
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include "Trace.h"
+
+/**
+ * taskmanager_tracegen - writes a reproducible TaskManager operation trace, for taskmanager_replay.
+ *
+ *   taskmanager_tracegen [--output <file>] [--operations <n>] [--persons <n>] [--person-skew <x>]
+ *                        [--types <type>,...] [--priorities uniform|skewed|bimodal] [--mix <a>:<c>:<b>:<r>]
+ *                        [--description-words <n>] [--seed <n>]
+ *
+ * --output             the trace file (default -, standard output)
+ * --operations         operations in the trace (default 1000000)
+ * --persons            persons the operations are spread over (default 100)
+ * --person-skew        0 spreads the operations evenly, 1 is Zipf, more is more lopsided (default 0)
+ * --types              the task types assigned and bumped, like Meeting,Testing (default every type)
+ * --priorities         the priority distribution of assigned tasks (default uniform)
+ * --mix                parts of assigns, completes, bumps and reassigns (default 55:40:4:1)
+ * --description-words  words in every task description (default 3)
+ * --seed               seed of the generator (default 1234)
+ *
+ * The command line is written at the top of the trace, as a comment.
+ */
+
+namespace {
+    struct TraceGenOptions {
+        string outputPath = "-";
+        trace::GeneratorOptions generator;
+    };
+
+    void parseMix(const string& mix, trace::GeneratorOptions& options) {
+        int* const parts[] = {&options.assignPart, &options.completePart, &options.bumpPart, &options.reassignPart};
+        std::size_t start = 0;
+        for (int i = 0; i < 4; ++i) {
+            const std::size_t end = std::min(mix.find(':', start), mix.size());
+            if (start > mix.size() || (i == 3) != (end == mix.size())) {
+                throw std::invalid_argument("--mix takes four parts, like 55:40:4:1");
+            }
+            *parts[i] = std::stoi(mix.substr(start, end - start));
+            start = end + 1;
+        }
+    }
+
+    TraceGenOptions parseOptions(int argc, char** argv) {
+        TraceGenOptions options;
+        trace::GeneratorOptions& generator = options.generator;
+        for (int i = 1; i < argc; ++i) {
+            const string flag = argv[i];
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("missing value for " + flag);
+            }
+            const string value = argv[++i];
+            if (flag == "--output") {
+                options.outputPath = value;
+            }
+            else if (flag == "--operations") {
+                generator.numOfOperations = std::stoll(value);
+            }
+            else if (flag == "--persons") {
+                generator.numOfPersons = std::stoi(value);
+            }
+            else if (flag == "--person-skew") {
+                generator.personSkew = std::stod(value);
+            }
+            else if (flag == "--types") {
+                generator.types = trace::parseTypes(value);
+            }
+            else if (flag == "--priorities" && value == "uniform") {
+                generator.priorities = trace::PriorityDistribution::Uniform;
+            }
+            else if (flag == "--priorities" && value == "skewed") {
+                generator.priorities = trace::PriorityDistribution::Skewed;
+            }
+            else if (flag == "--priorities" && value == "bimodal") {
+                generator.priorities = trace::PriorityDistribution::Bimodal;
+            }
+            else if (flag == "--mix") {
+                parseMix(value, generator);
+            }
+            else if (flag == "--description-words") {
+                generator.descriptionWords = std::stoi(value);
+            }
+            else if (flag == "--seed") {
+                generator.seed = static_cast<unsigned int>(std::stoul(value));
+            }
+            else {
+                throw std::invalid_argument("unknown option " + flag + " " + value);
+            }
+        }
+        return options;
+    }
+}
+
+int main(int argc, char** argv) {
+    try {
+        const TraceGenOptions options = parseOptions(argc, argv);
+        const std::vector<trace::Operation> operations = trace::generate(options.generator);
+
+        string commandLine = "taskmanager_tracegen";
+        for (int i = 1; i < argc; ++i) {
+            commandLine += string(" ") + argv[i];
+        }
+        if (options.outputPath == "-") {
+            trace::write(std::cout, operations, commandLine);
+            std::cout.flush();
+        }
+        else {
+            std::ofstream output(options.outputPath);
+            if (!output) {
+                throw std::runtime_error("cannot open " + options.outputPath);
+            }
+            trace::write(output, operations, commandLine);
+            output.close();
+            if (!output) {
+                throw std::runtime_error("cannot write " + options.outputPath);
+            }
+        }
+    }
+    catch (const std::exception& e) {
+        std::cerr << "taskmanager_tracegen: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}